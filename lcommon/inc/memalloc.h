@@ -23,6 +23,54 @@
 #include "lagrangian.h"
 #include "quant_params.h"
 
+//! subsystems that memory allocated through the get_mem* functions is accounted to
+typedef enum
+{
+  MEM_TAG_OTHER = 0,
+  MEM_TAG_DPB,
+  MEM_TAG_SUBPEL,
+  MEM_TAG_ME,
+  MEM_TAG_RDO,
+  MEM_TAG_RC,
+  MEM_TAG_ERRDO,
+  MEM_TAG_SEI,
+  MEM_TAG_NUM
+} MemTag;
+
+//! allocation statistics of one subsystem
+typedef struct mem_tag_stats
+{
+  int64 cur_bytes;      //!< bytes currently allocated
+  int64 peak_bytes;     //!< maximum of cur_bytes
+  int64 alloc_count;    //!< number of allocations
+  int64 free_count;     //!< number of releases
+} MemTagStats;
+
+//! allocation policies for large sample buffers
+typedef enum
+{
+  MEM_POLICY_DEFAULT = 0,   //!< plain heap allocation
+  MEM_POLICY_ALIGNED,       //!< 64 byte aligned
+  MEM_POLICY_THP,           //!< aligned, transparent huge page hint for buffers >= 2 MB
+  MEM_POLICY_HUGETLB,       //!< explicit huge pages, falls back to THP
+  MEM_POLICY_NUM
+} MemPolicy;
+
+//! bytes of sample buffers per applied policy
+typedef struct mem_policy_stats
+{
+  int64 bytes[MEM_POLICY_NUM];
+  int64 fallbacks;          //!< requests that had to use a weaker policy
+} MemPolicyStats;
+
+extern void        mem_set_tracking(int enable);
+extern MemTag      mem_set_tag  (MemTag tag);
+extern const char *mem_tag_name (MemTag tag);
+extern void        mem_get_stats(MemTag tag, MemTagStats *stats);
+extern void        free_mem_tracking(void);
+extern void        mem_set_policy(MemPolicy policy, int first_touch);
+extern void        mem_get_policy_stats(MemPolicyStats *stats);
+
 extern int  get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1);
 
 extern int  get_mem2Dlm  (LambdaParams ***array2D, int dim0, int dim1);
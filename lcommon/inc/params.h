@@ -118,6 +118,7 @@ struct inp_par_enc
   int BiPredMERefinements;              //!< Max number of Iterations for Bi-predictive motion estimation
   int BiPredMESearchRange;              //!< Search range of Bi-predictive motion estimation
   int BiPredMESubPel;                   //!< Use of subpixel refinement for Bi-predictive motion estimation
+  int BiPredMEConvergence;              //!< Bi-predictive motion estimation stops below this cost gain (in percent) of an iteration (0: off)
 
   // SP/SI Pictures
   int sp_periodicity;                   //!< The periodicity of SP-pictures
@@ -199,6 +200,12 @@ struct inp_par_enc
   int de;     //!< the algorithm to estimate the distortion in the decoder
   int I16rdo; 
   int subMBCodingState;
+  int RateEstimation;           //!< CABAC rate in RDO (0: arithmetic coding, 1: table based estimation, 2: estimation with accuracy report)
+  int FastIntraRDO;             //!< full RDO only for the best ranked intra 4x4/8x8 prediction modes
+  int FastIntraTopK;            //!< number of intra 4x4/8x8 modes passed to RDO
+  int FastIntraTopKLowQP;       //!< number of intra 4x4/8x8 modes passed to RDO below FastIntraQPThreshold
+  int FastIntraQPThreshold;     //!< QP below which FastIntraTopKLowQP is used
+  int IntraRDOThreads;          //!< threads evaluating the intra 4x4/8x8 prediction modes of a block (needs OpenMP)
   int Distortion[TOTAL_DIST_TYPES];
   double VisualResWavPSNR;
   int SSIMOverlapSize;
@@ -236,6 +243,7 @@ struct inp_par_enc
   int ChromaMCBuffer;
   Boolean ChromaMEEnable;
   int ChromaMEWeight;
+  int InterpolationMode;        //!< Sub-pel reference generation (0: full sub-pel planes, 1: on-demand block interpolation, 2: lazy tiles)
   int MEErrorMetric[3];
   int ModeDecisionMetric;
   int SkipDeBlockNonRef;
@@ -272,6 +280,9 @@ struct inp_par_enc
   int Transform8x8Mode;
   int ReportFrameStats;
   int DisplayEncParams;
+  int MemoryReport;             //!< 0: off, 1: memory usage per subsystem in the final report, 2: also sampled per frame
+  int MemoryPolicy;             //!< sample buffer allocation (0: heap, 1: 64 byte aligned, 2: transparent huge pages, 3: explicit huge pages)
+  int MemoryFirstTouch;         //!< leave large sample buffers untouched at allocation for first-touch NUMA placement
   int Verbose;
 
   //! Rate Control parameters
@@ -345,6 +356,18 @@ struct inp_par_enc
   // Fast Mode Decision
   int EarlySkipEnable;
   int SelectiveIntraEnable;
+  int EarlySkipDetection;         //!< decide SKIP/DIRECT before motion estimation when the residual quantizes to zero
+  int AdaptiveModePruning;        //!< skip inter partitions that rarely win in the macroblock neighbourhood
+  double AMPThreshold;            //!< win rate in per cent below which a partition is pruned
+  int AMPRefreshPeriod;           //!< frames per slice type and QP range between full search refresh frames
+  int FastP8x8Decision;           //!< skip sub-8x8 partitions and terminate P8x8 early based on the 16x16/16x8/8x16 results
+  int FullSearchSEA;              //!< successive elimination of full search candidates using 4x4 block sums
+  int FastFullSearchThreads;      //!< threads computing the fast full search SAD tables (needs OpenMP)
+  int FastRefSearch;              //!< skip references beyond ref 1 when ref 1 loses to ref 0 and the neighbours do not use them
+  int PyramidME;                  //!< centre the integer pel search on a coarse vector from 1/2 and 1/4 scaled pictures
+  int PyramidSearchRange;         //!< search range of the pyramid pre-pass at the 1/4 scaled level
+  int HashME;                     //!< check exact 8x8 block matches from a hash table of each reference picture
+  int AdaptiveSearchRange;        //!< shrink the search window where the spatial and temporal neighbour vectors agree
   int DisposableP;
   int DispPQPOffset;
 
@@ -19,6 +19,8 @@
 extern void report                ( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats );
 extern void information_init      ( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats );
 extern void report_frame_statistic( VideoParameters *p_Vid, InputParameters *p_Inp );
+extern void report_frame_memory   ( VideoParameters *p_Vid, InputParameters *p_Inp );
+extern void report_frame_search_range( VideoParameters *p_Vid );
 extern void report_stats_on_error (void);
 
 #endif
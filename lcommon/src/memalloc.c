@@ -17,6 +17,379 @@
 #include "global.h"
 #include "memalloc.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#define MEM_USE_MMAP 1
+#else
+#define MEM_USE_MMAP 0
+#endif
+
+#define MEM_HASH_SIZE      (1 << 14)    //!< buckets of the allocation tracking table
+#define MEM_ALIGN          64           //!< alignment of sample buffers (cache line)
+#define MEM_PLANE_MIN_SIZE (64 << 10)   //!< sample buffers below this size always use the heap
+#define MEM_HUGE_PAGE_SIZE (2 << 20)    //!< huge page size assumed for THP / hugetlb
+
+//! tracking record of one live allocation
+typedef struct mem_entry
+{
+  void             *ptr;
+  size_t            size;
+  size_t            map_len;    //!< length of an mmap()ed block, 0 for heap memory
+  int               tag;
+  struct mem_entry *next;
+} MemEntry;
+
+static MemPolicy   mem_policy      = MEM_POLICY_DEFAULT;
+static int         mem_first_touch = 0;
+static MemPolicyStats mem_policy_stats;
+
+static MemEntry   *mem_hash[MEM_HASH_SIZE];
+static MemTagStats mem_stats[MEM_TAG_NUM];
+static MemTagStats mem_total;
+static MemTag      mem_curr_tag = MEM_TAG_OTHER;
+static int         mem_tracking = 0;    //!< record heap allocations (MemoryReport)
+static int         mem_mapped   = 0;    //!< live mmap()ed blocks, always recorded for munmap(); only accessed atomically
+
+static const char *mem_tag_names[MEM_TAG_NUM] =
+{
+  "Other", "DPB", "Sub-pel", "ME", "RDO", "Rate control", "Error res. RDO", "SEI"
+};
+
+static inline unsigned int mem_hash_idx(void *ptr)
+{
+  return (unsigned int) ((((size_t) ptr) >> 4) * 2654435761u) & (MEM_HASH_SIZE - 1);
+}
+
+static void mem_account(MemTagStats *stats, int64 size)
+{
+  stats->cur_bytes += size;
+  if (size > 0)
+  {
+    ++stats->alloc_count;
+    stats->peak_bytes = i64max(stats->peak_bytes, stats->cur_bytes);
+  }
+  else
+    ++stats->free_count;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Remove the record of an allocation and update the statistics
+ *    of its subsystem
+ ************************************************************************
+ */
+static size_t mem_untrack(void *ptr)
+{
+  MemEntry **link = &mem_hash[mem_hash_idx(ptr)];
+
+  while (*link != NULL)
+  {
+    MemEntry *entry = *link;
+    if (entry->ptr == ptr)
+    {
+      size_t map_len = entry->map_len;
+      *link = entry->next;
+      mem_account(&mem_stats[entry->tag], -(int64) entry->size);
+      mem_account(&mem_total, -(int64) entry->size);
+      free(entry);
+      return map_len;
+    }
+    link = &entry->next;
+  }
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Record an allocation under the current tag. A stale record for the
+ *    same address (memory released with a plain free()) is dropped first.
+ ************************************************************************
+ */
+static void mem_track(void *ptr, size_t size, size_t map_len)
+{
+  MemEntry *entry;
+  unsigned int idx = mem_hash_idx(ptr);
+
+  mem_untrack(ptr);
+
+  if ((entry = (MemEntry *) malloc(sizeof(MemEntry))) == NULL)
+    no_mem_exit("mem_track: entry");
+
+  entry->ptr  = ptr;
+  entry->size = size;
+  entry->map_len = map_len;
+  entry->tag  = mem_curr_tag;
+  entry->next = mem_hash[idx];
+  mem_hash[idx] = entry;
+
+  mem_account(&mem_stats[mem_curr_tag], (int64) size);
+  mem_account(&mem_total, (int64) size);
+}
+
+static void *mem_malloc(size_t size)
+{
+  void *ptr = malloc(size);
+  if (ptr != NULL && mem_tracking)
+  {
+#pragma omp critical (memalloc)
+    mem_track(ptr, size, 0);
+  }
+  return ptr;
+}
+
+static void *mem_calloc(size_t nitems, size_t size)
+{
+  void *ptr = calloc(nitems, size);
+  if (ptr != NULL && mem_tracking)
+  {
+#pragma omp critical (memalloc)
+    mem_track(ptr, nitems * size, 0);
+  }
+  return ptr;
+}
+
+static void mem_free(void *ptr)
+{
+  if (ptr != NULL)
+  {
+    size_t map_len = 0;
+    int mapped;
+
+#pragma omp atomic read
+    mapped = mem_mapped;
+
+    // without tracking only mmap()ed blocks are in the table
+    if (mem_tracking || mapped)
+    {
+#pragma omp critical (memalloc)
+      map_len = mem_untrack(ptr);
+    }
+#if MEM_USE_MMAP
+    if (map_len)
+    {
+#pragma omp atomic
+      --mem_mapped;
+      munmap(ptr, map_len);
+      return;
+    }
+#endif
+    free(ptr);
+  }
+}
+
+#if MEM_USE_MMAP
+/*!
+ ************************************************************************
+ * \brief
+ *    Map anonymous, lazily zeroed memory for a sample buffer, using
+ *    huge pages if requested by the allocation policy
+ ************************************************************************
+ */
+static void *mem_map_plane(size_t size, size_t *map_len, MemPolicy *applied)
+{
+  void *ptr = MAP_FAILED;
+
+  if (mem_policy == MEM_POLICY_HUGETLB && size >= MEM_HUGE_PAGE_SIZE)
+  {
+    *map_len = (size + MEM_HUGE_PAGE_SIZE - 1) & ~((size_t) MEM_HUGE_PAGE_SIZE - 1);
+    ptr = mmap(NULL, *map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED)
+    {
+      *applied = MEM_POLICY_HUGETLB;
+      return ptr;
+    }
+    ++mem_policy_stats.fallbacks;   // no huge pages reserved, try THP instead
+  }
+
+  *map_len = size;
+  ptr = mmap(NULL, *map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return NULL;
+
+  *applied = MEM_POLICY_ALIGNED;
+#ifdef MADV_HUGEPAGE
+  if (mem_policy >= MEM_POLICY_THP && size >= MEM_HUGE_PAGE_SIZE)
+  {
+    if (madvise(ptr, *map_len, MADV_HUGEPAGE) == 0)
+      *applied = MEM_POLICY_THP;
+    else
+      ++mem_policy_stats.fallbacks;
+  }
+#endif
+  return ptr;
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate a zero initialized sample buffer (picture planes and
+ *    sub-pel planes) according to the allocation policy. Large buffers
+ *    are 64 byte aligned, may be backed by huge pages and, with first
+ *    touch placement, are not written here so that their pages end up
+ *    on the NUMA node of the thread that fills them first. Falls back
+ *    to the heap if a policy cannot be applied.
+ ************************************************************************
+ */
+static void *mem_calloc_plane(size_t nitems, size_t size)
+{
+  size_t bytes = nitems * size;
+  MemPolicy applied = MEM_POLICY_DEFAULT;
+  void *ptr = NULL;
+
+  if (mem_policy == MEM_POLICY_DEFAULT && !mem_first_touch)
+    return mem_calloc(nitems, size);
+
+  if (bytes >= MEM_PLANE_MIN_SIZE)
+  {
+#if MEM_USE_MMAP
+    if (mem_first_touch || mem_policy >= MEM_POLICY_THP)
+    {
+      size_t map_len = 0;
+      if ((ptr = mem_map_plane(bytes, &map_len, &applied)) != NULL)
+      {
+#pragma omp critical (memalloc)
+        {
+          mem_track(ptr, bytes, map_len);
+          mem_policy_stats.bytes[applied] += bytes;
+        }
+#pragma omp atomic
+        ++mem_mapped;
+        return ptr;
+      }
+      ++mem_policy_stats.fallbacks;
+    }
+#endif
+    if (ptr == NULL && mem_policy != MEM_POLICY_DEFAULT)
+    {
+#if defined(WIN32)
+      ptr = NULL;
+#else
+      if (posix_memalign(&ptr, MEM_ALIGN, bytes) != 0)
+        ptr = NULL;
+#endif
+      if (ptr != NULL)
+      {
+        memset(ptr, 0, bytes);
+#pragma omp critical (memalloc)
+        {
+          if (mem_tracking)
+            mem_track(ptr, bytes, 0);
+          mem_policy_stats.bytes[MEM_POLICY_ALIGNED] += bytes;
+        }
+        return ptr;
+      }
+      ++mem_policy_stats.fallbacks;
+    }
+  }
+
+  if ((ptr = mem_calloc(nitems, size)) != NULL)
+    mem_policy_stats.bytes[MEM_POLICY_DEFAULT] += bytes;
+  return ptr;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Select the allocation policy for sample buffers
+ *
+ * \param policy
+ *    MemPolicy requested
+ * \param first_touch
+ *    if set, large sample buffers are left untouched at allocation time
+ ************************************************************************
+ */
+void mem_set_policy(MemPolicy policy, int first_touch)
+{
+  mem_policy      = policy;
+  mem_first_touch = first_touch;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bytes of sample buffers allocated with each policy and number of
+ *    fallbacks to a weaker policy
+ ************************************************************************
+ */
+void mem_get_policy_stats(MemPolicyStats *stats)
+{
+  *stats = mem_policy_stats;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Enable the per subsystem accounting of heap allocations. Without
+ *    it only mmap()ed sample buffers are recorded.
+ ************************************************************************
+ */
+void mem_set_tracking(int enable)
+{
+  mem_tracking = enable;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Select the subsystem subsequent allocations are accounted to
+ *
+ * \return
+ *    the previously selected tag, to be restored by the caller
+ ************************************************************************
+ */
+MemTag mem_set_tag(MemTag tag)
+{
+  MemTag prev = mem_curr_tag;
+  mem_curr_tag = tag;
+  return prev;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Name of a subsystem tag for reporting
+ ************************************************************************
+ */
+const char *mem_tag_name(MemTag tag)
+{
+  return mem_tag_names[tag];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocation statistics of one subsystem, or of all subsystems
+ *    if tag is MEM_TAG_NUM
+ ************************************************************************
+ */
+void mem_get_stats(MemTag tag, MemTagStats *stats)
+{
+  *stats = (tag == MEM_TAG_NUM) ? mem_total : mem_stats[tag];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Release the allocation tracking records
+ ************************************************************************
+ */
+void free_mem_tracking(void)
+{
+  int i;
+  for (i = 0; i < MEM_HASH_SIZE; ++i)
+  {
+    while (mem_hash[i] != NULL)
+    {
+      MemEntry *entry = mem_hash[i];
+      mem_hash[i] = entry->next;
+      free(entry);
+    }
+  }
+}
+
  /*!
  ************************************************************************
  * \brief
@@ -30,10 +403,10 @@ int init_top_bot_planes(imgpel **imgFrame, int dim0, imgpel ***imgTopField, imgp
 {
   int i;
 
-  if((*imgTopField   = (imgpel**) malloc((dim0>>1) * sizeof(imgpel*))) == NULL)
+  if((*imgTopField   = (imgpel**) mem_malloc((dim0>>1) * sizeof(imgpel*))) == NULL)
     no_mem_exit("init_top_bot_planes: imgTopField");
 
-  if((*imgBotField   = (imgpel**) malloc((dim0>>1) * sizeof(imgpel*))) == NULL)
+  if((*imgBotField   = (imgpel**) mem_malloc((dim0>>1) * sizeof(imgpel*))) == NULL)
     no_mem_exit("init_top_bot_planes: imgBotField");
 
   for(i = 0; i < (dim0>>1); i++)
@@ -55,8 +428,8 @@ int init_top_bot_planes(imgpel **imgFrame, int dim0, imgpel ***imgTopField, imgp
  ************************************************************************/
 void free_top_bot_planes(imgpel **imgTopField, imgpel **imgBotField)
 {
-  free (imgTopField);
-  free (imgBotField);
+  mem_free (imgTopField);
+  mem_free (imgBotField);
 }
 
 /*!
@@ -71,9 +444,9 @@ int get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (DistortionData**)malloc(dim0 *       sizeof(DistortionData*))) == NULL)
+  if((*array2D    = (DistortionData**)mem_malloc(dim0 *       sizeof(DistortionData*))) == NULL)
     no_mem_exit("get_mem2Ddist: array2D");
-  if((*(*array2D) = (DistortionData* )calloc(dim0 * dim1, sizeof(DistortionData ))) == NULL)
+  if((*(*array2D) = (DistortionData* )mem_calloc(dim0 * dim1, sizeof(DistortionData ))) == NULL)
     no_mem_exit("get_mem2Ddist: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -94,9 +467,9 @@ int get_mem2Dlm(LambdaParams ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (LambdaParams**)malloc(dim0 *      sizeof(LambdaParams*))) == NULL)
+  if((*array2D    = (LambdaParams**)mem_malloc(dim0 *      sizeof(LambdaParams*))) == NULL)
     no_mem_exit("get_mem2Dlm: array2D");
-  if((*(*array2D) = (LambdaParams* )calloc(dim0 * dim1,sizeof(LambdaParams ))) == NULL)
+  if((*(*array2D) = (LambdaParams* )mem_calloc(dim0 * dim1,sizeof(LambdaParams ))) == NULL)
     no_mem_exit("get_mem2Dlm: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -117,11 +490,11 @@ void free_mem2Ddist(DistortionData **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Ddist: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -141,11 +514,11 @@ void free_mem2Dlm(LambdaParams **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dlm: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -165,9 +538,9 @@ int get_mem2Dmp(PicMotionParams ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (PicMotionParams**)malloc(dim0 *      sizeof(PicMotionParams*))) == NULL)
+  if((*array2D    = (PicMotionParams**)mem_malloc(dim0 *      sizeof(PicMotionParams*))) == NULL)
     no_mem_exit("get_mem2Dmv: array2D");
-  if((*(*array2D) = (PicMotionParams* )calloc(dim0 * dim1,sizeof(PicMotionParams ))) == NULL)
+  if((*(*array2D) = (PicMotionParams* )mem_calloc(dim0 * dim1,sizeof(PicMotionParams ))) == NULL)
     no_mem_exit("get_mem2Dmp: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -189,7 +562,7 @@ int get_mem3Dmp(PicMotionParams ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(PicMotionParams**);
 
-  if(((*array3D) = (PicMotionParams***)malloc(dim0 * sizeof(PicMotionParams**))) == NULL)
+  if(((*array3D) = (PicMotionParams***)mem_malloc(dim0 * sizeof(PicMotionParams**))) == NULL)
     no_mem_exit("get_mem3Dmp: array3D");
 
   mem_size += get_mem2Dmp(*array3D, dim0 * dim1, dim2);
@@ -212,11 +585,11 @@ void free_mem2Dmp(PicMotionParams **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dmp: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -237,7 +610,7 @@ void free_mem3Dmp(PicMotionParams ***array3D)
   if (array3D)
   {
     free_mem2Dmp(*array3D);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -259,9 +632,9 @@ int get_mem2Dquant(LevelQuantParams ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (LevelQuantParams**) malloc(dim0 * sizeof(LevelQuantParams*))) == NULL)
+  if((*array2D    = (LevelQuantParams**) mem_malloc(dim0 * sizeof(LevelQuantParams*))) == NULL)
     no_mem_exit("get_mem2Dquant: array2D");
-  if((*(*array2D) = (LevelQuantParams* ) calloc(dim0 * dim1,sizeof(LevelQuantParams ))) == NULL)
+  if((*(*array2D) = (LevelQuantParams* ) mem_calloc(dim0 * dim1,sizeof(LevelQuantParams ))) == NULL)
     no_mem_exit("get_mem2Dquant: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -283,7 +656,7 @@ int get_mem3Dquant(LevelQuantParams ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(LevelQuantParams**);
 
-  if(((*array3D) = (LevelQuantParams***)malloc(dim0 * sizeof(LevelQuantParams**))) == NULL)
+  if(((*array3D) = (LevelQuantParams***)mem_malloc(dim0 * sizeof(LevelQuantParams**))) == NULL)
     no_mem_exit("get_mem3Dquant: array3D");
 
   mem_size += get_mem2Dquant(*array3D, dim0 * dim1, dim2);
@@ -307,7 +680,7 @@ int get_mem4Dquant(LevelQuantParams *****array4D, int dim0, int dim1, int dim2,
 {
   int i, mem_size = dim0 * sizeof(LevelQuantParams***);
 
-  if(((*array4D) = (LevelQuantParams****)malloc(dim0 * sizeof(LevelQuantParams***))) == NULL)
+  if(((*array4D) = (LevelQuantParams****)mem_malloc(dim0 * sizeof(LevelQuantParams***))) == NULL)
     no_mem_exit("get_mem4Dquant: array4D");
 
   mem_size += get_mem3Dquant(*array4D, dim0 * dim1, dim2, dim3);
@@ -331,7 +704,7 @@ int get_mem5Dquant(LevelQuantParams ******array5D, int dim0, int dim1, int dim2,
 {
   int i, mem_size = dim0 * sizeof(LevelQuantParams***);
 
-  if(((*array5D) = (LevelQuantParams*****)malloc(dim0 * sizeof(LevelQuantParams****))) == NULL)
+  if(((*array5D) = (LevelQuantParams*****)mem_malloc(dim0 * sizeof(LevelQuantParams****))) == NULL)
     no_mem_exit("get_mem5Dquant: array5D");
 
   mem_size += get_mem4Dquant(*array5D, dim0 * dim1, dim2, dim3, dim4);
@@ -354,11 +727,11 @@ void free_mem2Dquant(LevelQuantParams **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dquant: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -379,7 +752,7 @@ void free_mem3Dquant(LevelQuantParams ***array3D)
   if (array3D)
   {
     free_mem2Dquant(*array3D);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -399,7 +772,7 @@ void free_mem4Dquant(LevelQuantParams ****array4D)
   if (array4D)
   {
     free_mem3Dquant(*array4D);
-    free (array4D);
+    mem_free (array4D);
   }
   else
   {
@@ -419,7 +792,7 @@ void free_mem5Dquant(LevelQuantParams *****array5D)
   if (array5D)
   {
     free_mem4Dquant(*array5D);
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -440,9 +813,9 @@ int get_mem2D_spp(StorablePicturePtr ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (StorablePicturePtr**)malloc(dim0 *      sizeof(StorablePicturePtr*))) == NULL)
+  if((*array2D    = (StorablePicturePtr**)mem_malloc(dim0 *      sizeof(StorablePicturePtr*))) == NULL)
     no_mem_exit("get_mem2D_spp: array2D");
-  if((*(*array2D) = (StorablePicturePtr* )calloc(dim0 * dim1,sizeof(StorablePicturePtr ))) == NULL)
+  if((*(*array2D) = (StorablePicturePtr* )mem_calloc(dim0 * dim1,sizeof(StorablePicturePtr ))) == NULL)
     no_mem_exit("get_mem2D_spp: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -464,7 +837,7 @@ int get_mem3D_spp(StorablePicturePtr ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(StorablePicturePtr**);
 
-  if(((*array3D) = (StorablePicturePtr***)malloc(dim0 * sizeof(StorablePicturePtr**))) == NULL)
+  if(((*array3D) = (StorablePicturePtr***)mem_malloc(dim0 * sizeof(StorablePicturePtr**))) == NULL)
     no_mem_exit("get_mem3D_spp: array3D");
 
   mem_size += get_mem2D_spp(*array3D, dim0 * dim1, dim2);
@@ -487,9 +860,9 @@ int get_mem2Dmv(MotionVector ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (MotionVector**)malloc(dim0 *      sizeof(MotionVector*))) == NULL)
+  if((*array2D    = (MotionVector**)mem_malloc(dim0 *      sizeof(MotionVector*))) == NULL)
     no_mem_exit("get_mem2Dmv: array2D");
-  if((*(*array2D) = (MotionVector* )calloc(dim0 * dim1,sizeof(MotionVector ))) == NULL)
+  if((*(*array2D) = (MotionVector* )mem_calloc(dim0 * dim1,sizeof(MotionVector ))) == NULL)
     no_mem_exit("get_mem2Dmv: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -511,7 +884,7 @@ int get_mem3Dmv(MotionVector ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(MotionVector**);
 
-  if(((*array3D) = (MotionVector***)malloc(dim0 * sizeof(MotionVector**))) == NULL)
+  if(((*array3D) = (MotionVector***)mem_malloc(dim0 * sizeof(MotionVector**))) == NULL)
     no_mem_exit("get_mem3Dmv: array3D");
 
   mem_size += get_mem2Dmv(*array3D, dim0 * dim1, dim2);
@@ -535,7 +908,7 @@ int get_mem4Dmv(MotionVector *****array4D, int dim0, int dim1, int dim2, int dim
 {
   int i, mem_size = dim0 * sizeof(MotionVector***);
 
-  if(((*array4D) = (MotionVector****)malloc(dim0 * sizeof(MotionVector***))) == NULL)
+  if(((*array4D) = (MotionVector****)mem_malloc(dim0 * sizeof(MotionVector***))) == NULL)
     no_mem_exit("get_mem4Dpel: array4D");
 
   mem_size += get_mem3Dmv(*array4D, dim0 * dim1, dim2, dim3);
@@ -559,7 +932,7 @@ int get_mem5Dmv(MotionVector ******array5D, int dim0, int dim1, int dim2, int di
 {
   int i, mem_size = dim0 * sizeof(MotionVector***);
 
-  if(((*array5D) = (MotionVector*****)malloc(dim0 * sizeof(MotionVector****))) == NULL)
+  if(((*array5D) = (MotionVector*****)mem_malloc(dim0 * sizeof(MotionVector****))) == NULL)
     no_mem_exit("get_mem5Dpel: array5D");
 
   mem_size += get_mem4Dmv(*array5D, dim0 * dim1, dim2, dim3, dim4);
@@ -583,7 +956,7 @@ int get_mem6Dmv(MotionVector *******array6D, int dim0, int dim1, int dim2, int d
 {
   int i, mem_size = dim0 * sizeof(MotionVector*****);
 
-  if(((*array6D) = (MotionVector******)malloc(dim0 * sizeof(MotionVector*****))) == NULL)
+  if(((*array6D) = (MotionVector******)mem_malloc(dim0 * sizeof(MotionVector*****))) == NULL)
     no_mem_exit("get_mem5Dpel: array6D");
 
   mem_size += get_mem5Dmv(*array6D, dim0 * dim1, dim2, dim3, dim4, dim5);
@@ -607,7 +980,7 @@ int get_mem7Dmv(MotionVector ********array7D, int dim0, int dim1, int dim2, int
 {
   int i, mem_size = dim0 * sizeof(MotionVector******);
 
-  if(((*array7D) = (MotionVector*******)malloc(dim0 * sizeof(MotionVector******))) == NULL)
+  if(((*array7D) = (MotionVector*******)mem_malloc(dim0 * sizeof(MotionVector******))) == NULL)
     no_mem_exit("get_mem7Dmv: array7D");
 
   mem_size += get_mem6Dmv(*array7D, dim0 * dim1, dim2, dim3, dim4, dim5, dim6);
@@ -630,11 +1003,11 @@ void free_mem2D_spp(StorablePicturePtr **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2D_spp: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -655,7 +1028,7 @@ void free_mem3D_spp(StorablePicturePtr ***array3D)
   if (array3D)
   {
     free_mem2D_spp(*array3D);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -676,11 +1049,11 @@ void free_mem2Dmv(MotionVector **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dmv: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -701,7 +1074,7 @@ void free_mem3Dmv(MotionVector ***array3D)
   if (array3D)
   {
     free_mem2Dmv(*array3D);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -721,7 +1094,7 @@ void free_mem4Dmv(MotionVector ****array4D)
   if (array4D)
   {
     free_mem3Dmv(*array4D);
-    free (array4D);
+    mem_free (array4D);
   }
   else
   {
@@ -741,7 +1114,7 @@ void free_mem5Dmv(MotionVector *****array5D)
   if (array5D)
   {
     free_mem4Dmv(*array5D);
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -760,7 +1133,7 @@ void free_mem6Dmv(MotionVector ******array6D)
   if (array6D)
   {
     free_mem5Dmv(*array6D);
-    free (array6D);
+    mem_free (array6D);
   }
   else
   {
@@ -780,7 +1153,7 @@ void free_mem7Dmv(MotionVector *******array7D)
   if (array7D)
   {
     free_mem6Dmv(*array7D);
-    free (array7D);
+    mem_free (array7D);
   }
   else
   {
@@ -800,7 +1173,7 @@ void free_mem7Dmv(MotionVector *******array7D)
  ************************************************************************/
 int get_mem1Dpel(imgpel **array1D, int dim0)
 {
-  if((*array1D    = (imgpel*)calloc(dim0,       sizeof(imgpel))) == NULL)
+  if((*array1D    = (imgpel*)mem_calloc(dim0,       sizeof(imgpel))) == NULL)
     no_mem_exit("get_mem1Dpel: arra12D");
 
   return (sizeof(imgpel*) + dim0 * sizeof(imgpel));
@@ -818,9 +1191,9 @@ int get_mem2Dpel(imgpel ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (imgpel**)malloc(dim0 * sizeof(imgpel*))) == NULL)
+  if((*array2D    = (imgpel**)mem_malloc(dim0 * sizeof(imgpel*))) == NULL)
     no_mem_exit("get_mem2Dpel: array2D");
-  if((*(*array2D) = (imgpel* )calloc(dim0 * dim1,sizeof(imgpel ))) == NULL)
+  if((*(*array2D) = (imgpel* )mem_calloc_plane(dim0 * dim1,sizeof(imgpel ))) == NULL)
     no_mem_exit("get_mem2Dpel: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -837,9 +1210,9 @@ int get_mem2DpelWithPad(imgpel ***array2D, int dim0, int dim1, int iPadY, int iP
   
   iHeight = dim0+2*iPadY;
   iWidth = dim1+2*iPadX;
-  if((*array2D    = (imgpel**)malloc(iHeight*sizeof(imgpel*))) == NULL)
+  if((*array2D    = (imgpel**)mem_malloc(iHeight*sizeof(imgpel*))) == NULL)
     no_mem_exit("get_mem2DpelWithPad: array2D");
-  if((*(*array2D) = (imgpel* )calloc(iHeight * iWidth, sizeof(imgpel ))) == NULL)
+  if((*(*array2D) = (imgpel* )mem_calloc_plane(iHeight * iWidth, sizeof(imgpel ))) == NULL)
     no_mem_exit("get_mem2DpelWithPad: array2D");
 
   (*array2D)[0] += iPadX;
@@ -868,7 +1241,7 @@ int get_mem3Dpel(imgpel ****array3D, int dim0, int dim1, int dim2)
 {
   int i, mem_size = dim0 * sizeof(imgpel**);
 
-  if(((*array3D) = (imgpel***)malloc(dim0 * sizeof(imgpel**))) == NULL)
+  if(((*array3D) = (imgpel***)mem_malloc(dim0 * sizeof(imgpel**))) == NULL)
     no_mem_exit("get_mem3Dpel: array3D");
 
   mem_size += get_mem2Dpel(*array3D, dim0 * dim1, dim2);
@@ -883,7 +1256,7 @@ int get_mem3DpelWithPad(imgpel ****array3D, int dim0, int dim1, int dim2, int iP
 {
   int i, mem_size = dim0 * sizeof(imgpel**);
 
-  if(((*array3D) = (imgpel***)malloc(dim0*sizeof(imgpel**))) == NULL)
+  if(((*array3D) = (imgpel***)mem_malloc(dim0*sizeof(imgpel**))) == NULL)
     no_mem_exit("get_mem3DpelWithPad: array3D");
 
   mem_size += get_mem2DpelWithPad(*array3D, dim0*dim1+2*(dim0-1)*iPadY, dim2, iPadY, iPadX);
@@ -898,7 +1271,7 @@ int get_mem3DpelWithPadSeparately(imgpel ****array3D, int dim0, int dim1, int di
 {
   int i, mem_size = dim0 * sizeof(imgpel**);
 
-  if(((*array3D) = (imgpel***)malloc(dim0*sizeof(imgpel**))) == NULL)
+  if(((*array3D) = (imgpel***)mem_malloc(dim0*sizeof(imgpel**))) == NULL)
     no_mem_exit("get_mem3DpelWithPadSeparately: array3D");
 
   for(i = 0; i < dim0; i++)
@@ -921,7 +1294,7 @@ int get_mem4Dpel(imgpel *****array4D, int dim0, int dim1, int dim2, int dim3)
 {  
   int  i, mem_size = dim0 * sizeof(imgpel***);
 
-  if(((*array4D) = (imgpel****)malloc(dim0 * sizeof(imgpel***))) == NULL)
+  if(((*array4D) = (imgpel****)mem_malloc(dim0 * sizeof(imgpel***))) == NULL)
     no_mem_exit("get_mem4Dpel: array4D");
 
   mem_size += get_mem3Dpel(*array4D, dim0 * dim1, dim2, dim3);
@@ -936,7 +1309,7 @@ int get_mem4DpelWithPad(imgpel *****array4D, int dim0, int dim1, int dim2, int d
 {  
   int  i, mem_size = dim0 * sizeof(imgpel***);
 
-  if(((*array4D) = (imgpel****)malloc(dim0 * sizeof(imgpel***))) == NULL)
+  if(((*array4D) = (imgpel****)mem_malloc(dim0 * sizeof(imgpel***))) == NULL)
     no_mem_exit("get_mem4DpelWithPad: array4D");
 
   mem_size += get_mem3DpelWithPad(*array4D, dim0 * dim1, dim2, dim3, iPadY, iPadX);
@@ -951,7 +1324,7 @@ int get_mem4DpelWithPadSeparately(imgpel *****array4D, int dim0, int dim1, int d
 {  
   int  i, mem_size = dim0 * sizeof(imgpel***);
 
-  if(((*array4D) = (imgpel****)malloc(dim0 * sizeof(imgpel***))) == NULL)
+  if(((*array4D) = (imgpel****)mem_malloc(dim0 * sizeof(imgpel***))) == NULL)
     no_mem_exit("get_mem4DpelWithPadSeparately: array4D");
 
   mem_size += get_mem3DpelWithPadSeparately(*array4D, dim0 * dim1, dim2, dim3, iPadY, iPadX);
@@ -975,7 +1348,7 @@ int get_mem5Dpel(imgpel ******array5D, int dim0, int dim1, int dim2, int dim3, i
 {
   int  i, mem_size = dim0 * sizeof(imgpel****);
 
-  if(((*array5D) = (imgpel*****)malloc(dim0 * sizeof(imgpel****))) == NULL)
+  if(((*array5D) = (imgpel*****)mem_malloc(dim0 * sizeof(imgpel****))) == NULL)
     no_mem_exit("get_mem5Dpel: array5D");
 
   mem_size += get_mem4Dpel(*array5D, dim0 * dim1, dim2, dim3, dim4);
@@ -990,7 +1363,7 @@ int get_mem5DpelWithPad(imgpel ******array5D, int dim0, int dim1, int dim2, int
 {
   int  i, mem_size = dim0 * sizeof(imgpel****);
 
-  if(((*array5D) = (imgpel*****)malloc(dim0 * sizeof(imgpel****))) == NULL)
+  if(((*array5D) = (imgpel*****)mem_malloc(dim0 * sizeof(imgpel****))) == NULL)
     no_mem_exit("get_mem5DpelWithPad: array5D");
 
   mem_size += get_mem4DpelWithPad(*array5D, dim0 * dim1, dim2, dim3, dim4, iPadY, iPadX);
@@ -1005,7 +1378,7 @@ int get_mem5DpelWithPadSeparately(imgpel ******array5D, int dim0, int dim1, int
 {
   int  i, mem_size = dim0 * sizeof(imgpel****);
 
-  if(((*array5D) = (imgpel*****)malloc(dim0 * sizeof(imgpel****))) == NULL)
+  if(((*array5D) = (imgpel*****)mem_malloc(dim0 * sizeof(imgpel****))) == NULL)
     no_mem_exit("get_mem5DpelWithPadSeparately: array5D");
 
   mem_size += get_mem4DpelWithPadSeparately(*array5D, dim0 * dim1, dim2, dim3, dim4, iPadY, iPadX);
@@ -1027,7 +1400,7 @@ void free_mem1Dpel(imgpel *array1D)
 {
   if (array1D)
   {
-    free (array1D);
+    mem_free (array1D);
   } 
   else
   {
@@ -1047,11 +1420,11 @@ void free_mem2Dpel(imgpel **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dpel: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -1064,11 +1437,11 @@ void free_mem2DpelWithPad(imgpel **array2D, int iPadY, int iPadX)
   if (array2D)
   {
     if (*array2D)
-      free (array2D[-iPadY]-iPadX);
+      mem_free (array2D[-iPadY]-iPadX);
     else 
       error ("free_mem2DpelWithPad: trying to free unused memory",100);
 
-    free (&array2D[-iPadY]);
+    mem_free (&array2D[-iPadY]);
   } 
   else
   {
@@ -1089,7 +1462,7 @@ void free_mem3Dpel(imgpel ***array3D)
   if (array3D)
   {
     free_mem2Dpel(*array3D);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -1102,7 +1475,7 @@ void free_mem3DpelWithPad(imgpel ***array3D, int iPadY, int iPadX)
   if (array3D)
   {
     free_mem2DpelWithPad(*array3D, iPadY, iPadX);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -1122,7 +1495,7 @@ void free_mem3DpelWithPadSeparately(imgpel ***array3D, int iDim12, int iPadY, in
         free_mem2DpelWithPad(array3D[i], iPadY, iPadX);
         array3D[i] = NULL;
       }
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -1143,7 +1516,7 @@ void free_mem4Dpel(imgpel ****array4D)
   if (array4D)
   {
     free_mem3Dpel(*array4D);
-    free (array4D);
+    mem_free (array4D);
   }
   else
   {
@@ -1156,7 +1529,7 @@ void free_mem4DpelWithPad(imgpel  ****array4D, int iPadY, int iPadX)
   if (array4D)
   {
     free_mem3DpelWithPad(*array4D, iPadY, iPadX);
-    free (array4D);
+    mem_free (array4D);
   }
   else
   {
@@ -1169,7 +1542,7 @@ void free_mem4DpelWithPadSeparately(imgpel  ****array4D, int iFrames, int iPadY,
   if (array4D)
   {
     free_mem3DpelWithPadSeparately(*array4D, iFrames, iPadY, iPadX);
-    free (array4D);
+    mem_free (array4D);
   }
   else
   {
@@ -1189,7 +1562,7 @@ void free_mem5Dpel(imgpel *****array5D)
   if (array5D)
   {
     free_mem4Dpel(*array5D);
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -1202,7 +1575,7 @@ void free_mem5DpelWithPad(imgpel *****array5D, int iPadY, int iPadX)
   if (array5D)
   {
     free_mem4DpelWithPad(*array5D, iPadY, iPadX);
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -1215,7 +1588,7 @@ void free_mem5DpelWithPadSeparately(imgpel *****array5D, int iFrames, int iPadY,
   if (array5D)
   {
     free_mem4DpelWithPadSeparately(*array5D, iFrames, iPadY, iPadX);
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -1237,9 +1610,9 @@ byte** new_mem2D(int dim0, int dim1)
   int i;
   byte **array2D;
 
-  if((  array2D  = (byte**)malloc(dim0 *      sizeof(byte*))) == NULL)
+  if((  array2D  = (byte**)mem_malloc(dim0 *      sizeof(byte*))) == NULL)
     no_mem_exit("get_mem2D: array2D");
-  if((*(array2D) = (byte* )calloc(dim0 * dim1,sizeof(byte ))) == NULL)
+  if((*(array2D) = (byte* )mem_calloc(dim0 * dim1,sizeof(byte ))) == NULL)
     no_mem_exit("get_mem2D: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1260,9 +1633,9 @@ int get_mem2D(byte ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((  *array2D  = (byte**)malloc(dim0 *      sizeof(byte*))) == NULL)
+  if((  *array2D  = (byte**)mem_malloc(dim0 *      sizeof(byte*))) == NULL)
     no_mem_exit("get_mem2D: array2D");
-  if((*(*array2D) = (byte* )calloc(dim0 * dim1,sizeof(byte ))) == NULL)
+  if((*(*array2D) = (byte* )mem_calloc(dim0 * dim1,sizeof(byte ))) == NULL)
     no_mem_exit("get_mem2D: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1286,9 +1659,9 @@ int** new_mem2Dint(int dim0, int dim1)
   int i;
   int **array2D;
 
-  if((array2D    = (int**)malloc(dim0 *        sizeof(int*))) == NULL)
+  if((array2D    = (int**)mem_malloc(dim0 *        sizeof(int*))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
-  if((*(array2D) = (int* )calloc(dim0 * dim1, sizeof(int ))) == NULL)
+  if((*(array2D) = (int* )mem_calloc(dim0 * dim1, sizeof(int ))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -1310,9 +1683,9 @@ int get_mem2Dint(int ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (int**)malloc(dim0 *       sizeof(int*))) == NULL)
+  if((*array2D    = (int**)mem_malloc(dim0 *       sizeof(int*))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
-  if((*(*array2D) = (int* )calloc(dim0 * dim1, sizeof(int ))) == NULL)
+  if((*(*array2D) = (int* )mem_calloc(dim0 * dim1, sizeof(int ))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
 
   for(i = 1 ; i < dim0; i++)
@@ -1329,9 +1702,9 @@ int get_mem2DintWithPad(int ***array2D, int dim0, int dim1, int iPadY, int iPadX
   
   iHeight = dim0+2*iPadY;
   iWidth = dim1+2*iPadX;
-  if((*array2D    = (int**)malloc(iHeight*sizeof(int*))) == NULL)
+  if((*array2D    = (int**)mem_malloc(iHeight*sizeof(int*))) == NULL)
     no_mem_exit("get_mem2DintWithPad: array2D");
-  if((*(*array2D) = (int* )calloc(iHeight * iWidth, sizeof(int ))) == NULL)
+  if((*(*array2D) = (int* )mem_calloc(iHeight * iWidth, sizeof(int ))) == NULL)
     no_mem_exit("get_mem2DintWithPad: array2D");
 
   (*array2D)[0] += iPadX;
@@ -1359,9 +1732,9 @@ int get_mem2Dint64(int64 ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (int64**)malloc(dim0 *      sizeof(int64*))) == NULL)
+  if((*array2D    = (int64**)mem_malloc(dim0 *      sizeof(int64*))) == NULL)
     no_mem_exit("get_mem2Dint64: array2D");
-  if((*(*array2D) = (int64* )calloc(dim0 * dim1,sizeof(int64 ))) == NULL)
+  if((*(*array2D) = (int64* )mem_calloc(dim0 * dim1,sizeof(int64 ))) == NULL)
     no_mem_exit("get_mem2Dint64: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1374,9 +1747,9 @@ int get_mem2Ddistblk(distblk ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D    = (distblk**)malloc(dim0 *      sizeof(distblk*))) == NULL)
+  if((*array2D    = (distblk**)mem_malloc(dim0 *      sizeof(distblk*))) == NULL)
     no_mem_exit("get_mem2Ddistblk: array2D");
-  if((*(*array2D) = (distblk* )calloc(dim0 * dim1,sizeof(distblk ))) == NULL)
+  if((*(*array2D) = (distblk* )mem_calloc(dim0 * dim1,sizeof(distblk ))) == NULL)
     no_mem_exit("get_mem2Ddistblk: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1398,7 +1771,7 @@ int get_mem3D(byte ****array3D, int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(byte**);
 
-  if(((*array3D) = (byte***)malloc(dim0 * sizeof(byte**))) == NULL)
+  if(((*array3D) = (byte***)mem_malloc(dim0 * sizeof(byte**))) == NULL)
     no_mem_exit("get_mem3D: array3D");
 
   mem_size += get_mem2D(*array3D, dim0 * dim1, dim2);
@@ -1422,7 +1795,7 @@ int get_mem4D(byte *****array4D, int dim0, int dim1, int dim2, int dim3)
 {
   int  i, mem_size = dim0 * sizeof(byte***);
 
-  if(((*array4D) = (byte****)malloc(dim0 * sizeof(byte***))) == NULL)
+  if(((*array4D) = (byte****)mem_malloc(dim0 * sizeof(byte***))) == NULL)
     no_mem_exit("get_mem4D: array4D");
 
   mem_size += get_mem3D(*array4D, dim0 * dim1, dim2, dim3);
@@ -1446,7 +1819,7 @@ int get_mem3Dint(int ****array3D, int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(int**);
 
-  if(((*array3D) = (int***)malloc(dim0 * sizeof(int**))) == NULL)
+  if(((*array3D) = (int***)mem_malloc(dim0 * sizeof(int**))) == NULL)
     no_mem_exit("get_mem3Dint: array3D");
 
   mem_size += get_mem2Dint(*array3D, dim0 * dim1, dim2);
@@ -1470,7 +1843,7 @@ int get_mem3Dint64(int64 ****array3D, int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(int64**);
 
-  if(((*array3D) = (int64***)malloc(dim0 * sizeof(int64**))) == NULL)
+  if(((*array3D) = (int64***)mem_malloc(dim0 * sizeof(int64**))) == NULL)
     no_mem_exit("get_mem3Dint64: array3D");
 
   mem_size += get_mem2Dint64(*array3D, dim0 * dim1, dim2);
@@ -1485,7 +1858,7 @@ int get_mem3Ddistblk(distblk ****array3D, int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(distblk**);
 
-  if(((*array3D) = (distblk***)malloc(dim0 * sizeof(distblk**))) == NULL)
+  if(((*array3D) = (distblk***)mem_malloc(dim0 * sizeof(distblk**))) == NULL)
     no_mem_exit("get_mem3Ddistblk: array3D");
 
   mem_size += get_mem2Ddistblk(*array3D, dim0 * dim1, dim2);
@@ -1509,7 +1882,7 @@ int get_mem4Dint(int *****array4D, int dim0, int dim1, int dim2, int dim3)
 {
   int  i, mem_size = dim0 * sizeof(int***);
 
-  if(((*array4D) = (int****)malloc(dim0 * sizeof(int***))) == NULL)
+  if(((*array4D) = (int****)mem_malloc(dim0 * sizeof(int***))) == NULL)
     no_mem_exit("get_mem4Dint: array4D");
 
   mem_size += get_mem3Dint(*array4D, dim0 * dim1, dim2, dim3);
@@ -1524,7 +1897,7 @@ int get_mem4Dint64(int64 *****array4D, int dim0, int dim1, int dim2, int dim3)
 {
   int  i, mem_size = dim0 * sizeof(int64***);
 
-  if(((*array4D) = (int64****)malloc(dim0 * sizeof(int64***))) == NULL)
+  if(((*array4D) = (int64****)mem_malloc(dim0 * sizeof(int64***))) == NULL)
     no_mem_exit("get_mem4Dint64: array4D");
 
   mem_size += get_mem3Dint64(*array4D, dim0 * dim1, dim2, dim3);
@@ -1539,7 +1912,7 @@ int get_mem4Ddistblk(distblk *****array4D, int dim0, int dim1, int dim2, int dim
 {
   int  i, mem_size = dim0 * sizeof(distblk***);
 
-  if(((*array4D) = (distblk****)malloc(dim0 * sizeof(distblk***))) == NULL)
+  if(((*array4D) = (distblk****)mem_malloc(dim0 * sizeof(distblk***))) == NULL)
     no_mem_exit("get_mem4Ddistblk: array4D");
 
   mem_size += get_mem3Ddistblk(*array4D, dim0 * dim1, dim2, dim3);
@@ -1563,7 +1936,7 @@ int get_mem5Dint(int ******array5D, int dim0, int dim1, int dim2, int dim3, int
 {
   int  i, mem_size = dim0 * sizeof(int****);
 
-  if(((*array5D) = (int*****)malloc(dim0 * sizeof(int****))) == NULL)
+  if(((*array5D) = (int*****)mem_malloc(dim0 * sizeof(int****))) == NULL)
     no_mem_exit("get_mem5Dint: array5D");
 
   mem_size += get_mem4Dint(*array5D, dim0 * dim1, dim2, dim3, dim4);
@@ -1587,11 +1960,11 @@ void free_mem2D(byte **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2D: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -1611,11 +1984,11 @@ void free_mem2Dint(int **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dint: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -1628,11 +2001,11 @@ void free_mem2DintWithPad(int **array2D, int iPadY, int iPadX)
   if (array2D)
   {
     if (*array2D)
-      free (array2D[-iPadY]-iPadX);
+      mem_free (array2D[-iPadY]-iPadX);
     else 
       error ("free_mem2DintWithPad: trying to free unused memory",100);
 
-    free (&array2D[-iPadY]);
+    mem_free (&array2D[-iPadY]);
   } 
   else
   {
@@ -1652,10 +2025,10 @@ void free_mem2Dint64(int64 **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Dint64: trying to free unused memory",100);
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -1676,7 +2049,7 @@ void free_mem3D(byte ***array3D)
   if (array3D)
   {
    free_mem2D(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -1696,7 +2069,7 @@ void free_mem4D(byte ****array4D)
   if (array4D)
   {
    free_mem3D(*array4D);
-   free (array4D);
+   mem_free (array4D);
   } 
   else
   {
@@ -1716,7 +2089,7 @@ void free_mem3Dint(int ***array3D)
   if (array3D)
   {
    free_mem2Dint(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -1737,7 +2110,7 @@ void free_mem3Dint64(int64 ***array3D)
   if (array3D)
   {
    free_mem2Dint64(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -1750,7 +2123,7 @@ void free_mem3Ddistblk(distblk ***array3D)
   if (array3D)
   {
    free_mem2Ddistblk(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -1770,7 +2143,7 @@ void free_mem4Dint(int ****array4D)
   if (array4D)
   {
     free_mem3Dint( *array4D);
-    free (array4D);
+    mem_free (array4D);
   } else
   {
     error ("free_mem4Dint: trying to free unused memory",100);
@@ -1782,7 +2155,7 @@ void free_mem4Dint64(int64 ****array4D)
   if (array4D)
   {
     free_mem3Dint64( *array4D);
-    free (array4D);
+    mem_free (array4D);
   } else
   {
     error ("free_mem4Dint64: trying to free unused memory",100);
@@ -1794,7 +2167,7 @@ void free_mem4Ddistblk(distblk ****array4D)
   if (array4D)
   {
     free_mem3Ddistblk( *array4D);
-    free (array4D);
+    mem_free (array4D);
   } else
   {
     error ("free_mem4Ddistblk: trying to free unused memory",100);
@@ -1813,7 +2186,7 @@ void free_mem5Dint(int *****array5D)
   if (array5D)
   {
     free_mem4Dint( *array5D);
-    free (array5D);
+    mem_free (array5D);
   } else
   {
     error ("free_mem5Dint: trying to free unused memory",100);
@@ -1849,9 +2222,9 @@ uint16** new_mem2Duint16(int dim0, int dim1)
   int i;
   uint16 **array2D;
 
-  if(( array2D = (uint16**)malloc(dim0 *      sizeof(uint16*))) == NULL)
+  if(( array2D = (uint16**)mem_malloc(dim0 *      sizeof(uint16*))) == NULL)
     no_mem_exit("get_mem2Duint16: array2D");
-  if((*array2D = (uint16* )calloc(dim0 * dim1,sizeof(uint16 ))) == NULL)
+  if((*array2D = (uint16* )mem_calloc(dim0 * dim1,sizeof(uint16 ))) == NULL)
     no_mem_exit("get_mem2Duint16: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1873,10 +2246,10 @@ int get_mem2Duint16(uint16 ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((  *array2D  = (uint16**)malloc(dim0 *      sizeof(uint16*))) == NULL)
+  if((  *array2D  = (uint16**)mem_malloc(dim0 *      sizeof(uint16*))) == NULL)
     no_mem_exit("get_mem2Duint16: array2D");
 
-  if((*(*array2D) = (uint16* )calloc(dim0 * dim1,sizeof(uint16 ))) == NULL)
+  if((*(*array2D) = (uint16* )mem_calloc(dim0 * dim1,sizeof(uint16 ))) == NULL)
     no_mem_exit("get_mem2Duint16: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1898,7 +2271,7 @@ int get_mem3Duint16(uint16 ****array3D,int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(uint16**);
 
-  if(((*array3D) = (uint16***)malloc(dim0 * sizeof(uint16**))) == NULL)
+  if(((*array3D) = (uint16***)mem_malloc(dim0 * sizeof(uint16**))) == NULL)
     no_mem_exit("get_mem3Duint16: array3D");
 
   mem_size += get_mem2Duint16(*array3D, dim0 * dim1, dim2);
@@ -1923,7 +2296,7 @@ int get_mem4Duint16(uint16 *****array4D, int dim0, int dim1, int dim2, int dim3)
 {
   int  i, mem_size = dim0 * sizeof(uint16***);
 
-  if(((*array4D) = (uint16****)malloc(dim0 * sizeof(uint16***))) == NULL)
+  if(((*array4D) = (uint16****)mem_malloc(dim0 * sizeof(uint16***))) == NULL)
     no_mem_exit("get_mem4Duint16: array4D");
 
   mem_size += get_mem3Duint16(*array4D, dim0 * dim1, dim2, dim3);
@@ -1947,9 +2320,9 @@ int get_mem2Dshort(short ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((  *array2D  = (short**)malloc(dim0 *      sizeof(short*))) == NULL)
+  if((  *array2D  = (short**)mem_malloc(dim0 *      sizeof(short*))) == NULL)
     no_mem_exit("get_mem2Dshort: array2D");
-  if((*(*array2D) = (short* )calloc(dim0 * dim1,sizeof(short ))) == NULL)
+  if((*(*array2D) = (short* )mem_calloc(dim0 * dim1,sizeof(short ))) == NULL)
     no_mem_exit("get_mem2Dshort: array2D");
 
   for(i = 1; i < dim0; i++)
@@ -1971,7 +2344,7 @@ int get_mem3Dshort(short ****array3D,int dim0, int dim1, int dim2)
 {
   int  i, mem_size = dim0 * sizeof(short**);
 
-  if(((*array3D) = (short***)malloc(dim0 * sizeof(short**))) == NULL)
+  if(((*array3D) = (short***)mem_malloc(dim0 * sizeof(short**))) == NULL)
     no_mem_exit("get_mem3Dshort: array3D");
 
   mem_size += get_mem2Dshort(*array3D, dim0 * dim1, dim2);
@@ -1996,7 +2369,7 @@ int get_mem4Dshort(short *****array4D, int dim0, int dim1, int dim2, int dim3)
 {
   int  i, mem_size = dim0 * sizeof(short***);
 
-  if(((*array4D) = (short****)malloc(dim0 * sizeof(short***))) == NULL)
+  if(((*array4D) = (short****)mem_malloc(dim0 * sizeof(short***))) == NULL)
     no_mem_exit("get_mem4Dshort: array4D");
 
   mem_size += get_mem3Dshort(*array4D, dim0 * dim1, dim2, dim3);
@@ -2020,7 +2393,7 @@ int get_mem5Dshort(short ******array5D, int dim0, int dim1, int dim2, int dim3,
 {
   int  i, mem_size = dim0 * sizeof(short****);
 
-  if(((*array5D) = (short*****)malloc(dim0 * sizeof(short****))) == NULL)
+  if(((*array5D) = (short*****)mem_malloc(dim0 * sizeof(short****))) == NULL)
     no_mem_exit("get_mem5Dshort: array5D");
 
   mem_size += get_mem4Dshort(*array5D, dim0 * dim1, dim2, dim3, dim4);
@@ -2044,7 +2417,7 @@ int get_mem6Dshort(short *******array6D, int dim0, int dim1, int dim2, int dim3,
 {
   int  i, mem_size = dim0 * sizeof(short*****);
 
-  if(((*array6D) = (short******)malloc(dim0 * sizeof(short*****))) == NULL)
+  if(((*array6D) = (short******)mem_malloc(dim0 * sizeof(short*****))) == NULL)
     no_mem_exit("get_mem6Dshort: array6D");
 
   mem_size += get_mem5Dshort(*array6D, dim0 * dim1, dim2, dim3, dim4, dim5);
@@ -2068,7 +2441,7 @@ int get_mem7Dshort(short ********array7D, int dim0, int dim1, int dim2, int dim3
 {
   int  i, mem_size = dim0 * sizeof(short******);
 
-  if(((*array7D) = (short*******)malloc(dim0 * sizeof(short******))) == NULL)
+  if(((*array7D) = (short*******)mem_malloc(dim0 * sizeof(short******))) == NULL)
     no_mem_exit("get_mem7Dshort: array7D");
 
   mem_size += get_mem6Dshort(*array7D, dim0 * dim1, dim2, dim3, dim4, dim5, dim6);
@@ -2091,10 +2464,10 @@ void free_mem2Duint16(uint16 **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else error ("free_mem2Duint16: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -2114,7 +2487,7 @@ void free_mem3Duint16(uint16 ***array3D)
   if (array3D)
   {
    free_mem2Duint16(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -2134,7 +2507,7 @@ void free_mem4Duint16(uint16 ****array4D)
   if (array4D)
   {
     free_mem3Duint16( *array4D);
-    free (array4D);
+    mem_free (array4D);
   } 
   else
   {
@@ -2154,10 +2527,10 @@ void free_mem2Dshort(short **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else error ("free_mem2Dshort: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -2177,7 +2550,7 @@ void free_mem3Dshort(short ***array3D)
   if (array3D)
   {
    free_mem2Dshort(*array3D);
-   free (array3D);
+   mem_free (array3D);
   } 
   else
   {
@@ -2197,7 +2570,7 @@ void free_mem4Dshort(short ****array4D)
   if (array4D)
   {
     free_mem3Dshort( *array4D);
-    free (array4D);
+    mem_free (array4D);
   } 
   else
   {
@@ -2217,7 +2590,7 @@ void free_mem5Dshort(short *****array5D)
   if (array5D)
   {
     free_mem4Dshort( *array5D) ;
-    free (array5D);
+    mem_free (array5D);
   }
   else
   {
@@ -2237,7 +2610,7 @@ void free_mem6Dshort(short ******array6D)
   if (array6D)
   {
     free_mem5Dshort( *array6D);
-    free (array6D);
+    mem_free (array6D);
   }
   else
   {
@@ -2257,7 +2630,7 @@ void free_mem7Dshort(short *******array7D)
   if (array7D)
   {
     free_mem6Dshort( *array7D);
-    free (array7D);
+    mem_free (array7D);
   }
   else
   {
@@ -2278,10 +2651,10 @@ int get_mem2Ddouble(double ***array2D, int dim0, int dim1)
 {
   int i;
 
-  if((*array2D      = (double**)malloc(dim0 * sizeof(double*))) == NULL)
+  if((*array2D      = (double**)mem_malloc(dim0 * sizeof(double*))) == NULL)
     no_mem_exit("get_mem2Ddouble: array2D");
   
-  if(((*array2D)[0] = (double* )calloc(dim0 * dim1,sizeof(double ))) == NULL)
+  if(((*array2D)[0] = (double* )mem_calloc(dim0 * dim1,sizeof(double ))) == NULL)
     no_mem_exit("get_mem2Ddouble: array2D");
 
   for(i=1 ; i<dim0 ; i++)
@@ -2302,7 +2675,7 @@ int get_mem2Ddouble(double ***array2D, int dim0, int dim1)
  */
 int get_mem1Dodouble(double **array1D, int dim0, int offset)
 {
-  if((*array1D      = (double*)malloc(dim0 *       sizeof(double))) == NULL)
+  if((*array1D      = (double*)mem_malloc(dim0 *       sizeof(double))) == NULL)
     no_mem_exit("get_mem1Dodouble: array2D");
 
   *array1D += offset;
@@ -2324,9 +2697,9 @@ int get_mem2Dodouble(double ***array2D, int dim0, int dim1, int offset)
 {
   int i;
 
-  if((*array2D      = (double**)malloc(dim0 *       sizeof(double*))) == NULL)
+  if((*array2D      = (double**)mem_malloc(dim0 *       sizeof(double*))) == NULL)
     no_mem_exit("get_mem2Dodouble: array2D");
-  if(((*array2D)[0] = (double* )calloc(dim0 * dim1, sizeof(double ))) == NULL)
+  if(((*array2D)[0] = (double* )mem_calloc(dim0 * dim1, sizeof(double ))) == NULL)
     no_mem_exit("get_mem2Dodouble: array2D");
 
   (*array2D)[0] += offset;
@@ -2350,10 +2723,10 @@ int get_mem3Dodouble(double ****array3D, int dim0, int dim1, int dim2, int offse
 {
   int  i,j;
 
-  if(((*array3D) = (double***)malloc(dim0 * sizeof(double**))) == NULL)
+  if(((*array3D) = (double***)mem_malloc(dim0 * sizeof(double**))) == NULL)
     no_mem_exit("get_mem3Dodouble: array3D");
 
-  if(((*array3D)[0] = (double** )calloc(dim0 * dim1, sizeof(double*))) == NULL)
+  if(((*array3D)[0] = (double** )mem_calloc(dim0 * dim1, sizeof(double*))) == NULL)
     no_mem_exit("get_mem3Dodouble: array3D");
 
   (*array3D) [0] += offset;
@@ -2363,7 +2736,7 @@ int get_mem3Dodouble(double ****array3D, int dim0, int dim1, int dim2, int offse
 
   for (i = 0; i < dim0; i++)
     for (j = -offset; j < dim1 - offset; j++)
-      if(((*array3D)[i][j] = (double* )calloc(dim2, sizeof(double))) == NULL)
+      if(((*array3D)[i][j] = (double* )mem_calloc(dim2, sizeof(double))) == NULL)
         no_mem_exit("get_mem3Dodouble: array3D");
 
   return dim0*( sizeof(double**) + dim1 * ( sizeof(double*) + dim2 * sizeof(double)));
@@ -2384,10 +2757,10 @@ int get_offset_mem2Dshort(short ***array2D, int dim0, int dim1, int offset_y, in
 {
   int i;
 
-  if((*array2D      = (short**)malloc(dim0 * sizeof(short*))) == NULL)
+  if((*array2D      = (short**)mem_malloc(dim0 * sizeof(short*))) == NULL)
     no_mem_exit("get_offset_mem2Dshort: array2D");
 
-  if(((*array2D)[0] = (short* )calloc(dim0 * dim1, sizeof(short))) == NULL)
+  if(((*array2D)[0] = (short* )mem_calloc(dim0 * dim1, sizeof(short))) == NULL)
     no_mem_exit("get_offset_mem2Dshort: array2D");
   (*array2D)[0] += offset_x + offset_y * dim1;
 
@@ -2415,10 +2788,10 @@ int get_mem3Doint(int ****array3D, int dim0, int dim1, int dim2, int offset)
 {
   int  i,j;
 
-  if(((*array3D) = (int***)malloc(dim0 * sizeof(int**))) == NULL)
+  if(((*array3D) = (int***)mem_malloc(dim0 * sizeof(int**))) == NULL)
     no_mem_exit("get_mem3Doint: array3D");
 
-  if(((*array3D)[0] = (int** )calloc(dim0 * dim1, sizeof(int*))) == NULL)
+  if(((*array3D)[0] = (int** )mem_calloc(dim0 * dim1, sizeof(int*))) == NULL)
     no_mem_exit("get_mem3Doint: array3D");
 
   (*array3D) [0] += offset;
@@ -2428,7 +2801,7 @@ int get_mem3Doint(int ****array3D, int dim0, int dim1, int dim2, int offset)
 
   for (i = 0; i < dim0; i++)
     for (j = -offset; j < dim1 - offset; j++)
-      if(((*array3D)[i][j] = (int* )calloc(dim2, sizeof(int))) == NULL)
+      if(((*array3D)[i][j] = (int* )mem_calloc(dim2, sizeof(int))) == NULL)
         no_mem_exit("get_mem3Doint: array3D");
 
   return dim0 * (sizeof(int**) + dim1 * (sizeof(int*) + dim2 * sizeof(int)));
@@ -2448,9 +2821,9 @@ int get_mem2Doint(int ***array2D, int dim0, int dim1, int offset)
 {
   int i;
 
-  if((*array2D      = (int**)malloc(dim0 * sizeof(int*))) == NULL)
+  if((*array2D      = (int**)mem_malloc(dim0 * sizeof(int*))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
-  if(((*array2D)[0] = (int* )calloc(dim0 * dim1, sizeof(int))) == NULL)
+  if(((*array2D)[0] = (int* )mem_calloc(dim0 * dim1, sizeof(int))) == NULL)
     no_mem_exit("get_mem2Dint: array2D");
 
   (*array2D)[0] += offset;
@@ -2478,7 +2851,7 @@ int get_mem3Ddouble(double ****array3D, int dim0, int dim1, int dim2)
 
   double **array2D;
 
-  if(((*array3D) = (double***)malloc(dim0 * sizeof(double**))) == NULL)
+  if(((*array3D) = (double***)mem_malloc(dim0 * sizeof(double**))) == NULL)
     no_mem_exit("get_mem3Ddouble: array3D");
 
   mem_size += get_mem2Ddouble(&array2D, dim0 * dim1, dim2);
@@ -2503,11 +2876,11 @@ void free_mem2Ddouble(double **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Ddouble: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
 
   }
   else
@@ -2528,7 +2901,7 @@ void free_mem1Dodouble(double *array1D, int offset)
   if (array1D)
   {
     array1D -= offset;
-    free (array1D);
+    mem_free (array1D);
   } 
   else
   {
@@ -2549,10 +2922,10 @@ void free_mem2Dodouble(double **array2D, int offset)
   {
     array2D[0] -= offset;
     if (array2D[0])
-      free (array2D[0]);
+      mem_free (array2D[0]);
     else error ("free_mem2Dodouble: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
 
   } else
   {
@@ -2577,17 +2950,17 @@ void free_mem3Dodouble(double ***array3D, int dim0, int dim1, int offset)
       for (j = -offset; j < dim1 - offset; j++)
       {
         if (array3D[i][j])
-          free(array3D[i][j]);
+          mem_free(array3D[i][j]);
         else
           error ("free_mem3Dodouble: trying to free unused memory",100);
       }
     }
     array3D[0] -= offset;
     if (array3D[0])
-      free(array3D[0]);
+      mem_free(array3D[0]);
     else
       error ("free_mem3Dodouble: trying to free unused memory",100);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -2612,17 +2985,17 @@ void free_mem3Doint(int ***array3D, int dim0, int dim1, int offset)
       for (j = -offset; j < dim1 - offset; j++)
       {
         if (array3D[i][j])
-          free(array3D[i][j]);
+          mem_free(array3D[i][j]);
         else
           error ("free_mem3Doint: trying to free unused memory",100);
       }
     }
     array3D[0] -= offset;
     if (array3D[0])
-      free(array3D[0]);
+      mem_free(array3D[0]);
     else
       error ("free_mem3Doint: trying to free unused memory",100);
-    free (array3D);
+    mem_free (array3D);
   }
   else
   {
@@ -2644,11 +3017,11 @@ void free_mem2Doint(int **array2D, int offset)
   {
     array2D[0] -= offset;
     if (array2D[0])
-      free (array2D[0]);
+      mem_free (array2D[0]);
     else 
       error ("free_mem2Doint: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
 
   } 
   else
@@ -2670,11 +3043,11 @@ void free_offset_mem2Dshort(short **array2D, int dim1, int offset_y, int offset_
   {
     array2D[0] -= offset_x + offset_y * dim1;
     if (array2D[0])
-      free (array2D[0]);
+      mem_free (array2D[0]);
     else 
       error ("free_offset_mem2Dshort: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
 
   } 
   else
@@ -2695,7 +3068,7 @@ void free_mem3Ddouble(double ***array3D)
   if (array3D)
   {
     free_mem2Ddouble(*array3D);
-    free (array3D);
+    mem_free (array3D);
   } 
   else
   {
@@ -2718,9 +3091,9 @@ int get_mem2Dolm(LambdaParams ***array2D, int dim0, int dim1, int offset)
 {
   int i;
 
-  if((*array2D      = (LambdaParams**) malloc(dim0 * sizeof(LambdaParams*))) == NULL)
+  if((*array2D      = (LambdaParams**) mem_malloc(dim0 * sizeof(LambdaParams*))) == NULL)
     no_mem_exit("get_mem2Dolm: array2D");
-  if(((*array2D)[0] = (LambdaParams* ) calloc(dim0 * dim1, sizeof(LambdaParams))) == NULL)
+  if(((*array2D)[0] = (LambdaParams* ) mem_calloc(dim0 * dim1, sizeof(LambdaParams))) == NULL)
     no_mem_exit("get_mem2Dolm: array2D");
 
   (*array2D)[0] += offset;
@@ -2745,11 +3118,11 @@ void free_mem2Dolm(LambdaParams **array2D, int offset)
   {
     array2D[0] -= offset;
     if (array2D[0])
-      free (array2D[0]);
+      mem_free (array2D[0]);
     else 
       error ("free_mem2Dolm: trying to free unused memory",100);
 
-    free (array2D);
+    mem_free (array2D);
 
   } 
   else
@@ -2763,10 +3136,10 @@ void free_mem2Ddistblk(distblk **array2D)
   if (array2D)
   {
     if (*array2D)
-      free (*array2D);
+      mem_free (*array2D);
     else 
       error ("free_mem2Ddistblk: trying to free unused memory",100);
-    free (array2D);
+    mem_free (array2D);
   } 
   else
   {
@@ -0,0 +1,214 @@
+
+/*!
+ *************************************************************************************
+ * \file cabac_bench.c
+ *
+ * \brief
+ *    Micro-benchmark of the CABAC bin encoder (biariencode.c)
+ *
+ *    A fixed pseudo random bin stream is encoded with biari_encode_symbol(),
+ *    biari_encode_symbol_eq_prob() and biari_encode_symbols_eq_prob(). For each
+ *    path the best time of several passes is reported in bins per second,
+ *    together with a checksum of the produced bytes, so that two trees can be
+ *    compared for speed and bit exactness.
+ *
+ *    Build with "make cabac_bench" in lencod (not part of the default target).
+ *    Usage: cabac_bench.exe [bins (default 4194304)] [passes (default 8)]
+ *    Define BENCH_NO_MULTI_BIN to build against trees that do not provide
+ *    biari_encode_symbols_eq_prob().
+ *************************************************************************************
+ */
+
+#include <time.h>
+
+#include "global.h"
+#include "biariencode.h"
+
+#define BENCH_CONTEXTS   64        //!< number of context models of the regular bins
+#define BENCH_GROUP      8         //!< bypass bins per biari_encode_symbols_eq_prob() call
+#define BENCH_BINS       (1 << 22)
+#define BENCH_PASSES     8
+
+typedef enum
+{
+  BENCH_REGULAR = 0,
+  BENCH_BYPASS,
+  BENCH_BYPASS_MULTI,
+  BENCH_MODES
+} BenchMode;
+
+static const char *bench_mode_names[BENCH_MODES] =
+{
+  "regular bins", "bypass, 1 per call", "bypass, 8 per call"
+};
+
+static VideoParameters bench_vid; //!< only provides the cabac_encoding flag of the bin counters
+static Macroblock bench_mb;        //!< only receives the stuffing bits of arienco_done_encoding()
+static unsigned int bench_seed = 12345;
+
+void error(char *text, int code)
+{
+  fprintf(stderr, "%s\n", text);
+  exit(code);
+}
+
+void no_mem_exit(char *where)
+{
+  snprintf(errortext, ET_SIZE, "Could not allocate memory: %s", where);
+  error(errortext, 100);
+}
+
+static unsigned int bench_rand(void)
+{
+  bench_seed = bench_seed * 1103515245u + 12345u;
+  return (bench_seed >> 8) & 0xFFFF;
+}
+
+static double bench_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bin stream: context k codes a 1 with probability (k + 1) / (N + 1),
+ *    bypass bins are uniform
+ ************************************************************************
+ */
+static void generate_bins(byte *bins, byte *ctx_idx, byte *eq_bins, unsigned int *eq_groups, int num_bins)
+{
+  int i, j;
+
+  for (i = 0; i < num_bins; ++i)
+  {
+    ctx_idx[i] = (byte) (bench_rand() % BENCH_CONTEXTS);
+    bins[i]    = (byte) ((bench_rand() % (BENCH_CONTEXTS + 1)) <= ctx_idx[i]);
+    eq_bins[i] = (byte) (bench_rand() & 1);
+  }
+
+  for (i = 0; i < num_bins / BENCH_GROUP; ++i)
+  {
+    eq_groups[i] = 0;
+    for (j = 0; j < BENCH_GROUP; ++j)
+      eq_groups[i] = (eq_groups[i] << 1) | eq_bins[i * BENCH_GROUP + j];
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Encodes the bin stream once with one of the coding paths
+ *
+ * \return
+ *    encoding time in seconds
+ ************************************************************************
+ */
+static double run_pass(BenchMode mode, const byte *bins, const byte *ctx_idx, const byte *eq_bins,
+                       const unsigned int *eq_groups, int num_bins, byte *code_buffer, int *code_len)
+{
+  EncodingEnvironment ee;
+  BiContextType ctx[BENCH_CONTEXTS];
+  double start;
+  int i;
+
+  memset(&ee, 0, sizeof(EncodingEnvironment));
+  ee.p_Vid = &bench_vid;
+  memset(ctx, 0, sizeof(ctx));
+  for (i = 0; i < BENCH_CONTEXTS; ++i)
+  {
+    ctx[i].state = (byte) (i * 62 / BENCH_CONTEXTS);
+    ctx[i].MPS   = (unsigned char) (i >= BENCH_CONTEXTS / 2);
+  }
+
+  *code_len = 0;
+  arienco_start_encoding(&ee, code_buffer, code_len);
+
+  start = bench_time();
+  switch (mode)
+  {
+  case BENCH_REGULAR:
+    for (i = 0; i < num_bins; ++i)
+      biari_encode_symbol(&ee, bins[i], &ctx[ctx_idx[i]]);
+    break;
+  case BENCH_BYPASS:
+    for (i = 0; i < num_bins; ++i)
+      biari_encode_symbol_eq_prob(&ee, eq_bins[i]);
+    break;
+  default:
+#ifndef BENCH_NO_MULTI_BIN
+    for (i = 0; i < num_bins / BENCH_GROUP; ++i)
+      biari_encode_symbols_eq_prob(&ee, eq_groups[i], BENCH_GROUP);
+#endif
+    break;
+  }
+  arienco_done_encoding(&bench_mb, &ee);
+
+  return bench_time() - start;
+}
+
+static unsigned int checksum(const byte *buf, int len)
+{
+  unsigned int hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < len; ++i)
+    hash = (hash ^ buf[i]) * 16777619u;
+  return hash;
+}
+
+int main(int argc, char **argv)
+{
+  int num_bins = (argc > 1) ? atoi(argv[1]) : BENCH_BINS;
+  int passes   = (argc > 2) ? atoi(argv[2]) : BENCH_PASSES;
+  byte *bins, *ctx_idx, *eq_bins, *code_buffer;
+  unsigned int *eq_groups;
+  unsigned int sums[BENCH_MODES];
+  int mode, pass, code_len = 0;
+
+  num_bins = imax(BENCH_GROUP, num_bins - num_bins % BENCH_GROUP);
+  passes   = imax(1, passes);
+
+  bins        = (byte *) malloc(num_bins);
+  ctx_idx     = (byte *) malloc(num_bins);
+  eq_bins     = (byte *) malloc(num_bins);
+  eq_groups   = (unsigned int *) malloc((num_bins / BENCH_GROUP) * sizeof(unsigned int));
+  code_buffer = (byte *) malloc(num_bins / 4 + 1024);   // bypass bins need 1 bit each, regular bins less
+  if (!bins || !ctx_idx || !eq_bins || !eq_groups || !code_buffer)
+    no_mem_exit("cabac_bench: buffers");
+
+  generate_bins(bins, ctx_idx, eq_bins, eq_groups, num_bins);
+
+  printf("CABAC bin encoding, %d bins, best of %d passes\n", num_bins, passes);
+  for (mode = 0; mode < BENCH_MODES; ++mode)
+  {
+    double best = 1e30;
+
+#ifdef BENCH_NO_MULTI_BIN
+    if (mode == BENCH_BYPASS_MULTI)
+      continue;
+#endif
+    for (pass = 0; pass < passes; ++pass)
+    {
+      double t = run_pass((BenchMode) mode, bins, ctx_idx, eq_bins, eq_groups, num_bins, code_buffer, &code_len);
+      best = dmin(best, t);
+    }
+    sums[mode] = checksum(code_buffer, code_len);
+    printf(" %-20s : %8.1f Mbins/s  (%d bytes, checksum %08x)\n",
+      bench_mode_names[mode], num_bins / best * 1e-6, code_len, sums[mode]);
+  }
+
+#ifndef BENCH_NO_MULTI_BIN
+  if (sums[BENCH_BYPASS] != sums[BENCH_BYPASS_MULTI])
+    printf(" multi-bin bypass output differs from single-bin bypass\n");
+#endif
+
+  free(bins);
+  free(ctx_idx);
+  free(eq_bins);
+  free(eq_groups);
+  free(code_buffer);
+  return 0;
+}
@@ -41,6 +41,9 @@
 #define QUARTER        0x0100      //(1 << (B_BITS-2))
 #define MIN_BITS_TO_GO 0
 #define B_LOAD_MASK    0xFFFF      // ((1<<BITS_TO_LOAD) - 1)
+#define EST_FRAC_BITS  15          // fractional precision of the table based rate estimation
+
+extern const int entropyBits[128];
 
 extern int get_pic_bin_count(VideoParameters *p_Vid);
 extern void reset_pic_bin_count(VideoParameters *p_Vid);
@@ -52,6 +55,7 @@ extern void arienco_done_encoding (Macroblock *currMB, EncodingEnvironmentPtr ee
 extern void biari_init_context    (int qp, BiContextTypePtr ctx, const char* ini);
 extern void biari_encode_symbol   (EncodingEnvironmentPtr eep, int symbol, BiContextTypePtr bi_ct );
 extern void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol);
+extern void biari_encode_symbols_eq_prob(EncodingEnvironmentPtr eep, unsigned int symbols, int len);
 extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol);
 
 /*!
@@ -62,7 +66,13 @@ extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol);
 */
 static inline int arienco_bits_written(EncodingEnvironmentPtr eep)
 {
-  return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go;
+  int bits = (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go;
+
+  // while estimating, the coder is frozen and the estimated bits are added on top
+  if (eep->Erate_est == RATE_EST_ONLY)
+    bits += (int) ((eep->Efrac_bits + (1 << (EST_FRAC_BITS - 1))) >> EST_FRAC_BITS);
+
+  return bits;
 }
 
 #endif  // BIARIENCOD_H
@@ -147,6 +147,7 @@ Mapping Map[] = {
     {"BiPredMERefinements",      &cfgparams.BiPredMERefinements,          0,   0.0,                       1,  0.0,              5.0,                             },
     {"BiPredMESearchRange",      &cfgparams.BiPredMESearchRange,          0,   8.0,                       2,  0.0,              0.0,                             },
     {"BiPredMESubPel",           &cfgparams.BiPredMESubPel,               0,   1.0,                       1,  0.0,              2.0,                             },
+    {"BiPredMEConvergence",      &cfgparams.BiPredMEConvergence,          0,   0.0,                       1,  0.0,            100.0,                             },
 
     {"DisableIntraInInter",      &cfgparams.DisableIntraInInter,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"IntraDisableInterOnly",    &cfgparams.IntraDisableInterOnly,        0,   0.0,                       1,  0.0,              1.0,                             },
@@ -163,6 +164,12 @@ Mapping Map[] = {
 
     {"DistortionEstimation",     &cfgparams.de,                           0,   1.0,                       2,  0.0,              8.0,                             },
     {"SubMBCodingState",         &cfgparams.subMBCodingState,             0,   2.0,                       1,  0.0,              2.0,                             },
+    {"RateEstimation",           &cfgparams.RateEstimation,               0,   0.0,                       1,  0.0,              2.0,                             },
+    {"FastIntraRDO",             &cfgparams.FastIntraRDO,                 0,   0.0,                       1,  0.0,              1.0,                             },
+    {"FastIntraTopK",            &cfgparams.FastIntraTopK,                0,   3.0,                       1,  1.0,              9.0,                             },
+    {"FastIntraTopKLowQP",       &cfgparams.FastIntraTopKLowQP,           0,   4.0,                       1,  1.0,              9.0,                             },
+    {"FastIntraQPThreshold",     &cfgparams.FastIntraQPThreshold,         0,  22.0,                       1,  0.0,             51.0,                             },
+    {"IntraRDOThreads",          &cfgparams.IntraRDOThreads,              0,   0.0,                       2,  0.0,              0.0,                             },
     {"I16RDOpt",                 &cfgparams.I16rdo,                       0,   0.0,                       1,  0.0,              1.0,                             },
     {"DistortionSSIM",           &cfgparams.Distortion[SSIM],             0,   0.0,                       1,  0.0,              1.0,                             },
     {"DistortionMS_SSIM",        &cfgparams.Distortion[MS_SSIM],          0,   0.0,                       1,  0.0,              1.0,                             },
@@ -275,11 +282,15 @@ Mapping Map[] = {
 
     {"ReportFrameStats",         &cfgparams.ReportFrameStats,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"DisplayEncParams",         &cfgparams.DisplayEncParams,             0,   0.0,                       1,  0.0,              1.0,                             },
+    {"MemoryReport",             &cfgparams.MemoryReport,                 0,   0.0,                       1,  0.0,              2.0,                             },
+    {"MemoryPolicy",             &cfgparams.MemoryPolicy,                 0,   0.0,                       1,  0.0,              3.0,                             },
+    {"MemoryFirstTouch",         &cfgparams.MemoryFirstTouch,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"Verbose",                  &cfgparams.Verbose,                      0,   1.0,                       1,  0.0,              4.0,                             },
     {"SkipGlobalStats",          &cfgparams.skip_gl_stats,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMCBuffer",           &cfgparams.ChromaMCBuffer,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMEEnable",           &cfgparams.ChromaMEEnable,               0,   0.0,                       1,  0.0,              2.0,                             },
     {"ChromaMEWeight",           &cfgparams.ChromaMEWeight,               0,   1.0,                       2,  1.0,              0.0,                             },
+    {"InterpolationMode",        &cfgparams.InterpolationMode,            0,   0.0,                       1,  0.0,              2.0,                             },
     {"MEDistortionFPel",         &cfgparams.MEErrorMetric[F_PEL],         0,   0.0,                       1,  0.0,              3.0,                             },
     {"MEDistortionHPel",         &cfgparams.MEErrorMetric[H_PEL],         0,   0.0,                       1,  0.0,              3.0,                             },
     {"MEDistortionQPel",         &cfgparams.MEErrorMetric[Q_PEL],         0,   2.0,                       1,  0.0,              3.0,                             },
@@ -398,6 +409,18 @@ Mapping Map[] = {
     // Fast Mode Decision
     {"EarlySkipEnable",          &cfgparams.EarlySkipEnable,              0,   0.0,                       1,  0.0,              1.0,                             },
     {"SelectiveIntraEnable",     &cfgparams.SelectiveIntraEnable,         0,   0.0,                       1,  0.0,              1.0,                             },
+    {"EarlySkipDetection",       &cfgparams.EarlySkipDetection,           0,   0.0,                       1,  0.0,              1.0,                             },
+    {"AdaptiveModePruning",      &cfgparams.AdaptiveModePruning,          0,   0.0,                       1,  0.0,              1.0,                             },
+    {"AMPThreshold",             &cfgparams.AMPThreshold,                 2,   2.0,                       1,  0.0,            100.0,                             },
+    {"AMPRefreshPeriod",         &cfgparams.AMPRefreshPeriod,             0,   8.0,                       2,  1.0,              0.0,                             },
+    {"FastP8x8Decision",         &cfgparams.FastP8x8Decision,             0,   0.0,                       1,  0.0,              1.0,                             },
+    {"FullSearchSEA",            &cfgparams.FullSearchSEA,                0,   1.0,                       1,  0.0,              1.0,                             },
+    {"FastFullSearchThreads",    &cfgparams.FastFullSearchThreads,        0,   1.0,                       2,  1.0,              0.0,                             },
+    {"FastRefSearch",            &cfgparams.FastRefSearch,                0,   0.0,                       1,  0.0,              1.0,                             },
+    {"PyramidME",                &cfgparams.PyramidME,                    0,   0.0,                       1,  0.0,              1.0,                             },
+    {"PyramidSearchRange",       &cfgparams.PyramidSearchRange,           0,   8.0,                       1,  1.0,             64.0,                             },
+    {"HashME",                   &cfgparams.HashME,                       0,   0.0,                       1,  0.0,              1.0,                             },
+    {"AdaptiveSearchRange",      &cfgparams.AdaptiveSearchRange,          0,   0.0,                       1,  0.0,              1.0,                             },
 
     //================================
     // Motion Estimation (ME) Parameters
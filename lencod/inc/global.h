@@ -82,6 +82,14 @@ typedef struct bit_counter
   int mb_stuffing;
 } BitCounter;
 
+//! CABAC rate estimation state of an encoding environment
+typedef enum
+{
+  RATE_EST_OFF   = 0,  //!< arithmetic coding only
+  RATE_EST_ONLY  = 1,  //!< table based bit estimation, the coder and bitstream are not touched
+  RATE_EST_TRACK = 2   //!< arithmetic coding, estimated bits are accumulated for comparison
+} RateEstMode;
+
 //! struct to characterize the state of the arithmetic coding engine
 typedef struct
 {
@@ -95,6 +103,9 @@ typedef struct
   int           *Ecodestrm_len;
   int           C;
   int           E;
+  int           Erate_est;    //!< RateEstMode
+  int64         Efrac_bits;   //!< estimated bits in 1/(1 << EST_FRAC_BITS) units
+  struct ctx_journal *Ejournal; //!< logs context changes during RD mode decision (NULL: off)
 } EncodingEnvironment;
 
 typedef EncodingEnvironment *EncodingEnvironmentPtr;
@@ -271,6 +282,8 @@ typedef struct me_block
   MotionVector     mv[2];            //!< motion vectors (L0/L1)
   PixelPos         block[4];
   struct slice    *p_Slice;
+  struct umhex_context     *p_UMHexCtx;    //!< UMHex search state used for this block
+  struct umhex_smp_context *p_UMHexSMPCtx; //!< simplified UMHex search state used for this block
   struct search_window searchRange;
   int              cost;           //!< Rate Distortion cost
   imgpel         **orig_pic;      //!< Block Data
@@ -297,6 +310,13 @@ typedef struct me_block
   int              search_pos2;   // <--  search positions for    half-pel search  (default: 9)
   int              search_pos4;   // <--  search positions for quarter-pel search  (default: 9)
   int              iteration_no;  // <--  bi pred iteration number
+  // fixed prediction of bi pred ME
+  int            **bipred_target;   //!< 2 * orig - fixed prediction (weighted: weighted fixed prediction + rounding)
+  struct storable_picture *bipred_ref; //!< reference of the fixed prediction, NULL if none is materialized
+  MotionVector     bipred_mv;       //!< padded vector of the fixed prediction
+  short            bipred_pos;      //!< argument (1 or 2) of the computeBiPred functions holding the fixed prediction
+  short            bipred_weight;   //!< weight of the searched prediction
+  short            bipred_weight_cr[2];
 
   // functions
   distblk (*computePredFPel)    (struct storable_picture *, struct me_block *, distblk , MotionVector * );
@@ -673,6 +693,8 @@ typedef struct slice
 
   struct rdo_structure    *p_RDO;
   struct epzs_params      *p_EPZS;  
+  struct umhex_context    *p_UMHexCtx;     //!< UMHex search state of this slice
+  struct umhex_smp_context *p_UMHexSMPCtx; //!< simplified UMHex search state of this slice
 
   // This should be the right location for this
   struct storable_picture **listX[6];
@@ -934,6 +956,40 @@ typedef struct video_par
   int64  me_tot_time;
   int64  tot_time;
   int64  me_time;
+  int64  interp_tot_time;         //!< time spent for sub-pel reference interpolation
+  int64  subpel_mem_peak;         //!< peak memory held by sub-pel reference data
+  int64  rate_est_mbs;            //!< macroblocks checked against the CABAC rate estimation
+  double rate_est_bits;           //!< estimated bits of the checked macroblocks
+  double rate_real_bits;          //!< coded bits of the checked macroblocks
+  double rate_est_abs_err;        //!< sum of absolute estimation errors
+  int64  fast_intra_rank[2][NO_INTRA_PMODE]; //!< preselection rank of the RDO selected intra 4x4/8x8 modes
+  int64  early_skip_checked;      //!< macroblocks checked by the early SKIP/DIRECT detection
+  int64  early_skip_mbs;          //!< macroblocks decided by the early SKIP/DIRECT detection
+  int64  sea_candidates;          //!< full search candidates checked against the successive elimination bound
+  int64  sea_eliminated;          //!< full search candidates dropped by the successive elimination bound
+  int64  me_ref_time[MAX_REFERENCE_PICTURES];     //!< motion search time spent per reference index
+  int64  me_ref_searched[MAX_REFERENCE_PICTURES]; //!< block searches per reference index
+  int64  me_ref_skipped[MAX_REFERENCE_PICTURES];  //!< block searches skipped by the fast reference search
+  int64  pyramid_checked;         //!< block searches that evaluated the pyramid coarse vector
+  int64  pyramid_moved;           //!< block searches centred on the pyramid coarse vector
+  int64  hash_me_checked;         //!< block searches that looked up the hash table
+  int64  hash_me_found;           //!< block searches with an exact match in the hash table
+  int64  hash_me_used;            //!< block searches that took the exact match
+  int64  epzs_evaluated;          //!< EPZS integer pel positions costed
+  int64  epzs_pred_revisits;      //!< EPZS predictors skipped as already visited by the block search
+  int64  epzs_pattern_revisits;   //!< EPZS pattern points skipped as already visited by the block search
+  int64  bipred_me_searches;      //!< bi-predictive block searches
+  int64  bipred_me_converged;     //!< bi-predictive block searches stopped by BiPredMEConvergence
+  int64  asr_searches;            //!< block searches with an adaptive search range
+  int64  asr_range_sum;           //!< sum of their effective search ranges (integer pels)
+  int64  asr_max_range_sum;       //!< sum of their search ranges before the adaptation (integer pels)
+  int64  asr_frame_searches;      //!< asr_searches of the current frame
+  int64  asr_frame_range_sum;     //!< asr_range_sum of the current frame
+  int64  asr_frame_max_range_sum; //!< asr_max_range_sum of the current frame
+
+  struct subpel_cache *p_sub_cache; //!< block cache for on-demand interpolation
+  struct mode_pruning *p_mode_prune; //!< statistics of the adaptive mode pruning
+  struct me_pyramid   *p_pyramid;    //!< coarse motion field of the pyramid motion estimation
 
   byte mixedModeEdgeFlag;
 
@@ -960,6 +1016,7 @@ typedef struct video_par
   struct epzs_struct *ldiamond;
   struct epzs_struct *sbdiamond;
   struct epzs_struct *pmvfast;
+  struct epzs_coloc_params *p_epzs_coloc;  //!< co-located vectors shared by the EPZS slices of a picture
 
 
   // RDOQ
@@ -18,6 +18,49 @@
 #ifndef _IMG_LUMA_H_
 #define _IMG_LUMA_H_
 
+#define SUBPEL_CACHE_SIZE   16                   //!< number of blocks kept by the on-demand interpolation cache
+#define SUBPEL_BLOCK_SIZE   (2 * MB_BLOCK_SIZE)  //!< height/width of an interpolated cache block
+#define SUBPEL_BLOCK_MARGIN (SUBPEL_BLOCK_SIZE - MB_BLOCK_SIZE) //!< max. offset of a hit inside a cached block
+#define SUBPEL_TILE_SHIFT   6                    //!< log2 of the tile size used for lazy plane generation
+#define SUBPEL_TILE_SIZE    (1 << SUBPEL_TILE_SHIFT)
+
+//! sub-pel reference generation modes (InterpolationMode)
+typedef enum
+{
+  INTERP_FULL_PLANES = 0,   //!< all 16 quarter-pel planes are built when a reference is stored
+  INTERP_BLOCK_CACHE = 1,   //!< blocks are interpolated into a small cache when accessed
+  INTERP_LAZY_TILES  = 2    //!< planes are allocated but built tile by tile on first access
+} InterpolationModes;
+
+//! one interpolated block of a single quarter-pel phase
+typedef struct subpel_block
+{
+  StorablePicture *ref;       //!< reference picture the block was interpolated from (NULL if empty)
+  int     pos_y, pos_x;       //!< integer position of the top-left sample
+  int     frac_y, frac_x;     //!< quarter-pel phase
+  int     last_use;           //!< LRU stamp
+  imgpel *data;               //!< samples, stored with the stride of the padded reference
+} SubPelBlock;
+
+//! block cache for on-demand interpolation (InterpolationMode = 1); also
+//! provides the interpolation workspace for lazy tiles (InterpolationMode = 2)
+typedef struct subpel_cache
+{
+  VideoParameters *p_Vid;
+  int     mode;               //!< InterpolationModes
+  SubPelBlock blk[SUBPEL_CACHE_SIZE];
+  int     stride;             //!< row stride of the cached blocks (padded luma width)
+  int     use_counter;
+  int     mem_size;           //!< memory allocated for the cache in bytes
+  int64   hits;               //!< lookups served from the cache
+  int64   misses;             //!< lookups that required an interpolation
+  int64   tiles_done;         //!< tiles interpolated in lazy tile mode
+  int64   tiles_total;        //!< sub-pel tiles of all interpolated references
+  imgpel  plane[4][SUBPEL_BLOCK_SIZE + 1][SUBPEL_BLOCK_SIZE + 1]; //!< full, half-hor, half-ver, center samples
+  int     tmp[SUBPEL_BLOCK_SIZE + 6][SUBPEL_BLOCK_SIZE + 1];       //!< unclipped horizontal six-tap results
+  imgpel  win[SUBPEL_BLOCK_SIZE + 6][SUBPEL_BLOCK_SIZE + 6];       //!< integer samples covered by the filter support
+} SubPelCache;
+
 extern void getSubImagesLuma       ( VideoParameters *p_Vid, StorablePicture *s );
 extern void getSubImageInteger     ( StorablePicture *s, imgpel **dstImg, imgpel **srcImg);
 extern void getSubImageInteger_s   ( StorablePicture *s, imgpel **dstImg, imgpel **srcImg);
@@ -28,4 +71,11 @@ extern void getSubImageBiLinear    ( StorablePicture *s, imgpel **dstImg, imgpel
 extern void getHorSubImageBiLinear ( StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR);
 extern void getVerSubImageBiLinear ( StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB);
 extern void getDiagSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB);
+
+extern int     init_subpel_cache   ( VideoParameters *p_Vid );
+extern void    free_subpel_cache   ( VideoParameters *p_Vid );
+extern void    reset_subpel_cache  ( SubPelCache *cache );
+extern int     alloc_subpel_tile_map( StorablePicture *s );
+extern void    reset_subpel_tile_map( SubPelCache *cache, StorablePicture *s );
+extern imgpel *getSubPelLineLuma   ( StorablePicture *ref, int pos_y, int pos_x, int frac_y, int frac_x );
 #endif // _IMG_LUMA_H_
@@ -87,14 +87,23 @@ typedef struct storable_picture
   imgpel **** p_img_sub[MAX_PLANE];      //!< pointer array for storing top address of imgY_sub/imgUV_sub[]
   imgpel **   p_curr_img;                //!< current int-pel ref. picture area to be used for motion estimation
   imgpel **** p_curr_img_sub;            //!< current sub-pel ref. picture area to be used for motion estimation
+  struct subpel_cache *p_sub_cache;      //!< block cache used instead of p_curr_img_sub for on-demand interpolation
+  int64       subpel_mem_size;           //!< memory currently held by the sub-pel planes of this picture
+  byte *      subpel_tile_map;           //!< [phase][tile_y][tile_x] flags of tiles already interpolated (lazy tiles)
+  int         tile_cols, tile_rows;      //!< tile grid covering the padded luma plane
+  int ***     sea_sum;                   //!< [4x4, 8x8, 16x16][y][x] block sums of the padded int-pel plane (full search SEA)
+  imgpel **   sea_plane;                 //!< int-pel plane the block sums were computed from
   //hme;
   imgpel ***  p_hme_int_img;     //!< [level][y][x];
   imgpel *****  p_hme_sub_img;   //!< [level][y_frac][x_frac][y][x];
+  imgpel **   hme_plane;         //!< int-pel plane the pyramid levels were computed from
+  struct hash_me_table *p_hash_table; //!< hashes of all 8x8 source blocks for the hash motion search
 
   Dist_Estm * de_mem; 
 
   PicMotionParams **mv_info;                 //!< Motion info
   PicMotionParams **JVmv_info[MAX_PLANE];    //!< Motion info for 4:4:4 independent coding
+  byte **moving_block;                       //!< co-located "moving" flag per 4x4 block for direct mode, built on first use
   PicMotionParamsOld  motion;    //!< Motion info
   PicMotionParamsOld JVmotion[MAX_PLANE];    //!< Motion info for 4:4:4 independent coding
 
@@ -215,6 +224,7 @@ extern void             free_frame_store          (VideoParameters *p_Vid, Frame
 extern StorablePicture* alloc_storable_picture    (VideoParameters *p_Vid, PictureStructure type, int size_x, int size_y, int size_x_cr, int size_y_cr);
 extern void             free_storable_picture     (VideoParameters *p_Vid, StorablePicture* p);
 extern void             store_picture_in_dpb      (DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
+extern void             update_subpel_mem_peak    (DecodedPictureBuffer *p_Dpb);
 extern void             replace_top_pic_with_frame(DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
 extern void             flush_dpb                 (DecodedPictureBuffer *p_Dpb, FrameFormat *output);
 extern void             dpb_split_field           (VideoParameters *p_Vid, FrameStore *fs);
@@ -29,5 +29,8 @@ extern void copy_image_data_8x8   (imgpel  **imgBuf1, imgpel  **imgBuf2, int off
 extern void copy_image_data_4x4   (imgpel  **imgBuf1, imgpel  **imgBuf2, int off1, int off2);
 extern void ResetRD8x8Data     (VideoParameters *p_Vid, RD_8x8DATA *rd_data);
 extern void set_chroma_pred_mode  (Macroblock *currMB, RD_PARAMS enc_mb, int *mb_available, char chroma_pred_mode_range[2]);
+extern int  early_skip_detection  (Macroblock *currMB, RD_PARAMS *enc_mb);
+extern void fast_p8x8_partition_check(Macroblock *currMB, RD_PARAMS *enc_mb, distblk *mode_cost);
+extern int  terminate_p8x8_search (Macroblock *currMB, RD_8x8DATA *dataTr, distblk min_cost);
 #endif
 
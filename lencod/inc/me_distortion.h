@@ -79,6 +79,8 @@ extern distblk computeBiPred8x16SATD1 (StorablePicture *ref1, StorablePicture *r
 extern distblk computeBiPredSSE1    (StorablePicture *ref1, StorablePicture *ref2, MEBlock*, distblk, MotionVector *, MotionVector *);
 extern distblk computeBiPredSSE2    (StorablePicture *ref1, StorablePicture *ref2, MEBlock*, distblk, MotionVector *, MotionVector *);
 
+extern void set_bipred_target   (MEBlock *mv_block, StorablePicture *ref, MotionVector *mv, int pos);
+
 extern void select_distortion   (VideoParameters *p_Vid, InputParameters *p_Inp);
 
 #endif
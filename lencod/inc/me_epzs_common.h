@@ -21,10 +21,25 @@
 
 
 // Structure definitions
+//! slice parameters the co-located vectors depend on
 typedef struct
+{
+  StorablePicture *pic;                                   //!< picture being coded
+  int              frame_no;
+  int              poc, top_poc, bottom_poc;
+  int              structure;
+  int              mb_aff_frame_flag;
+  int              list;                                  //!< list of the co-located picture
+  int              num_ref_idx_active;                    //!< active LIST_0 references
+  int              list_size[6];
+  StorablePicture *ref[6][MAX_LIST_SIZE];
+} EPZSColocKey;
+
+typedef struct epzs_coloc_params
 {
   int         mb_adaptive_frame_field_flag;
   int         size_x, size_y;
+  EPZSColocKey key;       //!< slice the vectors below were computed for
 
   // Frame
   MotionVector ***frame;  //!< motion vector       [list][subblock_x][subblock_y]
@@ -111,7 +126,8 @@ extern void  EPZSStructDelete          (Slice *currSlice);
 extern void  EPZSSliceInit             (Slice *currSlice);
 extern int   EPZSInit                  (VideoParameters *p_Vid);
 extern int   EPZSStructInit            (Slice *currSlice);
-extern void  EPZSOutputStats           (InputParameters *p_Inp, FILE * stat, short stats_file);
+extern void  EPZSOutputStats           (VideoParameters *p_Vid, InputParameters *p_Inp, FILE * stat, short stats_file);
+extern void  EPZSOutputSearchStats     (VideoParameters *p_Vid, FILE * stat, short stats_file);
 
 /*!
 ***********************************************************************
@@ -0,0 +1,34 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    me_hash.h
+ *
+ * \brief
+ *    Headerfile for the hash based exact match motion search
+ **************************************************************************
+ */
+
+#ifndef _ME_HASH_H_
+#define _ME_HASH_H_
+
+#define HASH_ME_BLOCK       8          //!< size of the hashed blocks
+#define HASH_ME_BUCKETS     (1 << 16)  //!< number of hash table buckets
+#define HASH_ME_MAX_CHAIN   64         //!< maximum number of equal hashes checked per search
+#define HASH_ME_BAND_SHIFT  6          //!< positions are bucketed per band of 64 lines
+
+//! hashes of all 8x8 blocks of a reference picture
+typedef struct hash_me_table
+{
+  int   **hash;        //!< [y][x] hash of the 8x8 block at (x, y)
+  int   **next;        //!< [y][x] next position (y * width + x) of the same bucket, -1 ends the chain
+  int    *head;        //!< [bucket] last inserted position of the bucket, -1 if empty
+  int     width;       //!< number of block positions per line
+  int     height;      //!< number of block positions per column
+  int     bands;       //!< number of bands of block positions
+} HashMETable;
+
+extern void     get_hash_table   (VideoParameters *p_Vid, StorablePicture *s);
+extern void     free_hash_table  (StorablePicture *s);
+extern distblk  hash_me_search   (Macroblock *currMB, MEBlock *mv_block, MotionVector *pred, distblk min_mcost, int lambda_factor);
+
+#endif
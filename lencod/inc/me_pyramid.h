@@ -0,0 +1,35 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    me_pyramid.h
+ *
+ * \brief
+ *    Headerfile for the hierarchical (pyramid) motion estimation pre-pass
+ **************************************************************************
+ */
+
+#ifndef _ME_PYRAMID_H_
+#define _ME_PYRAMID_H_
+
+#define PYR_LEVELS         2   //!< 1/2 and 1/4 scaled levels (1/4 and 1/16 of the picture area)
+#define PYR_REFINE_RANGE   2   //!< search range of the refinement at the 1/2 scaled level
+
+//! coarse motion field of the current picture
+typedef struct me_pyramid
+{
+  imgpel      **cur[PYR_LEVELS];                        //!< scaled original of the current picture
+  int           size_x[PYR_LEVELS];                     //!< width of the scaled levels
+  int           size_y[PYR_LEVELS];                     //!< height of the scaled levels
+  int           search_range;                           //!< search range at the 1/4 scaled level
+  int           slice_id;                               //!< incremented per slice, invalidates the vectors below
+  MotionVector *mv   [6][MAX_REFERENCE_PICTURES];       //!< coarse vector per macroblock in quarter pel units
+  int          *mv_id[6][MAX_REFERENCE_PICTURES];       //!< slice_id the vector was estimated for
+} MEPyramid;
+
+extern int  init_me_pyramid      (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void free_me_pyramid      (VideoParameters *p_Vid);
+extern void get_pyramid_planes   (StorablePicture *s);
+extern void pyramid_slice_init   (VideoParameters *p_Vid);
+extern void set_pyramid_center   (Macroblock *currMB, MEBlock *mv_block, MotionVector *pred, int lambda_factor);
+
+#endif
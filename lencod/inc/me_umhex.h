@@ -25,12 +25,25 @@
 
 #include "mbuffer.h"
 
+//! tables and SAD histories of the picture, shared by all searches
 struct umhex_struct {
   float AlphaFourth_1[8];
   float AlphaFourth_2[8];
+  int BlockType_LUT[4][4];
+  distblk ***fastme_l0_cost;                      //!< store SAD information needed for forward median and uplayer prediction
+  distblk ***fastme_l1_cost;                      //!< store SAD information needed for backward median and uplayer prediction
+  distblk **fastme_best_cost;                     //!< for multi ref early termination threshold
+  distblk ***fastme_l0_cost_bipred;               //!< store SAD information for bipred mode
+  distblk ***fastme_l1_cost_bipred;               //!< store SAD information for bipred mode
+  byte *flag_intra;
+};
+
+typedef struct umhex_struct UMHexStruct;
+
+//! search state of one slice; slices may search in parallel, the references of a macroblock may not
+struct umhex_context {
   // for bipred mode
   int pred_MV_ref_flag;
-  int BlockType_LUT[4][4];
   distblk Median_Pred_Thd_MB[8];
   distblk Big_Hexagon_Thd_MB[8];
   distblk Multi_Ref_Thd_MB[8];
@@ -38,44 +51,37 @@ struct umhex_struct {
   byte **McostState;                          //!< state for integer pel search
   byte **SearchState;                         //!< state for fractional pel search
   distblk ****fastme_ref_cost;                    //!< store SAD information needed for forward ref-frame prediction
-  distblk ***fastme_l0_cost;                      //!< store SAD information needed for forward median and uplayer prediction
-  distblk ***fastme_l1_cost;                      //!< store SAD information needed for backward median and uplayer prediction
-  distblk **fastme_best_cost;                     //!< for multi ref early termination threshold
-  distblk ***fastme_l0_cost_bipred;               //!< store SAD information for bipred mode
-  distblk ***fastme_l1_cost_bipred;               //!< store SAD information for bipred mode
   distblk pred_SAD;                               //!<  SAD prediction in use.
   distblk SAD_a,SAD_b,SAD_c,SAD_d;
   int bipred_flag;                            //!< flag for bipred
   int pred_MV_ref[2], pred_MV_uplayer[2];     //!< pred motion vector by space or temporal correlation,Median is provided
 
   int UMHEX_blocktype;                        //!< blocktype for UMHEX SetMotionVectorPredictor
-  int predict_point[5][2];
   //for early termination
   float  Bsize[8];
 
-  byte *flag_intra;
   int  flag_intra_SAD;
 };
 
-typedef struct umhex_struct UMHexStruct;
+typedef struct umhex_context UMHexContext;
 
 #define EARLY_TERMINATION                                                             \
-  if ((min_mcost - p_UMHex->pred_SAD)<p_UMHex->pred_SAD * betaFourth_2)                                     \
+  if ((min_mcost - p_UMHexCtx->pred_SAD)<p_UMHexCtx->pred_SAD * betaFourth_2)                               \
   goto fourth_2_step;                                                                 \
-  else if((min_mcost - p_UMHex->pred_SAD) < p_UMHex->pred_SAD * betaFourth_1)                                 \
+  else if((min_mcost - p_UMHexCtx->pred_SAD) < p_UMHexCtx->pred_SAD * betaFourth_1)                           \
   goto fourth_1_step;
 
 #define SEARCH_ONE_PIXEL                                                              \
   if((iabs(cand.mv_x - center.mv_x)>>2) < search_range && (iabs(cand.mv_y - center.mv_y)>>2)< search_range)\
   {                                                                                   \
-    if(!p_UMHex->McostState[((cand.mv_y - center.mv_y) >> 2)+ search_range][((cand.mv_x-center.mv_x)>>2)+search_range])       \
+    if(!p_UMHexCtx->McostState[((cand.mv_y - center.mv_y) >> 2)+ search_range][((cand.mv_x-center.mv_x)>>2)+search_range])    \
     {                                                                                 \
       mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);                           \
       if(mcost<min_mcost)                                                             \
       {                                                                               \
         mcost += mv_block->computePredFPel(ref_picture, mv_block,                     \
         min_mcost - mcost, &cand);                                     \
-        p_UMHex->McostState[((cand.mv_y - center.mv_y) >> 2) + search_range][((cand.mv_x - center.mv_x) >> 2) + search_range] = 1;   \
+        p_UMHexCtx->McostState[((cand.mv_y - center.mv_y) >> 2) + search_range][((cand.mv_x - center.mv_x) >> 2) + search_range] = 1;\
         if (mcost < min_mcost)                                                        \
         {                                                                             \
           best = cand;                                                                \
@@ -88,7 +94,7 @@ typedef struct umhex_struct UMHexStruct;
 #define SEARCH_ONE_PIXEL_BIPRED                                                                         \
 if((iabs(cand.mv_x - center2.mv_x) >> 2) < search_range && (iabs(cand.mv_y - center2.mv_y) >> 2) < search_range)     \
 {                                                                                                       \
-  if(!p_UMHex->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x-center2.mv_x) >> 2)+search_range])         \
+  if(!p_UMHexCtx->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x-center2.mv_x) >> 2)+search_range])      \
   {                                                                                                     \
     mcost  = mv_cost (p_Vid, lambda_factor, &center1, &pred1);                                          \
     mcost += mv_cost (p_Vid, lambda_factor, &cand, &pred2);                                             \
@@ -96,7 +102,7 @@ if((iabs(cand.mv_x - center2.mv_x) >> 2) < search_range && (iabs(cand.mv_y - cen
     {                                                                                                     \
       mcost  += mv_block->computeBiPredFPel(ref_picture1, ref_picture2,                                 \
       mv_block, min_mcost - mcost, &center1, &cand);                                                \
-      p_UMHex->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x - center2.mv_x) >> 2) + search_range] = 1; \
+      p_UMHexCtx->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x - center2.mv_x) >> 2) + search_range] = 1;\
       if (mcost < min_mcost)                                                                            \
       {                                                                                                 \
         best = cand;                                                                                    \
@@ -108,13 +114,15 @@ if((iabs(cand.mv_x - center2.mv_x) >> 2) < search_range && (iabs(cand.mv_y - cen
 
 
 extern void UMHEX_DefineThreshold  (VideoParameters *p_Vid);
-extern void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp, UMHexContext *p_UMHexCtx);
 extern int  UMHEX_get_mem          (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void UMHEX_free_mem         (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int  UMHEX_get_context_mem  (Slice *currSlice);
+extern void UMHEX_free_context_mem (Slice *currSlice);
 
-extern void UMHEX_decide_intrabk_SAD(Macroblock *currMB);
-extern void UMHEX_skip_intrabk_SAD  (Macroblock *currMB, int ref_max);
-extern void UMHEX_setup             (Macroblock *currMB, short ref, int list, int block_y, int block_x, int blocktype, MotionVector  *****all_mv);
+extern void UMHEX_decide_intrabk_SAD(Macroblock *currMB, UMHexContext *p_UMHexCtx);
+extern void UMHEX_skip_intrabk_SAD  (Macroblock *currMB, UMHexContext *p_UMHexCtx, int ref_max);
+extern void UMHEX_setup             (Macroblock *currMB, UMHexContext *p_UMHexCtx, short ref, int list, int block_y, int block_x, int blocktype, MotionVector  *****all_mv);
 
 extern distblk                                     //  ==> minimum motion cost after search
 UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macroblock
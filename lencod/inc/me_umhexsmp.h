@@ -28,31 +28,40 @@
 
 #include "mbuffer.h"
 
+// thresholds and SAD histories of the picture, shared by all searches
 struct umhex_smp_struct {
   distblk  SymmetricalCrossSearchThreshold1;
   distblk  SymmetricalCrossSearchThreshold2;
   distblk  ConvergeThreshold;
   distblk  SubPelThreshold1;
   distblk  SubPelThreshold3;
-  byte  **SearchState;          //state for fractional pel search
   distblk  ***l0_cost;       //store SAD information needed for forward median and uplayer prediction
   distblk  ***l1_cost;       //store SAD information needed for backward median and uplayer prediction
-  distblk   pred_SAD_uplayer;     // Up layer SAD prediction
   byte   *flag_intra;
+};
+
+typedef struct umhex_smp_struct UMHexSMPStruct;
+
+// search state of one slice; slices may search in parallel, the references of a macroblock may not
+struct umhex_smp_context {
+  byte  **SearchState;          //state for fractional pel search
+  distblk   pred_SAD_uplayer;     // Up layer SAD prediction
   int     flag_intra_SAD;
 
   short   pred_MV_uplayer_X;    // Up layer MV predictor X-component
   short   pred_MV_uplayer_Y;    // Up layer MV predictor Y-component
 };
 
-typedef struct umhex_smp_struct UMHexSMPStruct;
+typedef struct umhex_smp_context UMHexSMPContext;
 
 extern void    smpUMHEX_init              (VideoParameters *p_Vid);
 extern int     smpUMHEX_get_mem           (VideoParameters *p_Vid);
 extern void    smpUMHEX_free_mem          (VideoParameters *p_Vid);
-extern void    smpUMHEX_decide_intrabk_SAD(Macroblock *currMB);
+extern int     smpUMHEX_get_context_mem   (Slice *currSlice);
+extern void    smpUMHEX_free_context_mem  (Slice *currSlice);
+extern void    smpUMHEX_decide_intrabk_SAD(Macroblock *currMB, UMHexSMPContext *p_UMHexSMPCtx);
 extern void    smpUMHEX_skip_intrabk_SAD  (Macroblock *currMB);
-extern void    smpUMHEX_setup             (Macroblock *currMB, short, int, int, int, int, MotionVector *****);
+extern void    smpUMHEX_setup             (Macroblock *currMB, UMHexSMPContext *p_UMHexSMPCtx, short, int, int, int, int, MotionVector *****);
 extern distblk smpUMHEXBipredIntegerPelBlockMotionSearch (Macroblock *, int, MotionVector *, MotionVector *, MotionVector *, MotionVector *, MEBlock *, int, distblk, int);
 extern distblk smpUMHEXIntegerPelBlockMotionSearch       (Macroblock *currMB, MotionVector *pred_mv, MEBlock *mv_block, distblk min_mcost, int lambda_factor);
 extern distblk smpUMHEXSubPelBlockMotionSearch           (Macroblock *currMB, MotionVector *pred_mv, MEBlock *mv_block, distblk min_mcost, int lambda_factor);
@@ -0,0 +1,40 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    mode_pruning.h
+ *
+ * \brief
+ *    Headerfile for the adaptive macroblock mode pruning
+ **************************************************************************
+ */
+
+#ifndef _MODE_PRUNING_H_
+#define _MODE_PRUNING_H_
+
+#define MP_SLICE_TYPES   2   //!< P and B slices
+#define MP_CONTEXTS      3   //!< number of partitioned or intra neighbours A and B
+#define MP_MIN_SAMPLES  32   //!< decisions of a context needed before it may prune
+#define MP_QP_STEP       4   //!< slice QP range of one set of statistics
+#define MP_QP_BUCKETS   13   //!< sets of statistics covering QP 0..51
+
+//! running mode decision statistics
+typedef struct mode_pruning
+{
+  int   frame_no[MP_SLICE_TYPES];                   //!< last frame seen per slice type
+  int   bucket  [MP_SLICE_TYPES];                   //!< QP bucket of the current frame
+  int   refresh [MP_SLICE_TYPES];                   //!< current frame is a full search refresh frame
+  int   frames   [MP_SLICE_TYPES][MP_QP_BUCKETS];   //!< frames since the last refresh frame, -1 if never refreshed
+  int   mb_count [MP_SLICE_TYPES][MP_QP_BUCKETS][MP_CONTEXTS];           //!< macroblock decisions per context
+  int   sub_count[MP_SLICE_TYPES][MP_QP_BUCKETS][MP_CONTEXTS];           //!< sub-macroblock decisions of P8x8 macroblocks per context
+  int   wins     [MP_SLICE_TYPES][MP_QP_BUCKETS][MP_CONTEXTS][MAXMODE];  //!< decisions per mode, SMB8x8..SMB4x4 count sub-macroblocks
+  int64 checked;                                    //!< macroblocks for which pruning was active
+  int64 pruned[MAXMODE];                            //!< macroblocks for which a mode was disabled
+} ModePruning;
+
+extern int  init_mode_pruning  (VideoParameters *p_Vid);
+extern void free_mode_pruning  (VideoParameters *p_Vid);
+extern void prune_modes        (Macroblock *currMB, RD_PARAMS *enc_mb);
+extern void update_mode_pruning(Macroblock *currMB);
+
+#endif
+
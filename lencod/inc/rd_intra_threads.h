@@ -0,0 +1,95 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    rd_intra_threads.h
+ *
+ * \brief
+ *    Headerfile for the intra 4x4/8x8 mode decision on worker threads
+ **************************************************************************
+ */
+
+#ifndef _RD_INTRA_THREADS_H_
+#define _RD_INTRA_THREADS_H_
+
+#include "mbuffer.h"
+#include "rdopt.h"
+
+#define INTRA_THREADS_STREAM_SIZE  8192   //!< bytes of a private bitstream, coded data of one block fits easily
+
+//! RD result of one prediction mode of the current block, coded without early termination
+typedef struct intra_mode_result
+{
+  distblk  rdcost;                  //!< cost returned by the rdcost function
+  distblk  distortion;              //!< SSE of the reconstruction, decides the early termination on replay
+  int      nonzero;                 //!< nonzero levels
+  int      ores_nonzero;            //!< 4x4: prediction error not all zero
+  int      nz_coeff[2][2];          //!< CAVLC coefficient counts of the 4x4 blocks [x][y]
+  int      cof[4 * 2 * 65];         //!< levels and runs as in cofAC
+  imgpel   rec[BLOCK_SIZE_8x8][BLOCK_SIZE_8x8];
+} IntraModeResult;
+
+//! private copies of the encoder state a worker codes into
+typedef struct intra_worker
+{
+  VideoParameters     vid;
+  StorablePicture     pic;
+  Slice               slice;
+  Macroblock          mb;
+  RDOPTStructure      rdo;
+  DataPartition       part[3];
+  Bitstream           stream[3];
+  byte               *stream_buf[3];
+  TextureInfoContexts tex_ctx;
+  MotionInfoContexts  mot_ctx;
+  CSobj              *cs_cm;
+  CtxJournal         *ctx_journal;
+  imgpel            **rec;        //!< 16 lines, the macroblock rows of the picture all map onto them
+  imgpel            **rec_rows;   //!< line pointers of the private picture
+  int              ***nz_coeff;   //!< the live tables, except for the current macroblock
+  int               **nz_mb;      //!< coefficient counts of the current macroblock
+  imgpel           ***mb_pred;
+  int              ***mb_ores;
+  int              ***mb_rres;
+  int               **tblk16x16;
+  int              ****cofAC;
+  int                 session;    //!< session of the copied picture, slice and coding state
+  int                 block;      //!< block of the copied macroblock state
+} IntraWorker;
+
+struct intra_threads
+{
+  int              num_threads;
+  int              active;        //!< the current macroblock mode decision uses the workers
+  int              ready;         //!< the coding state is the stored one, the workers may copy it
+  int              session;       //!< counts the macroblock level mode decisions
+  int              block;         //!< counts the evaluated blocks
+  byte             done[NO_INTRA_PMODE];  //!< modes of the current block with a result
+  IntraModeResult  result[NO_INTRA_PMODE];
+  IntraWorker    **worker;
+};
+
+typedef struct intra_threads IntraThreads;
+
+extern IntraThreads *create_intra_threads (Slice *currSlice);
+extern void          delete_intra_threads (IntraThreads *p_IT);
+extern void          intra_threads_begin  (Macroblock *currMB, int transform_8x8);
+
+extern void    intra_threads_evaluate_4x4 (Macroblock *currMB, int b8, int b4, int lambda, int mostProbableMode, int left_available, int up_available, const byte *modes, int first_mode);
+extern void    intra_threads_evaluate_8x8 (Macroblock *currMB, int b8, int lambda, int mostProbableMode, int left_available, int up_available, const byte *modes, int first_mode);
+extern distblk intra_threads_replay_4x4   (Macroblock *currMB, int b8, int b4, int ipmode, distblk min_rdcost, int *nonzero);
+extern distblk intra_threads_replay_8x8   (Macroblock *currMB, int b8, int ipmode, distblk min_rdcost, int *nonzero);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Workers of the current intra mode decision, NULL if it runs sequentially
+ ************************************************************************
+ */
+static inline IntraThreads *get_intra_threads(Slice *currSlice)
+{
+  IntraThreads *p_IT = currSlice->p_RDO->intra_threads;
+
+  return (p_IT != NULL && p_IT->active) ? p_IT : NULL;
+}
+
+#endif
@@ -68,6 +68,8 @@ struct rdo_structure
   CSobj *cs_b8;
   CSobj *cs_cm;
   CSobj *cs_tmp;
+  CtxJournal *ctx_journal;
+  struct intra_threads *intra_threads;
 
   BestMode mode_best;
 
@@ -19,6 +19,28 @@
 #ifndef _RD_OPT_CS_H_
 #define _RD_OPT_CS_H_
 
+//! context model touched during the mode decision of a macroblock
+typedef struct ctx_journal_entry
+{
+  BiContextType *ctx;   //!< context in the slice tables
+  int            idx;   //!< index of the context (motion contexts first)
+  BiContextType  org;   //!< value at the start of the journal
+} CtxJournalEntry;
+
+//! log of the CABAC contexts changed since the start of the macroblock
+struct ctx_journal
+{
+  BiContextType   *mot_base;  //!< currSlice->mot_ctx as an array of contexts
+  BiContextType   *tex_base;  //!< currSlice->tex_ctx as an array of contexts
+  int              num_mot;
+  int              num_tex;
+  int              num;       //!< number of touched contexts
+  CtxJournalEntry *entry;
+  byte            *touched;   //!< per context flag, indexed like CtxJournalEntry::idx
+};
+
+typedef struct ctx_journal CtxJournal;
+
 struct coding_state {
 
   // important variables of data partition array
@@ -26,9 +48,10 @@ struct coding_state {
   Bitstream            *bitstream;
   EncodingEnvironment  *encenv;
 
-  // contexts for binary arithmetic coding
-  MotionInfoContexts   *mot_ctx;
-  TextureInfoContexts  *tex_ctx;
+  // contexts for binary arithmetic coding, as changes against the start of the journal
+  int                   num_ctx;
+  CtxJournalEntry      *ctx_entry;
+  BiContextType        *ctx_cur;
 
   // bit counter
   BitCounter            bits;
@@ -46,6 +69,39 @@ extern CSobj *create_coding_state  (InputParameters *p_Inp);       //!< create s
 
 extern void init_coding_state_methods(Slice *currSlice);  //!< Init methods given entropy coding
 
+extern CtxJournal *create_ctx_journal (void);
+extern void        delete_ctx_journal (CtxJournal *jr);
+extern void        begin_ctx_journal  (Slice *currSlice);
+extern void        end_ctx_journal    (Slice *currSlice);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Records the value of a context model before its first change
+ *    since the start of the journal
+ ************************************************************************
+ */
+static inline void journal_ctx(CtxJournal *jr, BiContextType *ctx)
+{
+  int idx;
+
+  if (ctx >= jr->mot_base && ctx < jr->mot_base + jr->num_mot)
+    idx = (int) (ctx - jr->mot_base);
+  else if (ctx >= jr->tex_base && ctx < jr->tex_base + jr->num_tex)
+    idx = jr->num_mot + (int) (ctx - jr->tex_base);
+  else
+    return;   // not part of the coding state
+
+  if (!jr->touched[idx])
+  {
+    CtxJournalEntry *entry = &jr->entry[jr->num++];
+    jr->touched[idx] = 1;
+    entry->ctx = ctx;
+    entry->idx = idx;
+    entry->org = *ctx;
+  }
+}
+
 
 #endif
 
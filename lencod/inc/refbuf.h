@@ -11,6 +11,7 @@
 #define _REBUF_H_
 
 #include "mbuffer.h"
+#include "img_luma.h"
 
 /*!
  ************************************************************************
@@ -21,6 +22,8 @@
  */
 static inline imgpel *UMVLine4X (StorablePicture *ref, int y, int x)
 {
+  if (ref->p_sub_cache != NULL)
+    return getSubPelLineLuma(ref, iClip3( -IMG_PAD_SIZE_Y, ref->size_y_pad, y >> 2), iClip3(-IMG_PAD_SIZE_X, ref->size_x_pad, x >> 2), (y & 0x03), (x & 0x03));
   //return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][iClip3( 0, ref->size_y_pad, y >> 2)][iClip3( 0, ref->size_x_pad, x >> 2)]);
   return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][iClip3( -IMG_PAD_SIZE_Y, ref->size_y_pad, y >> 2)][iClip3(-IMG_PAD_SIZE_X, ref->size_x_pad, x >> 2)]);
 }
@@ -47,6 +50,8 @@ static inline imgpel *UMVLine4Xcr (StorablePicture *ref, int cmp, int y, int x)
  */
 static inline imgpel *FastLine4X (StorablePicture *ref, int y, int x)
 {
+  if (ref->p_sub_cache != NULL)
+    return getSubPelLineLuma(ref, y >> 2, x >> 2, (y & 0x03), (x & 0x03));
   return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][y >> 2][x >> 2]);
 }
 
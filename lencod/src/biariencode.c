@@ -19,10 +19,32 @@
 
 #include "global.h"
 #include "biariencode.h"
+#include "rdopt_coding_state.h"
 
 // Range table for LPS
 static const byte renorm_table_32[32]={6,5,4,4,3,3,3,3,2,2,2,2,2,2,2,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
 
+//! Cost in 1/(1 << EST_FRAC_BITS) bits of coding a bin, indexed by 63 - state (MPS) or 64 + state (LPS)
+const int entropyBits[128]=
+{
+     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
+    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
+    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
+    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
+    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
+    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
+   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
+   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
+   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
+   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
+   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
+   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
+  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
+  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
+  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
+  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
+};
+
 
 void reset_pic_bin_count(VideoParameters *p_Vid)
 {
@@ -333,48 +355,60 @@ static const byte rLPS_table_64x4[64][4]=
   {   6,   7,   8,   9},
   {   2,   2,   2,   2}
 };
-static const byte AC_next_state_MPS_64[64] =
+static const byte AC_next_state_64[2][64] =
 {
-  1,2,3,4,5,6,7,8,9,10,
-  11,12,13,14,15,16,17,18,19,20,
-  21,22,23,24,25,26,27,28,29,30,
-  31,32,33,34,35,36,37,38,39,40,
-  41,42,43,44,45,46,47,48,49,50,
-  51,52,53,54,55,56,57,58,59,60,
-  61,62,62,63
-};
-
-static const byte AC_next_state_LPS_64[64] =
-{
-  0, 0, 1, 2, 2, 4, 4, 5, 6, 7,
-  8, 9, 9,11,11,12,13,13,15,15,
-  16,16,18,18,19,19,21,21,22,22,
-  23,24,24,25,26,26,27,27,28,29,
-  29,30,30,30,31,32,32,33,33,33,
-  34,34,35,35,35,36,36,36,37,37,
-  37,38,38,63
+  { // MPS
+    1,2,3,4,5,6,7,8,9,10,
+    11,12,13,14,15,16,17,18,19,20,
+    21,22,23,24,25,26,27,28,29,30,
+    31,32,33,34,35,36,37,38,39,40,
+    41,42,43,44,45,46,47,48,49,50,
+    51,52,53,54,55,56,57,58,59,60,
+    61,62,62,63
+  },
+  { // LPS
+    0, 0, 1, 2, 2, 4, 4, 5, 6, 7,
+    8, 9, 9,11,11,12,13,13,15,15,
+    16,16,18,18,19,19,21,21,22,22,
+    23,24,24,25,26,26,27,27,28,29,
+    29,30,30,30,31,32,32,33,33,33,
+    34,34,35,35,35,36,36,36,37,37,
+    37,38,38,63
+  }
 };
 
-  unsigned int low = eep->Elow;
-  unsigned int range = eep->Erange;  
-  int bl = eep->Ebits_to_go;
-  unsigned int rLPS = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
- 
+  unsigned int low, range, rLPS;
+  unsigned int state = bi_ct->state;
+  int lps = ((symbol != 0) != bi_ct->MPS);
+  int bl;
 
-  range -= rLPS;
+  if (eep->Ejournal)
+    journal_ctx(eep->Ejournal, bi_ct);
 
   ++(eep->C);
   bi_ct->count += eep->p_Vid->cabac_encoding;
 
-  /* covers all cases where code does not bother to shift down symbol to be 
-  * either 0 or 1, e.g. in some cases for cbp, mb_Type etc the code simply 
-  * masks off the bit position and passes in the resulting value */
-  //symbol = (short) (symbol != 0);
+  // context update without branches: the MPS switches on a LPS in state 0
+  bi_ct->MPS  ^= (unsigned char) (lps & (state == 0));
+  bi_ct->state = AC_next_state_64[lps][state];
 
-  if ((symbol != 0) == bi_ct->MPS)  //MPS
+  if (eep->Erate_est)
   {
-    bi_ct->state = AC_next_state_MPS_64[bi_ct->state]; // next state
+    eep->Efrac_bits += entropyBits[lps ? 64 + state : 63 - state];
 
+    if (eep->Erate_est == RATE_EST_ONLY) // the coder is not touched
+      return;
+  }
+
+  low   = eep->Elow;
+  range = eep->Erange;
+  bl    = eep->Ebits_to_go;
+  rLPS  = rLPS_table_64x4[state][(range>>6) & 3]; 
+
+  range -= rLPS;
+
+  if (!lps)
+  {
     if( range >= QUARTER ) // no renorm
     {
       eep->Erange = range;
@@ -391,7 +425,7 @@ static const byte AC_next_state_LPS_64[64] =
       }
     }
   } 
-  else         //LPS
+  else
   {
     unsigned int renorm = renorm_table_32[(rLPS >> 3) & 0x1F];
 
@@ -399,11 +433,6 @@ static const byte AC_next_state_LPS_64[64] =
     range = (rLPS << renorm);
     bl -= renorm;
 
-    if (!bi_ct->state)
-      bi_ct->MPS ^= 0x01;               // switch MPS if necessary
-
-    bi_ct->state = AC_next_state_LPS_64[bi_ct->state]; // next state
-
     if (low >= ONE) // output of carry needed
     {
       low -= ONE;
@@ -444,7 +473,19 @@ static const byte AC_next_state_LPS_64[64] =
  */
 void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
 {
-  unsigned int low = eep->Elow;
+  unsigned int low;
+
+  if (eep->Erate_est)
+  {
+    eep->Efrac_bits += (1 << EST_FRAC_BITS);
+    if (eep->Erate_est == RATE_EST_ONLY)
+    {
+      ++(eep->C);
+      return;
+    }
+  }
+
+  low = eep->Elow;
   --(eep->Ebits_to_go);  
   ++(eep->C);
 
@@ -479,6 +520,68 @@ void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Arithmetic encoding of len (<= 32) equiprobable bins, given MSB
+ *    first in symbols. Equivalent to len calls of
+ *    biari_encode_symbol_eq_prob(), but all bins up to the next
+ *    renormalization are added to low in one step:
+ *    low += (range * bins) << (bits_to_go - k)
+ ************************************************************************
+ */
+void biari_encode_symbols_eq_prob(EncodingEnvironmentPtr eep, unsigned int symbols, int len)
+{
+  if (eep->Erate_est)
+  {
+    eep->Efrac_bits += ((int64) len << EST_FRAC_BITS);
+    if (eep->Erate_est == RATE_EST_ONLY)
+    {
+      eep->C += len;
+      return;
+    }
+  }
+
+  eep->C += len;
+
+  while (len > 0)
+  {
+    unsigned int low = eep->Elow;
+    int bl = eep->Ebits_to_go;
+    int k  = imin(len, bl);
+
+    len -= k;
+    bl  -= k;
+    low += (eep->Erange * ((symbols >> len) & ((1u << k) - 1))) << bl;
+
+    if (low >= ONE) // output of carry needed
+    {
+      low -= ONE;
+      propagate_carry(eep);
+    }
+
+    if (bl == MIN_BITS_TO_GO)  // renorm needed
+    {
+      eep->Elow = (low << BITS_TO_LOAD )& (ONE_M1);
+      low = (low >> B_BITS) & B_LOAD_MASK; // mask out the 8/16 MSBs for output
+      if (low < B_LOAD_MASK)      // no carry possible, output now
+      {
+        put_last_chunk_plus_outstanding(eep, low);
+      }
+      else          // low == "FF"; keep it, may affect future carry
+      {
+        ++(eep->Echunks_outstanding);
+      }
+      eep->Ebits_to_go = BITS_TO_LOAD;
+    }
+    else
+    {
+      eep->Elow = low;
+      eep->Ebits_to_go = bl;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -487,9 +590,24 @@ void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
  */
 void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol)
 {
-  unsigned int range = eep->Erange - 2;
-  unsigned int low = eep->Elow;
-  int bl = eep->Ebits_to_go; 
+  unsigned int range, low;
+  int bl;
+
+  if (eep->Erate_est)
+  {
+    // the terminating bin has a fixed LPS range of 2: 7 bits for LPS, almost nothing for MPS
+    if (symbol)
+      eep->Efrac_bits += (7 << EST_FRAC_BITS);
+    if (eep->Erate_est == RATE_EST_ONLY)
+    {
+      ++(eep->C);
+      return;
+    }
+  }
+
+  range = eep->Erange - 2;
+  low = eep->Elow;
+  bl = eep->Ebits_to_go; 
 
   ++(eep->C);
 
@@ -142,28 +142,36 @@ const byte* pos2ctx_last    [] = {
 /*!
  ************************************************************************
  * \brief
- *    Exp Golomb binarization and encoding
+ *    Exp Golomb binarization and encoding, followed by the sign bin
+ *    of the value. All bypass bins are coded with one call when they
+ *    fit into 32 bins.
  ************************************************************************
  */
 static void exp_golomb_encode_eq_prob( EncodingEnvironmentPtr eep_dp,
                                 unsigned int symbol,
-                                int k)
+                                int k,
+                                int sign)
 {
-  for(;;)
+  unsigned int prefix = 0;
+  int len = 1;
+
+  while (symbol >= (unsigned int)(1<<k))
   {
-    if (symbol >= (unsigned int)(1<<k))
-    {
-      biari_encode_symbol_eq_prob(eep_dp, 1);   //first unary part
-      symbol = symbol - (1<<k);
-      k++;
-    }
-    else
-    {
-      biari_encode_symbol_eq_prob(eep_dp, 0);   //now terminated zero of unary part
-      while (k--)                               //next binary part
-        biari_encode_symbol_eq_prob(eep_dp, ((symbol>>k)&1));
-      break;
-    }
+    prefix = (prefix << 1) | 1;               //first unary part
+    symbol = symbol - (1<<k);
+    k++;
+    len++;
+  }
+
+  symbol = (symbol << 1) | sign;              //binary part and the sign
+  k++;
+
+  if (len + k <= 32)
+    biari_encode_symbols_eq_prob(eep_dp, (prefix << k << 1) | symbol, len + k);
+  else
+  {
+    biari_encode_symbols_eq_prob(eep_dp, prefix << 1, len);  //unary part and its terminating zero
+    biari_encode_symbols_eq_prob(eep_dp, symbol, k);
   }
 }
 
@@ -231,16 +239,18 @@ static void unary_bin_max_encode(EncodingEnvironmentPtr eep_dp,
 /*!
  ************************************************************************
  * \brief
- *    Exp-Golomb for Level Encoding
+ *    Exp-Golomb for Level Encoding, including the sign bin
 *
 ************************************************************************/
 static void unary_exp_golomb_level_encode( EncodingEnvironmentPtr eep_dp,
                                     unsigned int symbol,
-                                    BiContextTypePtr ctx)
+                                    BiContextTypePtr ctx,
+                                    int sign)
 {
   if (symbol==0)
   {
     biari_encode_symbol(eep_dp, 0, ctx );
+    biari_encode_symbol_eq_prob(eep_dp, sign);
     return;
   }
   else
@@ -252,9 +262,12 @@ static void unary_exp_golomb_level_encode( EncodingEnvironmentPtr eep_dp,
     while (((--l)>0) && (++k <= 13))
       biari_encode_symbol(eep_dp, 1, ctx);
     if (symbol < 13) 
+    {
       biari_encode_symbol(eep_dp, 0, ctx);
+      biari_encode_symbol_eq_prob(eep_dp, sign);
+    }
     else 
-      exp_golomb_encode_eq_prob(eep_dp,symbol - 13, 0);
+      exp_golomb_encode_eq_prob(eep_dp,symbol - 13, 0, sign);
   }
 }
 
@@ -262,17 +275,19 @@ static void unary_exp_golomb_level_encode( EncodingEnvironmentPtr eep_dp,
 /*!
  ************************************************************************
  * \brief
- *    Exp-Golomb for MV Encoding
+ *    Exp-Golomb for MV Encoding, including the sign bin
 *
 ************************************************************************/
 static void unary_exp_golomb_mv_encode(EncodingEnvironmentPtr eep_dp,
                                 unsigned int symbol,
                                 BiContextTypePtr ctx,
-                                unsigned int max_bin)
+                                unsigned int max_bin,
+                                int sign)
 {  
   if (symbol==0)
   {
     biari_encode_symbol(eep_dp, 0, ctx );
+    biari_encode_symbol_eq_prob(eep_dp, sign);
     return;
   }
   else
@@ -290,9 +305,12 @@ static void unary_exp_golomb_mv_encode(EncodingEnvironmentPtr eep_dp,
         ++ctx;
     }
     if (symbol < 8) 
+    {
       biari_encode_symbol(eep_dp, 0, ctx);
+      biari_encode_symbol_eq_prob(eep_dp, sign);
+    }
     else 
-      exp_golomb_encode_eq_prob(eep_dp, symbol - 8, 3);
+      exp_golomb_encode_eq_prob(eep_dp, symbol - 8, 3, sign);
   }
 }
 
@@ -1232,9 +1250,8 @@ void writeMVD_CABAC(Macroblock *currMB, SyntaxElement *se, DataPartition *dp)
     biari_encode_symbol(eep_dp, 1, &ctx->mv_res_contexts[0][act_ctx] );
     act_sym--;
     act_ctx=5*k;
-    unary_exp_golomb_mv_encode(eep_dp,act_sym,ctx->mv_res_contexts[1]+act_ctx,3);
     mv_sign = (mv_pred_res<0) ? 1: 0;
-    biari_encode_symbol_eq_prob(eep_dp, mv_sign);
+    unary_exp_golomb_mv_encode(eep_dp,act_sym,ctx->mv_res_contexts[1]+act_ctx,3,mv_sign);
   }
 
   dp->bitstream->write_flag = 1;
@@ -1819,14 +1836,15 @@ void write_significant_coefficients (EncodingEnvironmentPtr eep_dp, int type, in
       if (greater_one)
       {
         ctx = imin(c2++, max_c2[type]);
-        unary_exp_golomb_level_encode(eep_dp, absLevel - 2, abs_contexts + ctx);
+        unary_exp_golomb_level_encode(eep_dp, absLevel - 2, abs_contexts + ctx, sign);
         c1 = 0;
       }
-      else if (c1)
+      else
       {
-        c1++;
+        if (c1)
+          c1++;
+        biari_encode_symbol_eq_prob (eep_dp, sign);
       }
-      biari_encode_symbol_eq_prob (eep_dp, sign);
     }
   }
 }
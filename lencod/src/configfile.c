@@ -1108,12 +1108,52 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Inp->ChromaMEEnable = FALSE;
   }
 
+  if ( p_Inp->InterpolationMode && p_Inp->yuv_format == YUV444 )
+  {
+    snprintf(errortext, ET_SIZE, "\nInterpolationMode > 0 is not supported for 4:4:4 coding.");
+    error (errortext, 500);
+  }
+
+  // the block cache only covers luma; lazy tiles keep the full chroma planes
+  if ( p_Inp->InterpolationMode == 1 && p_Inp->ChromaMEEnable )
+  {
+    snprintf(errortext, ET_SIZE, "\nInterpolationMode = 1 cannot be used together with ChromaMEEnable.");
+    error (errortext, 500);
+  }
+
+  if ( p_Inp->InterpolationMode == 1 && p_Inp->ChromaMCBuffer )
+  {
+    fprintf(stderr, "Warning: Disabling ChromaMCBuffer for on-demand interpolation (InterpolationMode = 1).\n");
+    p_Inp->ChromaMCBuffer = 0;
+  }
+
   if ( (p_Inp->ChromaMCBuffer == 0) && (( p_Inp->yuv_format ==  YUV444) && (!p_Inp->separate_colour_plane_flag)) )
   {
     fprintf(stderr, "Warning: Enabling ChromaMCBuffer for 4:4:4 combined color coding.\n");
     p_Inp->ChromaMCBuffer = 1;
   }
 
+  // the coarse vector only moves the search centre of the predictive searches
+  if ( p_Inp->PyramidME && (p_Inp->SearchMode < UM_HEX || p_Inp->separate_colour_plane_flag) )
+  {
+    fprintf(stderr, "Warning: PyramidME needs SearchMode 1, 2 or 3 without separate colour planes, disabling PyramidME.\n");
+    p_Inp->PyramidME = 0;
+  }
+
+  // the hash tables are built from the luma source of the stored pictures
+  if ( p_Inp->HashME && p_Inp->separate_colour_plane_flag )
+  {
+    fprintf(stderr, "Warning: HashME is not supported with separate colour planes, disabling HashME.\n");
+    p_Inp->HashME = 0;
+  }
+
+  // EPZS bounds its predictors with the window and the fast full search computes the whole window up front
+  if ( p_Inp->AdaptiveSearchRange && p_Inp->SearchMode != FULL_SEARCH && p_Inp->SearchMode != UM_HEX && p_Inp->SearchMode != UM_HEX_SIMPLE )
+  {
+    fprintf(stderr, "Warning: AdaptiveSearchRange is only supported with full search and UMHEX, disabling AdaptiveSearchRange.\n");
+    p_Inp->AdaptiveSearchRange = 0;
+  }
+
   if (p_Inp->EnableOpenGOP && p_Inp->ReferenceReorder == 2)
   {
     printf("If OpenGOP is enabled than ReferenceReorder is set to 1. \n");
@@ -65,6 +65,8 @@
 
 #include "md_common.h"
 #include "me_epzs_common.h"
+#include "me_pyramid.h"
+#include "me_hash.h"
 
 extern void UpdateDecoders            (VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic);
 
@@ -1303,6 +1305,8 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Vid->prev_frame_no = p_Vid->frame_no;
   }
 
+  update_subpel_mem_peak(p_Vid->p_Dpb);
+
   gettime(&end_time);    // end time in ms
   tmp_time  = timediff(&start_time, &end_time);
   p_Vid->tot_time += tmp_time;
@@ -2050,20 +2054,59 @@ static void init_field (VideoParameters *p_Vid, InputParameters *p_Inp)
 void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
+  TIME_T start_time, end_time;
+
   if(s->bInterpolated)
     return;
   s->bInterpolated = 1;
 
+  gettime(&start_time);
+
+  // cached blocks of an earlier interpolation of this picture, or of a freed
+  // picture at the same address, are stale
+  if (p_Vid->p_sub_cache)
+    reset_subpel_cache(p_Vid->p_sub_cache);
+
+  if (p_Inp->InterpolationMode == INTERP_BLOCK_CACHE)
+  {
+    // only pad the integer samples; sub-pel blocks are generated by getSubPelLineLuma()
+    s->p_curr_img = s->imgY;
+    getSubImageInteger_s( s, s->imgY, s->imgY );
+    if (p_Vid->p_pyramid)
+      get_pyramid_planes(s);
+    if (p_Inp->HashME)
+      get_hash_table(p_Vid, s);
+
+    gettime(&end_time);
+    p_Vid->interp_tot_time += timediff(&start_time, &end_time);
+    return;
+  }
+
   // Y component
   s->p_img_sub[0] = s->imgY_sub;
   s->p_curr_img_sub = s->imgY_sub;
   s->p_curr_img = s->imgY;
 
+  // scaled levels for the pyramid motion estimation pre-pass
+  if (p_Vid->p_pyramid)
+    get_pyramid_planes(s);
+
+  // block hashes for the hash motion search
+  if (p_Inp->HashME)
+    get_hash_table(p_Vid, s);
+
   // derive the subpixel images for first component
   // No need to interpolate if intra only encoding
   //if (p_Inp->intra_period != 1)
   {
-    getSubImagesLuma ( p_Vid, s );
+    if (s->subpel_tile_map != NULL)
+    {
+      // pad the integer samples; sub-pel tiles are generated on first access
+      getSubImageInteger_s( s, s->imgY_sub[0][0], s->p_curr_img );
+      reset_subpel_tile_map( p_Vid->p_sub_cache, s );
+    }
+    else
+      getSubImagesLuma ( p_Vid, s );
 
     // and the sub-images for U and V
     if ( (p_Vid->yuv_format != YUV400) && (p_Inp->ChromaMCBuffer) )
@@ -2083,6 +2126,9 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
         getSubImagesChroma( p_Vid, s );
     }
   }
+
+  gettime(&end_time);
+  p_Vid->interp_tot_time += timediff(&start_time, &end_time);
 }
 
 /*!
@@ -675,3 +675,333 @@ void getDiagSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel **srcI
 }
 
 
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates the block cache used for on-demand interpolation
+ *    (InterpolationMode = 1). For lazy tiles (InterpolationMode = 2)
+ *    only the interpolation workspace is allocated.
+ *
+ * \param p_Vid
+ *    pointer to VideoParameters structure
+ *
+ * \return
+ *    memory size in bytes
+ ************************************************************************
+ */
+int init_subpel_cache( VideoParameters *p_Vid )
+{
+  SubPelCache *cache;
+  imgpel *data;
+  int i;
+  int stride = p_Vid->width + 2 * IMG_PAD_SIZE_X;
+
+  if ((cache = (SubPelCache *) calloc(1, sizeof(SubPelCache))) == NULL)
+    no_mem_exit("init_subpel_cache: cache");
+
+  cache->mem_size = sizeof(SubPelCache);
+  cache->p_Vid    = p_Vid;
+  cache->mode     = p_Vid->p_Inp->InterpolationMode;
+  cache->stride   = stride;
+
+  if (cache->mode == INTERP_BLOCK_CACHE)
+  {
+    cache->mem_size += get_mem1Dpel(&data, SUBPEL_CACHE_SIZE * SUBPEL_BLOCK_SIZE * stride);
+    for (i = 0; i < SUBPEL_CACHE_SIZE; ++i)
+      cache->blk[i].data = &data[i * SUBPEL_BLOCK_SIZE * stride];
+  }
+
+  p_Vid->p_sub_cache = cache;
+
+  return cache->mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the on-demand interpolation block cache
+ ************************************************************************
+ */
+void free_subpel_cache( VideoParameters *p_Vid )
+{
+  if (p_Vid->p_sub_cache)
+  {
+    if (p_Vid->p_sub_cache->blk[0].data)
+      free_mem1Dpel(p_Vid->p_sub_cache->blk[0].data);
+    free(p_Vid->p_sub_cache);
+    p_Vid->p_sub_cache = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Invalidates all cached blocks; called for every new macroblock and
+ *    whenever a reference picture is (re)interpolated
+ ************************************************************************
+ */
+void reset_subpel_cache( SubPelCache *cache )
+{
+  int i;
+  for (i = 0; i < SUBPEL_CACHE_SIZE; ++i)
+    cache->blk[i].ref = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates the tile map of a reference picture for lazy sub-pel
+ *    plane generation (InterpolationMode = 2)
+ *
+ * \return
+ *    memory size in bytes
+ ************************************************************************
+ */
+int alloc_subpel_tile_map( StorablePicture *s )
+{
+  s->tile_rows = (s->size_y_padded + SUBPEL_TILE_SIZE - 1) >> SUBPEL_TILE_SHIFT;
+  s->tile_cols = (s->size_x_padded + SUBPEL_TILE_SIZE - 1) >> SUBPEL_TILE_SHIFT;
+
+  if ((s->subpel_tile_map = (byte *) calloc(16 * s->tile_rows * s->tile_cols, sizeof(byte))) == NULL)
+    no_mem_exit("alloc_subpel_tile_map: subpel_tile_map");
+
+  return 16 * s->tile_rows * s->tile_cols * sizeof(byte);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Marks all sub-pel tiles of a picture as not interpolated; called
+ *    whenever the integer samples of the reference are (re)generated
+ ************************************************************************
+ */
+void reset_subpel_tile_map( SubPelCache *cache, StorablePicture *s )
+{
+  memset(s->subpel_tile_map, 0, 16 * s->tile_rows * s->tile_cols * sizeof(byte));
+  cache->tiles_total += 15 * s->tile_rows * s->tile_cols;
+}
+
+//! source planes (0: full, 1: half-hor, 2: half-ver, 3: center) and offsets of the two samples averaged per phase
+static const char SUBPEL_SRC[4][4][6] =
+{
+  { {0,0,0, 0,0,0}, {0,0,0, 1,0,0}, {1,0,0, 1,0,0}, {1,0,0, 0,0,1} },
+  { {0,0,0, 2,0,0}, {1,0,0, 2,0,0}, {1,0,0, 3,0,0}, {1,0,0, 2,0,1} },
+  { {2,0,0, 2,0,0}, {2,0,0, 3,0,0}, {3,0,0, 3,0,0}, {3,0,0, 2,0,1} },
+  { {2,0,0, 0,1,0}, {2,0,0, 1,1,0}, {3,0,0, 1,1,0}, {1,1,0, 2,0,1} }
+};
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Interpolates a block of up to SUBPEL_BLOCK_SIZE x SUBPEL_BLOCK_SIZE
+ *    samples of a quarter-pel phase. Results are bit exact with
+ *    getSubImagesLuma().
+ ************************************************************************
+ */
+static void interpolate_block_luma( SubPelCache *cache, StorablePicture *ref, int pos_y, int pos_x, int frac_y, int frac_x,
+                                    imgpel *dst, int stride, int height, int width )
+{
+  static const int size = SUBPEL_BLOCK_SIZE + 1;
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int max_imgpel_value = cache->p_Vid->max_imgpel_value;
+  const char *src = SUBPEL_SRC[frac_y][frac_x];
+  int need_plane[4] = { 0, 0, 0, 0 };
+  imgpel **img = ref->p_curr_img;
+  int maxy = ref->size_y - 1;
+  int maxx = ref->size_x - 1;
+  imgpel (*win)[SUBPEL_BLOCK_SIZE + 6] = cache->win;
+  imgpel *wLine;
+  imgpel *pA, *pB;
+  int i, j, is, y;
+
+  need_plane[(int) src[0]] = 1;
+  need_plane[(int) src[3]] = 1;
+
+  // integer samples including the filter support; clipping to the picture
+  // area is equivalent to reading the padded reference planes
+  for (j = 0; j < SUBPEL_BLOCK_SIZE + 6; ++j)
+  {
+    imgpel *srcLine = img[iClip3(0, maxy, pos_y + j - 2)];
+    wLine = win[j];
+    for (i = 0; i < SUBPEL_BLOCK_SIZE + 6; ++i)
+      wLine[i] = srcLine[iClip3(0, maxx, pos_x + i - 2)];
+  }
+
+  if (need_plane[0])
+  {
+    for (j = 0; j < size; ++j)
+      memcpy(cache->plane[0][j], &win[j + 2][2], size * sizeof(imgpel));
+  }
+
+  if (need_plane[1])
+  {
+    for (j = 0; j < size; ++j)
+    {
+      wLine = &win[j + 2][2];
+      for (i = 0; i < size; ++i)
+      {
+        is = tap0 * (wLine[i] + wLine[i + 1]) + tap1 * (wLine[i - 1] + wLine[i + 2]) + tap2 * (wLine[i - 2] + wLine[i + 3]);
+        cache->plane[1][j][i] = (imgpel) iClip1 (max_imgpel_value, rshift_rnd_sf( is, 5 ) );
+      }
+    }
+  }
+
+  if (need_plane[2])
+  {
+    for (j = 0; j < size; ++j)
+    {
+      for (i = 0; i < size; ++i)
+      {
+        is = tap0 * (win[j + 2][i + 2] + win[j + 3][i + 2]) + tap1 * (win[j + 1][i + 2] + win[j + 4][i + 2]) + tap2 * (win[j][i + 2] + win[j + 5][i + 2]);
+        cache->plane[2][j][i] = (imgpel) iClip1 (max_imgpel_value, rshift_rnd_sf( is, 5 ) );
+      }
+    }
+  }
+
+  if (need_plane[3])
+  {
+    int (*tmp)[SUBPEL_BLOCK_SIZE + 1] = cache->tmp;
+    for (j = 0; j < SUBPEL_BLOCK_SIZE + 6; ++j)
+    {
+      wLine = &win[j][2];
+      for (i = 0; i < size; ++i)
+        tmp[j][i] = tap0 * (wLine[i] + wLine[i + 1]) + tap1 * (wLine[i - 1] + wLine[i + 2]) + tap2 * (wLine[i - 2] + wLine[i + 3]);
+    }
+    for (j = 0; j < size; ++j)
+    {
+      for (i = 0; i < size; ++i)
+      {
+        is = tap0 * (tmp[j + 2][i] + tmp[j + 3][i]) + tap1 * (tmp[j + 1][i] + tmp[j + 4][i]) + tap2 * (tmp[j][i] + tmp[j + 5][i]);
+        cache->plane[3][j][i] = (imgpel) iClip1 (max_imgpel_value, rshift_rnd_sf( is, 10 ) );
+      }
+    }
+  }
+
+  for (y = 0; y < height; ++y)
+  {
+    pA = &cache->plane[(int) src[0]][y + src[1]][(int) src[2]];
+    pB = &cache->plane[(int) src[3]][y + src[4]][(int) src[5]];
+    for (i = 0; i < width; ++i)
+      dst[i] = (imgpel) rshift_rnd_sf( pA[i] + pB[i], 1 );
+    dst += stride;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Interpolates all tiles of a quarter-pel plane that are touched by
+ *    a MB_BLOCK_SIZE x MB_BLOCK_SIZE access at (pos_y, pos_x) and have
+ *    not been generated yet (InterpolationMode = 2)
+ ************************************************************************
+ */
+static void fill_subpel_tiles( SubPelCache *cache, StorablePicture *ref, int pos_y, int pos_x, int frac_y, int frac_x )
+{
+  byte *map = &ref->subpel_tile_map[((frac_y << 2) + frac_x) * ref->tile_rows * ref->tile_cols];
+  imgpel **dstImg = ref->p_curr_img_sub[frac_y][frac_x];
+  int ty0 = (pos_y + IMG_PAD_SIZE_Y) >> SUBPEL_TILE_SHIFT;
+  int tx0 = (pos_x + IMG_PAD_SIZE_X) >> SUBPEL_TILE_SHIFT;
+  int ty1 = imin(ref->tile_rows - 1, (pos_y + IMG_PAD_SIZE_Y + MB_BLOCK_SIZE - 1) >> SUBPEL_TILE_SHIFT);
+  int tx1 = imin(ref->tile_cols - 1, (pos_x + IMG_PAD_SIZE_X + MB_BLOCK_SIZE - 1) >> SUBPEL_TILE_SHIFT);
+  int ty, tx, y, x, y1, x1;
+  TIME_T start_time, end_time;
+
+  for (ty = ty0; ty <= ty1; ++ty)
+  {
+    for (tx = tx0; tx <= tx1; ++tx)
+    {
+      if (map[ty * ref->tile_cols + tx])
+        continue;
+      map[ty * ref->tile_cols + tx] = 1;
+      ++cache->tiles_done;
+      gettime(&start_time);
+
+      y1 = imin((ty + 1) * SUBPEL_TILE_SIZE, ref->size_y_padded) - IMG_PAD_SIZE_Y;
+      x1 = imin((tx + 1) * SUBPEL_TILE_SIZE, ref->size_x_padded) - IMG_PAD_SIZE_X;
+      for (y = ty * SUBPEL_TILE_SIZE - IMG_PAD_SIZE_Y; y < y1; y += SUBPEL_BLOCK_SIZE)
+      {
+        for (x = tx * SUBPEL_TILE_SIZE - IMG_PAD_SIZE_X; x < x1; x += SUBPEL_BLOCK_SIZE)
+        {
+          interpolate_block_luma(cache, ref, y, x, frac_y, frac_x, &dstImg[y][x], ref->size_x_padded,
+            imin(SUBPEL_BLOCK_SIZE, y1 - y), imin(SUBPEL_BLOCK_SIZE, x1 - x));
+        }
+      }
+      gettime(&end_time);
+      cache->p_Vid->interp_tot_time += timediff(&start_time, &end_time);
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Yields a pel line pointer of a sub-pel reference block for
+ *    on-demand interpolation. At least MB_BLOCK_SIZE rows/columns
+ *    starting at the returned position are valid; the row stride is
+ *    the one of the padded reference picture. In lazy tile mode the
+ *    pointer refers to the sub-pel plane itself, after the covered
+ *    tiles have been generated.
+ *
+ * \param ref
+ *    reference picture
+ * \param pos_y
+ *    vertical integer position
+ * \param pos_x
+ *    horizontal integer position
+ * \param frac_y
+ *    vertical quarter-pel phase
+ * \param frac_x
+ *    horizontal quarter-pel phase
+ ************************************************************************
+ */
+imgpel *getSubPelLineLuma( StorablePicture *ref, int pos_y, int pos_x, int frac_y, int frac_x )
+{
+  SubPelCache *cache = ref->p_sub_cache;
+  SubPelBlock *blk, *victim = &cache->blk[0];
+  int i;
+
+  if ((frac_y | frac_x) == 0)
+    return &ref->p_curr_img[pos_y][pos_x];
+
+  if (cache->mode == INTERP_LAZY_TILES)
+  {
+    fill_subpel_tiles(cache, ref, pos_y, pos_x, frac_y, frac_x);
+    return &ref->p_curr_img_sub[frac_y][frac_x][pos_y][pos_x];
+  }
+
+  for (i = 0; i < SUBPEL_CACHE_SIZE; ++i)
+  {
+    blk = &cache->blk[i];
+    if (blk->ref == ref && blk->frac_y == frac_y && blk->frac_x == frac_x)
+    {
+      unsigned int off_y = (unsigned int) (pos_y - blk->pos_y);
+      unsigned int off_x = (unsigned int) (pos_x - blk->pos_x);
+      if (off_y <= SUBPEL_BLOCK_MARGIN && off_x <= SUBPEL_BLOCK_MARGIN)
+      {
+        blk->last_use = ++cache->use_counter;
+        ++cache->hits;
+        return &blk->data[off_y * cache->stride + off_x];
+      }
+    }
+    if (blk->ref == NULL || (victim->ref != NULL && blk->last_use < victim->last_use))
+      victim = blk;
+  }
+
+  // a miss costs far less than a pair of gettime() calls; the on-demand
+  // interpolation time is therefore part of the ME time and not timed here
+  victim->ref    = ref;
+  // centre the new block on the request so that neighbouring candidates in
+  // either direction are served from it
+  victim->pos_y  = pos_y - (SUBPEL_BLOCK_MARGIN >> 1);
+  victim->pos_x  = pos_x - (SUBPEL_BLOCK_MARGIN >> 1);
+  victim->frac_y = frac_y;
+  victim->frac_x = frac_x;
+  victim->last_use = ++cache->use_counter;
+  interpolate_block_luma(cache, ref, victim->pos_y, victim->pos_x, frac_y, frac_x, victim->data, cache->stride, SUBPEL_BLOCK_SIZE, SUBPEL_BLOCK_SIZE);
+  ++cache->misses;
+
+  return &victim->data[(SUBPEL_BLOCK_MARGIN >> 1) * (cache->stride + 1)];
+}
@@ -57,6 +57,7 @@
 #include "explicit_seq.h"
 #include "filehandle.h"
 #include "image.h"
+#include "img_luma.h"
 #include "input.h"
 #include "img_io.h"
 #include "slice.h"
@@ -82,6 +83,7 @@
 #include "img_process.h"
 #include "q_offsets.h"
 #include "pred_struct.h"
+#include "mode_pruning.h"
 
 FILE *ourModes, *resultsPSNRbits;
 
@@ -228,6 +230,7 @@ int main(int argc, char **argv) {
 
     free_params(p_Enc->p_Inp);
     free_encoder(p_Enc);
+    free_mem_tracking();
 
     fclose(ourModes);
     fclose(resultsPSNRbits);
@@ -260,6 +263,8 @@ static unsigned CeilLog2(unsigned uiVal) {
  */
 
 static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp) {
+    MemTag prev_tag;
+
     p_Vid->p_Inp = p_Inp;
     p_Vid->giRDOpt_B8OnlyFlag = FALSE;
     p_Vid->p_log = NULL;
@@ -267,6 +272,9 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp) {
     p_Vid->cabac_encoding = 0;
     p_Vid->frame_statistic_start = 1;
 
+    mem_set_tracking(p_Inp->MemoryReport);
+    mem_set_policy((MemPolicy) p_Inp->MemoryPolicy, p_Inp->MemoryFirstTouch);
+
     if (p_Inp->Log2MaxFNumMinus4 == -1) {
         p_Vid->log2_max_frame_num_minus4 = iClip3(0, 12, (int) (CeilLog2(p_Inp->no_frames) - 4)); // hack for now...
     } else
@@ -397,7 +405,9 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp) {
 
     p_Vid->p_Dpb->init_done = 0;
 
+    prev_tag = mem_set_tag(MEM_TAG_DPB);
     init_dpb(p_Vid, p_Vid->p_Dpb);
+    mem_set_tag(prev_tag);
     init_out_buffer(p_Vid);
     init_stats(p_Inp, p_Vid->p_Stats);
     init_dstats(p_Vid->p_Dist);
@@ -420,7 +430,9 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp) {
         wpxInitWPXPasses(p_Vid, p_Inp);
     }
 
+    prev_tag = mem_set_tag(MEM_TAG_ME);
     Init_Motion_Search_Module(p_Vid, p_Inp);
+    mem_set_tag(prev_tag);
     information_init(p_Vid, p_Inp, p_Vid->p_Stats);
 
     if (p_Inp->DistortionYUVtoRGB)
@@ -637,6 +649,12 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp) {
         if (p_Inp->ReportFrameStats)
             report_frame_statistic(p_Vid, p_Inp);
 
+        if (p_Inp->MemoryReport > 1)
+            report_frame_memory(p_Vid, p_Inp);
+
+        if (p_Inp->AdaptiveSearchRange)
+            report_frame_search_range(p_Vid);
+
     }
 
 #if EOS_OUTPUT
@@ -729,6 +747,7 @@ static void init_img(VideoParameters *p_Vid) {
     InputParameters *p_Inp = p_Vid->p_Inp;
     int i, j;
     int imgpel_abs_range;
+    MemTag prev_tag;
 
     p_Vid->number = -1;
 
@@ -938,7 +957,9 @@ static void init_img(VideoParameters *p_Vid) {
 
     RandomIntraInit(p_Vid, p_Vid->PicWidthInMbs, p_Vid->FrameHeightInMbs, p_Inp->RandomIntraMBRefresh);
 
+    prev_tag = mem_set_tag(MEM_TAG_SEI);
     InitSEIMessages(p_Vid, p_Inp);
+    mem_set_tag(prev_tag);
 
     initInput(p_Vid, &p_Inp->source, &p_Inp->output);
 
@@ -1161,6 +1182,7 @@ int init_orig_buffers(VideoParameters *p_Vid, ImageData *imgData) {
  */
 static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp) {
     int j, memory_size = 0;
+    MemTag prev_tag;
 
     if ((p_Vid->enc_frame_picture = (StorablePicture**) malloc(6 * sizeof (StorablePicture*))) == NULL)
         no_mem_exit("init_global_buffers: *p_Vid->enc_frame_picture");
@@ -1233,7 +1255,9 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp) {
 
 
     if (p_Inp->rdopt == 3) {
+        prev_tag = mem_set_tag(MEM_TAG_ERRDO);
         memory_size += allocate_errdo_mem(p_Vid, p_Inp);
+        mem_set_tag(prev_tag);
     }
 
     if (p_Inp->RestrictRef) {
@@ -1250,6 +1274,7 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp) {
     }
 
     // allocate and set memory relating to motion estimation
+    prev_tag = mem_set_tag(MEM_TAG_ME);
     if (!p_Inp->IntraProfile) {
         if (p_Inp->SearchMode == UM_HEX) {
             if ((p_Vid->p_UMHex = (UMHexStruct*) calloc(1, sizeof (UMHexStruct))) == NULL)
@@ -1266,8 +1291,10 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp) {
         }
     }
 
+    mem_set_tag(MEM_TAG_RC);
     if (p_Inp->RCEnable)
         rc_allocate_memory(p_Vid, p_Inp);
+    mem_set_tag(prev_tag);
 
     if (p_Inp->redundant_pic_flag) {
         memory_size += get_mem2Dpel(&p_Vid->imgY_tmp, p_Vid->height, p_Vid->width);
@@ -1275,11 +1302,19 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp) {
         memory_size += get_mem2Dpel(&p_Vid->imgUV_tmp[1], p_Vid->height_cr, p_Vid->width_cr);
     }
 
-    memory_size += get_mem2DintWithPad(&p_Vid->imgY_sub_tmp, p_Vid->height, p_Vid->width, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+    prev_tag = mem_set_tag(MEM_TAG_SUBPEL);
+    if (p_Inp->InterpolationMode)
+        memory_size += init_subpel_cache(p_Vid);
+    else
+        memory_size += get_mem2DintWithPad(&p_Vid->imgY_sub_tmp, p_Vid->height, p_Vid->width, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+    mem_set_tag(prev_tag);
 
     if (p_Inp->ChromaMCBuffer)
         chroma_mc_setup(p_Vid);
 
+    if (p_Inp->AdaptiveModePruning)
+        memory_size += init_mode_pruning(p_Vid);
+
     p_Vid->padded_size_x = (p_Vid->width + 2 * IMG_PAD_SIZE_X);
     p_Vid->padded_size_x_m8x8 = (p_Vid->padded_size_x - BLOCK_SIZE_8x8);
     p_Vid->padded_size_x_m4x4 = (p_Vid->padded_size_x - BLOCK_SIZE);
@@ -1416,6 +1451,9 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
         wpxFreeWPXObject(p_Vid);
     }
 
+    free_subpel_cache(p_Vid);
+    free_mode_pruning(p_Vid);
+
     if (p_Vid->imgY_sub_tmp) // free temp quarter pel frame buffers
     {
         free_mem2DintWithPad(p_Vid->imgY_sub_tmp, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
@@ -1459,10 +1497,8 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     }
 
     if (p_Inp->RestrictRef) {
-        free(p_Vid->pixel_map[0]);
-        free(p_Vid->pixel_map);
-        free(p_Vid->refresh_map[0]);
-        free(p_Vid->refresh_map);
+        free_mem2D(p_Vid->pixel_map);
+        free_mem2D(p_Vid->refresh_map);
     }
 
     if (!p_Vid->active_sps->frame_mbs_only_flag) {
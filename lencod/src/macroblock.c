@@ -35,6 +35,7 @@
 #include "fmo.h"
 #include "vlc.h"
 #include "image.h"
+#include "img_luma.h"
 #include "mb_access.h"
 #include "ratectl.h"              // header file for rate control
 #include "cabac.h"
@@ -324,6 +325,24 @@ void reset_macroblock(Macroblock *currMB)
 }
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Switches the CABAC engines of all data partitions between
+ *    arithmetic coding and table based rate estimation (RateEstMode)
+ ************************************************************************
+ */
+static void set_rate_estimation(Slice *currSlice, int mode)
+{
+  int i;
+
+  for (i = 0; i < currSlice->max_part_nr; ++i)
+  {
+    currSlice->partArr[i].ee_cabac.Erate_est  = mode;
+    currSlice->partArr[i].ee_cabac.Efrac_bits = 0;
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -370,6 +389,9 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
 
   set_MB_parameters (currSlice, *currMB);
 
+  if (p_Vid->p_sub_cache)
+    reset_subpel_cache(p_Vid->p_sub_cache);
+
   prev_mb = FmoGetPreviousMBNr(p_Vid, mb_addr);
 
   if(use_bitstream_backing)
@@ -397,6 +419,14 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
     }
   }
 
+  // mode decision only needs the rate of the candidates; the chosen mode is coded in write_macroblock()
+  if (currSlice->symbol_mode == CABAC && p_Inp->RateEstimation)
+    set_rate_estimation(currSlice, RATE_EST_ONLY);
+
+  // log context changes of the trial encodings so the coding state can be restored cheaply
+  if (currSlice->p_RDO->ctx_journal)
+    begin_ctx_journal(currSlice);
+
   // Save the slice number of this macroblock. When the macroblock below
   // is coded it will use this to decide if prediction for above is possible
   (*currMB)->slice_nr = currSlice->slice_nr;
@@ -2654,6 +2684,21 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
   InputParameters *p_Inp = currMB->p_Inp;
   BitCounter *mbBits = &currMB->bits;
   int i;
+  int rate_est = (currSlice->symbol_mode == CABAC) ? p_Inp->RateEstimation : 0;
+  int real_bits = 0;
+
+  if (currSlice->p_RDO->ctx_journal)
+    end_ctx_journal(currSlice);
+
+  if (rate_est)
+  {
+    set_rate_estimation(currSlice, (rate_est == 2) ? RATE_EST_TRACK : RATE_EST_OFF);
+    if (rate_est == 2)
+    {
+      for (i = 0; i < currSlice->max_part_nr; ++i)
+        real_bits -= arienco_bits_written(&currSlice->partArr[i].ee_cabac);
+    }
+  }
 
   // enable writing of trace file
 #if TRACE
@@ -2699,6 +2744,25 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
   //--- write macroblock ---
   currSlice->write_MB_layer (currMB, 0, &i); // i is temporary
 
+  if (rate_est == 2)
+  {
+    // compare the table based estimate with the actually coded bits
+    int64 est_frac = 0;
+    double est_bits;
+    for (i = 0; i < currSlice->max_part_nr; ++i)
+    {
+      real_bits += arienco_bits_written(&currSlice->partArr[i].ee_cabac);
+      est_frac  += currSlice->partArr[i].ee_cabac.Efrac_bits;
+    }
+    est_bits = (double) est_frac / (double) (1 << EST_FRAC_BITS);
+
+    ++p_Vid->rate_est_mbs;
+    p_Vid->rate_est_bits    += est_bits;
+    p_Vid->rate_real_bits   += real_bits;
+    p_Vid->rate_est_abs_err += fabs(est_bits - real_bits);
+    set_rate_estimation(currSlice, RATE_EST_OFF);
+  }
+
   if (!((currMB->mb_type !=0 ) || ((currSlice->slice_type==B_SLICE) && currMB->cbp != 0) ))
   {
       reset_mb_nz_coeff(p_Vid, currMB->mbAddrX);  // CAVLC
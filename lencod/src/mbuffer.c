@@ -25,6 +25,7 @@
 #include "img_luma.h"
 #include "img_chroma.h"
 #include "errdo.h"
+#include "me_hash.h"
 
 extern void SbSMuxBasic(ImageData *imgOut, ImageData *imgIn0, ImageData *imgIn1, int offset);
 extern void init_stats                   (InputParameters *p_Inp, StatParameters *stats);
@@ -388,6 +389,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   StorablePicture *s;
   int   nplane;
   InputParameters *p_Inp = p_Vid->p_Inp;
+  MemTag prev_tag = mem_set_tag(MEM_TAG_DPB);
 
   //printf ("Allocating (%s) picture (x=%d, y=%d, x_cr=%d, y_cr=%d)\n", (type == FRAME)?"FRAME":(type == TOP_FIELD)?"TOP_FIELD":"BOTTOM_FIELD", size_x, size_y, size_x_cr, size_y_cr);
 
@@ -415,9 +417,20 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   {
     //if (p_Vid->nal_reference_idc == NALU_PRIORITY_DISPOSABLE)
     //printf("interpolate %d %d %d %d %d \n", p_Vid->active_sps->profile_idc, structure, p_Vid->nal_reference_idc, p_Vid->view_id, p_Vid->inter_view_flag[structure?structure-1: structure]);
-    //get_mem4DpelWithPad(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-    get_mem4DpelWithPadSeparately(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-    s->imgY = s->imgY_sub[0][0];
+    // reference planes, including the integer samples, are accounted as sub-pel data
+    mem_set_tag(MEM_TAG_SUBPEL);
+    if (p_Inp->InterpolationMode == INTERP_BLOCK_CACHE)
+    {
+      // only integer samples are stored; sub-pel samples are interpolated on demand
+      get_mem2DpelWithPad(&(s->imgY), size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+      s->p_sub_cache = p_Vid->p_sub_cache;
+    }
+    else
+    {
+      //get_mem4DpelWithPad(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+      s->subpel_mem_size = (int64) get_mem4DpelWithPadSeparately(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X) * 15 / 16;
+      s->imgY = s->imgY_sub[0][0];
+    }
 
      if ( p_Inp->ChromaMCBuffer || p_Vid->P444_joined || (p_Inp->yuv_format==YUV444 && !p_Vid->P444_joined))
      {
@@ -427,17 +440,17 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
         if ( p_Vid->yuv_format == YUV420 )
         {
           //get_mem5DpelWithPad(&(s->imgUV_sub), 2, 8, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 8, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+          s->subpel_mem_size += (int64) get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 8, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x) * 63 / 64;
         }
         else if ( p_Vid->yuv_format == YUV422 )
         {
           //get_mem5DpelWithPad(&(s->imgUV_sub), 2, 4, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 4, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+          s->subpel_mem_size += (int64) get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 4, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x) * 31 / 32;
         }
         else
         { // YUV444
           //get_mem5DpelWithPad(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+          s->subpel_mem_size += (int64) get_mem5DpelWithPadSeparately(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x) * 15 / 16;
         }
         s->p_img_sub[1] = s->imgUV_sub[0];
         s->p_img_sub[2] = s->imgUV_sub[1];
@@ -450,6 +463,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
      {
         get_mem3DpelWithPad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
      }
+    mem_set_tag(MEM_TAG_DPB);
   }
   else
   {
@@ -489,7 +503,9 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 
   if (p_Inp->rdopt == 3) 
   {
+	  mem_set_tag(MEM_TAG_ERRDO);
 	  errdo_alloc_storable_picture(s, p_Vid, p_Inp, size_x, size_y, size_x_cr, size_y_cr);
+	  mem_set_tag(MEM_TAG_DPB);
   }			      
 
   s->pic_num=0;
@@ -515,6 +531,13 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   s->pad_size_uv_x = p_Vid->pad_size_uv_x;
   s->pad_size_uv_y = p_Vid->pad_size_uv_y;
 
+  if (s->imgY_sub != NULL && p_Inp->InterpolationMode == INTERP_LAZY_TILES)
+  {
+    // sub-pel planes are filled tile by tile when first accessed
+    s->subpel_mem_size += alloc_subpel_tile_map(s);
+    s->p_sub_cache = p_Vid->p_sub_cache;
+  }
+
   s->top_field    = NULL;
   s->bottom_field = NULL;
   s->frame        = NULL;
@@ -523,6 +546,8 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   s->mb_aff_frame_flag = 0;
 
   init_stats(p_Inp, &s->stats);
+
+  mem_set_tag(prev_tag);
   return s;
 }
 
@@ -574,6 +599,34 @@ static void free_frame_data_memory(StorablePicture *picture, int bFreeImage)
 {
   if(picture)
   {
+    // sub-pel planes are released in both cases
+    picture->subpel_mem_size = 0;
+
+    if (picture->subpel_tile_map)
+    {
+      free(picture->subpel_tile_map);
+      picture->subpel_tile_map = NULL;
+      picture->p_sub_cache = NULL;
+    }
+
+    if (picture->sea_sum)
+    {
+      free_mem3Dint(picture->sea_sum);
+      picture->sea_sum = NULL;
+      picture->sea_plane = NULL;
+    }
+
+    if (picture->p_hme_int_img)
+    {
+      free_mem2Dpel(picture->p_hme_int_img[0]);
+      free_mem2Dpel(picture->p_hme_int_img[1]);
+      free(picture->p_hme_int_img);
+      picture->p_hme_int_img = NULL;
+      picture->hme_plane = NULL;
+    }
+
+    free_hash_table(picture);
+
     if (picture->imgY_sub)
     {
       if(bFreeImage)
@@ -679,6 +732,12 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
 
     free_frame_data_memory(p, 1);
 
+    if (p->moving_block)
+    {
+      free_mem2D(p->moving_block);
+      p->moving_block = NULL;
+    }
+
     if( (p_Inp->separate_colour_plane_flag != 0) )
     {
       int nplane;
@@ -2763,6 +2822,37 @@ static void adaptive_memory_management(DecodedPictureBuffer *p_Dpb, StorablePict
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Update the peak memory held by sub-pel reference data
+ *    (sub-pel planes of all stored pictures plus the on-demand
+ *    interpolation cache)
+ *
+ * \param p_Dpb
+ *    DecodedPictureBuffer
+ ************************************************************************
+ */
+void update_subpel_mem_peak(DecodedPictureBuffer *p_Dpb)
+{
+  VideoParameters *p_Vid = p_Dpb->p_Vid;
+  int64 mem_size = p_Vid->p_sub_cache ? p_Vid->p_sub_cache->mem_size : 0;
+  unsigned i;
+
+  for (i = 0; i < p_Dpb->used_size; ++i)
+  {
+    FrameStore *fs = p_Dpb->fs[i];
+    if (fs->frame)
+      mem_size += fs->frame->subpel_mem_size;
+    if (fs->top_field)
+      mem_size += fs->top_field->subpel_mem_size;
+    if (fs->bottom_field)
+      mem_size += fs->bottom_field->subpel_mem_size;
+  }
+
+  p_Vid->subpel_mem_peak = i64max(p_Vid->subpel_mem_peak, mem_size);
+}
+
 
 /*!
  ************************************************************************
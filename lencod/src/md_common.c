@@ -17,6 +17,8 @@
 #include "image.h"
 #include "macroblock.h"
 #include "mc_prediction.h"
+#include "transform.h"
+#include "rdopt.h"
 
 /*!
  *************************************************************************************
@@ -574,3 +576,192 @@ void set_chroma_pred_mode(Macroblock *currMB, RD_PARAMS enc_mb, int *mb_availabl
     chroma_pred_mode_range[1] = DC_PRED_8;
   }
 }
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Early SKIP/DIRECT detection. Predicts the macroblock with the skip (P slices)
+ *    or direct (B slices) motion, which must already be set, and checks whether 
+ *    all 4x4 luma transform coefficients of the residual quantize to zero at the
+ *    current QP. If so, all modes other than SKIP/DIRECT are removed from enc_mb
+ *    so that motion estimation and the remaining mode checks are bypassed.
+ *
+ * \return
+ *    TRUE if the macroblock was decided as SKIP/DIRECT
+ *************************************************************************************
+ */
+int early_skip_detection(Macroblock *currMB, RD_PARAMS *enc_mb)
+{
+  Slice *currSlice = currMB->p_Slice;
+  VideoParameters *p_Vid = currMB->p_Vid;
+  QuantParameters *p_Quant = p_Vid->p_Quant;
+  imgpel **mb_pred = currSlice->mb_pred[0];
+  imgpel **cur_img = &p_Vid->pCurImg[currMB->opix_y];
+  int    **mb_ores = currSlice->mb_ores[0];
+  int    **tblock  = currSlice->tblk16x16;
+  int   list_mode[2] = {0, 0};
+  int   pic_block_y = currMB->opix_y >> 2;
+  int   pic_block_x = currMB->pix_x  >> 2;
+  int   qp = currMB->qp_scaled[PLANE_Y];
+  int   q_bits = Q_BITS + p_Quant->qp_per_matrix[qp];
+  LevelQuantParams **q_params = p_Quant->q_params_4x4[PLANE_Y][0][qp];
+  int   block_y, block_x, i, j, mode;
+
+  // MBAFF frame macroblocks may need the skip vector to be rejected later on, lossless
+  // coding never quantizes to zero and SP slices code the skip residual
+  if (currSlice->mb_aff_frame_flag || (qp == 0 && p_Vid->lossless_qpprime_flag == 1)
+    || (currSlice->slice_type != P_SLICE && currSlice->slice_type != B_SLICE))
+    return FALSE;
+
+  ++p_Vid->early_skip_checked;
+
+  //===== skip/direct prediction =====
+  if (currSlice->slice_type == B_SLICE)
+  {
+    for (j = pic_block_y; j < pic_block_y + BLOCK_MULTIPLE; j++)
+    {
+      for (i = pic_block_x; i < pic_block_x + BLOCK_MULTIPLE; i++)
+      {
+        if (currSlice->direct_pdir[j][i] < 0)
+          return FALSE; // direct mode not allowed
+      }
+    }
+
+    for (j = 0; j < BLOCK_MULTIPLE; j++)
+    {
+      for (i = 0; i < BLOCK_MULTIPLE; i++)
+      {
+        luma_prediction (currMB, i << 2, j << 2, BLOCK_SIZE, BLOCK_SIZE, currSlice->direct_pdir[pic_block_y + j][pic_block_x + i],
+          list_mode, currSlice->direct_ref_idx[pic_block_y + j][pic_block_x + i], 0);
+      }
+    }
+  }
+  else
+  {
+    char cur_ref[2] = {0, 0};
+    luma_prediction (currMB, 0, 0, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 0, list_mode, cur_ref, 0);
+  }
+
+  //===== residual, overwritten again by the residual coding of the final mode =====
+  for (j = 0; j < MB_BLOCK_SIZE; j++)
+  {
+    for (i = 0; i < MB_BLOCK_SIZE; i++)
+      mb_ores[j][i] = cur_img[j][currMB->pix_x + i] - mb_pred[j][i];
+  }
+
+  //===== all-zero block check of the quantized 4x4 transform =====
+  for (block_y = 0; block_y < MB_BLOCK_SIZE; block_y += BLOCK_SIZE)
+  {
+    for (block_x = 0; block_x < MB_BLOCK_SIZE; block_x += BLOCK_SIZE)
+    {
+      forward4x4(mb_ores, tblock, block_y, block_x);
+      for (j = 0; j < BLOCK_SIZE; j++)
+      {
+        for (i = 0; i < BLOCK_SIZE; i++)
+        {
+          if (iabs(tblock[block_y + j][block_x + i]) * q_params[j][i].ScaleComp + q_params[j][i].OffsetComp >= (1 << q_bits))
+            return FALSE;
+        }
+      }
+    }
+  }
+
+  for (mode = 1; mode < MAXMODE; mode++)
+    enc_mb->valid[mode] = 0;
+
+  ++p_Vid->early_skip_mbs;
+
+  return TRUE;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Checks whether the motion found for one 16x8 or 8x16 partition agrees with the
+ *    16x16 motion, i.e. same prediction direction and reference and motion vectors
+ *    within one integer pel
+ *************************************************************************************
+ */
+static int coherent_partition_motion(Slice *currSlice, Block8x8Info *b8x8info, int mode, int block)
+{
+  Info8x8 *mb16x16 = &b8x8info->best[1][0];
+  Info8x8 *part    = &b8x8info->best[mode][block];
+  int j = (mode == 2) ? 2 * block : 0;
+  int i = (mode == 3) ? 2 * block : 0;
+  int list;
+
+  if (part->pdir != mb16x16->pdir || part->bipred || mb16x16->bipred)
+    return FALSE;
+
+  for (list = LIST_0; list <= LIST_1; list++)
+  {
+    if (mb16x16->pdir == 2 || mb16x16->pdir == list)
+    {
+      MotionVector *mv16 = &currSlice->all_mv[list][(int) mb16x16->ref[list]][1][0][0];
+      MotionVector *mv   = &currSlice->all_mv[list][(int) part->ref[list]][mode][j][i];
+
+      if (part->ref[list] != mb16x16->ref[list] || iabs(mv->mv_x - mv16->mv_x) + iabs(mv->mv_y - mv16->mv_y) > 4)
+        return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Fast P8x8 decision. Removes the 8x4, 4x8 and 4x4 sub-partitions from enc_mb
+ *    when 16x16 gave the lowest motion cost of the 16x16, 16x8 and 8x16 searches
+ *    and the 16x8 and 8x16 searches found the same motion as 16x16. The 8x8
+ *    partition itself is kept and still checked.
+ *************************************************************************************
+ */
+void fast_p8x8_partition_check(Macroblock *currMB, RD_PARAMS *enc_mb, distblk *mode_cost)
+{
+  Slice *currSlice = currMB->p_Slice;
+  Block8x8Info *b8x8info = currMB->p_Vid->b8x8info;
+  int mode, block;
+
+  if (!enc_mb->valid[1] || mode_cost[1] == DISTBLK_MAX)
+    return;
+
+  for (mode = 2; mode < 4; mode++)
+  {
+    if (enc_mb->valid[mode])
+    {
+      if (mode_cost[mode] < mode_cost[1])
+        return;
+      for (block = 0; block < 2; block++)
+      {
+        if (!coherent_partition_motion(currSlice, b8x8info, mode, block))
+          return;
+      }
+    }
+  }
+
+  enc_mb->valid[SMB8x4] = 0;
+  enc_mb->valid[SMB4x8] = 0;
+  enc_mb->valid[SMB4x4] = 0;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Fast P8x8 decision. Checks, after an 8x8 sub-macroblock has been decided,
+ *    whether the running P8x8 motion cost already exceeds the best cost found for
+ *    the 16x16, 16x8 and 8x16 partitions. If so, the coding state is restored
+ *    and the remaining 8x8 blocks need not be searched.
+ *
+ * \return
+ *    TRUE if the P8x8 search should be terminated
+ *************************************************************************************
+ */
+int terminate_p8x8_search(Macroblock *currMB, RD_8x8DATA *dataTr, distblk min_cost)
+{
+  if (min_cost == DISTBLK_MAX || dataTr->mb_p8x8_cost <= min_cost)
+    return FALSE;
+
+  currMB->p_Slice->reset_coding_state (currMB, currMB->p_Slice->p_RDO->cs_cm);
+  return TRUE;
+}
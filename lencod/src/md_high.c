@@ -49,6 +49,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
   distblk     bmcost[5] = {DISTBLK_MAX};
   distblk     cost=0;
   distblk     min_cost = DISTBLK_MAX;
+  distblk     mode_cost[4] = {DISTBLK_MAX, DISTBLK_MAX, DISTBLK_MAX, DISTBLK_MAX};
   int         intra1 = 0;
   int         mb_available[3];
 
@@ -62,6 +63,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
 
   char        chroma_pred_mode_range[2];
   short       inter_skip = 0;
+  int         early_skip = FALSE;
   BestMode    md_best;
   Info8x8     best;
 
@@ -101,6 +103,9 @@ void encode_one_macroblock_high (Macroblock *currMB)
         currSlice->Get_Direct_Motion_Vectors (currMB);
       else 
         FindSkipModeMotionVector (currMB);
+
+      if (p_Inp->EarlySkipDetection)
+        early_skip = early_skip_detection(currMB, &enc_mb);
     }
     if (p_Inp->CtxAdptLagrangeMult == 1)
     {
@@ -167,6 +172,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
           if (mode>1 && block == 0)
             currSlice->set_ref_and_motion_vectors (currMB, motion, &best, block);
         } // for (block=0; block<(mode==1?1:2); block++)
+        mode_cost[mode] = cost;
         if (cost < min_cost)
         {
           md_best.mode = (byte) mode;
@@ -185,6 +191,9 @@ void encode_one_macroblock_high (Macroblock *currMB)
     {    
       currMB->valid_8x8 = FALSE;
 
+      if (p_Inp->FastP8x8Decision)
+        fast_p8x8_partition_check(currMB, &enc_mb, mode_cost);
+
       if (p_Inp->Transform8x8Mode)
       {
         ResetRD8x8Data(p_Vid, p_RDO->tr8x8);
@@ -198,6 +207,11 @@ void encode_one_macroblock_high (Macroblock *currMB)
           currSlice->submacroblock_mode_decision(currMB, &enc_mb, p_RDO->tr8x8, p_RDO->cofAC8x8ts[block], block, &cost);
           if(!currMB->valid_8x8)
             break;
+          if (p_Inp->FastP8x8Decision && terminate_p8x8_search(currMB, p_RDO->tr8x8, min_cost))
+          {
+            currMB->valid_8x8 = FALSE;
+            break;
+          }
           set_subblock8x8_info(b8x8info, P8x8, block, p_RDO->tr8x8);
         } 
 
@@ -217,6 +231,11 @@ void encode_one_macroblock_high (Macroblock *currMB)
           currSlice->submacroblock_mode_decision(currMB, &enc_mb, p_RDO->tr4x4, p_RDO->coefAC8x8[block], block, &cost);
           if(!currMB->valid_4x4)
             break;
+          if (p_Inp->FastP8x8Decision && terminate_p8x8_search(currMB, p_RDO->tr4x4, min_cost))
+          {
+            currMB->valid_4x4 = FALSE;
+            break;
+          }
           set_subblock8x8_info(b8x8info, P8x8, block, p_RDO->tr4x4);
         }
       }// if (p_Inp->Transform8x8Mode != 2)
@@ -233,7 +252,14 @@ void encode_one_macroblock_high (Macroblock *currMB)
   }
 
   // Set Chroma mode
-  set_chroma_pred_mode(currMB, enc_mb, mb_available, chroma_pred_mode_range);
+  if (early_skip)
+  {
+    // only SKIP/DIRECT is left, the chroma intra mode is not used
+    chroma_pred_mode_range[0] = DC_PRED_8;
+    chroma_pred_mode_range[1] = DC_PRED_8;
+  }
+  else
+    set_chroma_pred_mode(currMB, enc_mb, mb_available, chroma_pred_mode_range);
 
   //========= C H O O S E   B E S T   M A C R O B L O C K   M O D E =========
   //-------------------------------------------------------------------------
@@ -107,6 +107,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
   distblk       bmcost[5] = {DISTBLK_MAX};
   distblk       cost=0;
   distblk       min_cost = DISTBLK_MAX;
+  distblk       mode_cost[4] = {DISTBLK_MAX, DISTBLK_MAX, DISTBLK_MAX, DISTBLK_MAX};
   int         intra1 = 0;
   int         mb_available[3];
 
@@ -266,6 +267,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
           mode16 = currMB->best_mode;
         } // if(mode == 1)
 
+        mode_cost[mode] = cost;
         if ((!inter_skip) && (cost < min_cost))
         {
           md_best.mode = (byte) mode;
@@ -284,6 +286,9 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
     {
       currMB->valid_8x8 = FALSE;
 
+      if (p_Inp->FastP8x8Decision)
+        fast_p8x8_partition_check(currMB, &enc_mb, mode_cost);
+
       if (p_Inp->Transform8x8Mode)
       {
         ResetRD8x8Data(p_Vid, p_RDO->tr8x8);
@@ -297,6 +302,11 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
           currSlice->submacroblock_mode_decision(currMB, &enc_mb, p_RDO->tr8x8, p_RDO->cofAC8x8ts[block], block, &cost);
           if(!currMB->valid_8x8)
             break;
+          if (p_Inp->FastP8x8Decision && terminate_p8x8_search(currMB, p_RDO->tr8x8, min_cost))
+          {
+            currMB->valid_8x8 = FALSE;
+            break;
+          }
           set_subblock8x8_info(b8x8info, P8x8, block, p_RDO->tr8x8);
         }
       }// if (p_Inp->Transform8x8Mode)
@@ -315,6 +325,11 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
           currSlice->submacroblock_mode_decision(currMB, &enc_mb, p_RDO->tr4x4, p_RDO->coefAC8x8[block], block, &cost);
           if(!currMB->valid_4x4)
             break;
+          if (p_Inp->FastP8x8Decision && terminate_p8x8_search(currMB, p_RDO->tr4x4, min_cost))
+          {
+            currMB->valid_4x4 = FALSE;
+            break;
+          }
           set_subblock8x8_info(b8x8info, P8x8, block, p_RDO->tr4x4);
         }
       }// if (p_Inp->Transform8x8Mode != 2)
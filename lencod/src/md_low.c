@@ -116,6 +116,15 @@ void encode_one_macroblock_low (Macroblock *currMB)
       currSlice->Get_Direct_Motion_Vectors (currMB);
     }
 
+    if (p_Inp->EarlySkipDetection && enc_mb.valid[0])
+    {
+      if (pslice)
+        FindSkipModeMotionVector (currMB);
+      // B slices pick DIRECT below, as the only mode left
+      if (early_skip_detection(currMB, &enc_mb) && pslice)
+        currMB->best_mode = 0;
+    }
+
     if (p_Inp->CtxAdptLagrangeMult == 1)
     {
       get_initial_mb16x16_cost(currMB);
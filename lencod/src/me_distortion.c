@@ -516,6 +516,287 @@ distblk computeSADWP(StorablePicture *ref1,
   return (dist_scale((distblk)mcost));
 }
 
+/*!
+************************************************************************
+* \brief
+*    Materializes the fixed prediction of a bi-predictive search.
+*    Without weights the target 2 * orig - fixed is stored, so that
+*    (target - ref) >> 1 of a candidate is exactly the difference of the
+*    original and the rounded average. With weights the weighted fixed
+*    prediction plus rounding is stored.
+*
+* \param mv_block
+*    block being searched
+* \param ref
+*    reference picture of the fixed prediction
+* \param mv
+*    padded vector of the fixed prediction
+* \param pos
+*    argument (1 or 2) of the computeBiPred functions passing the fixed
+*    prediction
+************************************************************************
+*/
+void set_bipred_target(MEBlock *mv_block, StorablePicture *ref, MotionVector *mv, int pos)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int lround = 2 * currSlice->wp_luma_round;
+  int apply_weights = mv_block->apply_weights;
+  short weight = (short) (pos == 1 ? mv_block->weight1 : mv_block->weight2);
+  short blocksize_x = mv_block->blocksize_x;
+  short blocksize_y = mv_block->blocksize_y;
+  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+  int *tgt_line = mv_block->bipred_target[0];
+  imgpel *src_line = mv_block->orig_pic[0];
+  imgpel *ref_line = UMVLine4X(ref, mv->mv_y, mv->mv_x);
+  int y, x, k;
+
+  for (y = 0; y < blocksize_y; y++)
+  {
+    if (apply_weights)
+    {
+      for (x = 0; x < blocksize_x; x++)
+        *tgt_line++ = weight * (*ref_line++) + lround;
+    }
+    else
+    {
+      for (x = 0; x < blocksize_x; x++)
+        *tgt_line++ = 2 * (*src_line++) - (*ref_line++);
+    }
+    ref_line += pad_size_x;
+  }
+
+  if ( mv_block->ChromaMEEnable ) 
+  {
+    int blocksize_x_cr = mv_block->blocksize_cr_x;
+    int blocksize_y_cr = mv_block->blocksize_cr_y;
+    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
+
+    for (k = 0; k < 2; k++)
+    {
+      weight = (short) (pos == 1 ? mv_block->weight1_cr[k] : mv_block->weight2_cr[k]);
+      tgt_line = mv_block->bipred_target[k + 1];
+      src_line = mv_block->orig_pic[k + 1];
+      ref_line = UMVLine8X_chroma (ref, k + 1, mv->mv_y, mv->mv_x);
+
+      for (y = 0; y < blocksize_y_cr; y++)
+      {
+        if (apply_weights)
+        {
+          for (x = 0; x < blocksize_x_cr; x++)
+            *tgt_line++ = weight * (*ref_line++) + lround;
+        }
+        else
+        {
+          for (x = 0; x < blocksize_x_cr; x++)
+            *tgt_line++ = 2 * (*src_line++) - (*ref_line++);
+        }
+        ref_line += cr_pad_size_x;
+      }
+      mv_block->bipred_weight_cr[k] = (short) (pos == 1 ? mv_block->weight2_cr[k] : mv_block->weight1_cr[k]);
+    }
+  }
+
+  mv_block->bipred_weight = (short) (pos == 1 ? mv_block->weight2 : mv_block->weight1);
+  mv_block->bipred_ref = ref;
+  mv_block->bipred_mv  = *mv;
+  mv_block->bipred_pos = (short) pos;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Checks whether one of the predictions of a bi-predictive candidate
+*    is the materialized fixed prediction. If so, ref1/cand1 are set to
+*    the searched prediction.
+************************************************************************
+*/
+static inline int get_bipred_candidate(MEBlock *mv_block, StorablePicture **ref1, StorablePicture *ref2, MotionVector **cand1, MotionVector *cand2)
+{
+  StorablePicture *ref = mv_block->bipred_ref;
+  MotionVector *mv = &mv_block->bipred_mv;
+
+  if (ref == NULL)
+    return 0;
+
+  if (mv_block->bipred_pos == 2)
+    return (ref2 == ref && cand2->mv_x == mv->mv_x && cand2->mv_y == mv->mv_y);
+
+  if (*ref1 == ref && (*cand1)->mv_x == mv->mv_x && (*cand1)->mv_y == mv->mv_y)
+  {
+    *ref1  = ref2;
+    *cand1 = cand2;
+    return 1;
+  }
+  return 0;
+}
+
+/*!
+************************************************************************
+* \brief
+*    BiPred SAD computation against the materialized target (no weights)
+************************************************************************
+*/
+static distblk computeBiPredTargetSAD1(StorablePicture *ref1, 
+                                       MEBlock *mv_block,
+                                       distblk min_mcost,
+                                       MotionVector *cand)
+{
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int y,x;
+  short blocksize_x = mv_block->blocksize_x;
+  short blocksize_y = mv_block->blocksize_y;
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+#if (JM_MEM_DISTORTION)
+  int *imgpel_abs = p_Vid->imgpel_abs;
+#endif
+
+  int    *tgt_line = mv_block->bipred_target[0];
+  imgpel *ref_line = UMVLine4X(ref1, cand->mv_y, cand->mv_x);
+
+  for (y = 0; y < blocksize_y; y++)
+  {
+    for (x = 0; x < blocksize_x; x+=4)
+    {
+#if (JM_MEM_DISTORTION)
+      mcost += imgpel_abs[ (*tgt_line++ - *ref_line++) >> 1 ];
+      mcost += imgpel_abs[ (*tgt_line++ - *ref_line++) >> 1 ];
+      mcost += imgpel_abs[ (*tgt_line++ - *ref_line++) >> 1 ];
+      mcost += imgpel_abs[ (*tgt_line++ - *ref_line++) >> 1 ];
+#else
+      mcost += iabs((*tgt_line++ - *ref_line++) >> 1);
+      mcost += iabs((*tgt_line++ - *ref_line++) >> 1);
+      mcost += iabs((*tgt_line++ - *ref_line++) >> 1);
+      mcost += iabs((*tgt_line++ - *ref_line++) >> 1);
+#endif
+    }
+    if(mcost > imin_cost)
+      return (dist_scale_f((distblk)mcost));
+
+    ref_line += pad_size_x;
+  }
+
+  if ( mv_block->ChromaMEEnable ) 
+  {
+    // calculate chroma conribution to motion compensation error
+    int blocksize_x_cr = mv_block->blocksize_cr_x;
+    int blocksize_y_cr = mv_block->blocksize_cr_y;
+    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int k;
+    int mcr_cost = 0;
+
+    for (k=1; k<3; k++)
+    {
+      mcr_cost = 0;
+      tgt_line = mv_block->bipred_target[k];
+      ref_line = UMVLine8X_chroma ( ref1, k, cand->mv_y, cand->mv_x);
+
+      for (y=0; y<blocksize_y_cr; y++)
+      {
+        for (x = 0; x < blocksize_x_cr; x+=2)
+        {
+          mcr_cost += iabs((*tgt_line++ - *ref_line++) >> 1);
+          mcr_cost += iabs((*tgt_line++ - *ref_line++) >> 1);
+        }        
+        ref_line += cr_pad_size_x;
+      }
+      mcost += mv_block->ChromaMEWeight * mcr_cost;
+
+      if(mcost > imin_cost)
+        return (dist_scale_f((distblk)mcost));
+    }
+  }
+
+  CHECKOVERFLOW(mcost);
+  return (dist_scale((distblk)mcost));
+}
+
+/*!
+************************************************************************
+* \brief
+*    BiPred SAD computation against the materialized weighted fixed
+*    prediction (with weights)
+************************************************************************
+*/
+static distblk computeBiPredTargetSAD2(StorablePicture *ref1, 
+                                       MEBlock *mv_block,
+                                       distblk min_mcost,
+                                       MotionVector *cand)
+{
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int denom = currSlice->luma_log_weight_denom + 1;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
+  int y,x;
+  int weighted_pel;
+  short blocksize_x = mv_block->blocksize_x;
+  short blocksize_y = mv_block->blocksize_y;
+  short weight = mv_block->bipred_weight;
+  short offsetBi = mv_block->offsetBi;
+
+  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+
+  imgpel *src_line = mv_block->orig_pic[0];
+  int    *tgt_line = mv_block->bipred_target[0];
+  imgpel *ref_line = UMVLine4X(ref1, cand->mv_y, cand->mv_x);
+
+  for (y=0; y<blocksize_y; y++)
+  {
+    for (x = 0; x < blocksize_x; x++)
+    {
+      weighted_pel = iClip1( max_imgpel_value, ((weight * (*ref_line++) + *tgt_line++) >> denom) + offsetBi);
+      mcost += iabs((*src_line++) - weighted_pel);
+    }
+
+    if(mcost > imin_cost)
+      return dist_scale_f((distblk)mcost);
+    ref_line += pad_size_x;
+  }
+
+  if ( mv_block->ChromaMEEnable ) 
+  {
+    // calculate chroma conribution to motion compensation error
+    int blocksize_x_cr = mv_block->blocksize_cr_x;
+    int blocksize_y_cr = mv_block->blocksize_cr_y;
+    int cr_pad_size_x  = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int k;
+    int mcr_cost = 0;
+    int max_imgpel_value_uv = p_Vid->max_pel_value_comp[1];
+
+    for (k=0; k<2; k++)
+    {
+      weight   = mv_block->bipred_weight_cr[k];
+      offsetBi = mv_block->offsetBi_cr[k];
+
+      mcr_cost = 0;
+      src_line = mv_block->orig_pic[k+1];
+      tgt_line = mv_block->bipred_target[k+1];
+      ref_line = UMVLine8X_chroma ( ref1, k+1, cand->mv_y, cand->mv_x);
+
+      for (y=0; y<blocksize_y_cr; y++)
+      {
+        for (x = 0; x < blocksize_x_cr; x++)
+        {
+          weighted_pel = iClip1( max_imgpel_value_uv, ((weight * (*ref_line++) + *tgt_line++) >> denom) + offsetBi);
+          mcr_cost += iabs((*src_line++) - weighted_pel);
+        }
+        ref_line += cr_pad_size_x;
+      }
+      mcost += mv_block->ChromaMEWeight * mcr_cost;
+      
+      if(mcost > imin_cost) 
+        return dist_scale_f((distblk)mcost);
+    }
+  }
+
+  CHECKOVERFLOW(mcost);
+  return dist_scale((distblk)mcost);
+}
+
 /*!
 ************************************************************************
 * \brief
@@ -545,6 +826,9 @@ distblk computeBiPredSAD1(StorablePicture *ref1,
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
 
+  if (get_bipred_candidate(mv_block, &ref1, ref2, &cand1, cand2))
+    return computeBiPredTargetSAD1(ref1, mv_block, min_mcost, cand1);
+
   for (y = 0; y < blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -650,6 +934,9 @@ distblk computeBiPredSAD2(StorablePicture *ref1,
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
 
+  if (get_bipred_candidate(mv_block, &ref1, ref2, &cand1, cand2))
+    return computeBiPredTargetSAD2(ref1, mv_block, min_mcost, cand1);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -934,6 +1221,114 @@ distblk computeSATDWP(StorablePicture *ref1,
   return dist_scale((distblk)mcost);
 }
 
+/*!
+************************************************************************
+* \brief
+*    BiPred SATD computation against the materialized target (no weights)
+************************************************************************
+*/
+static distblk computeBiPredTargetSATD1(StorablePicture *ref1, 
+                                        MEBlock *mv_block,
+                                        distblk min_mcost,
+                                        MotionVector *cand)
+{
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int y, x, y4, x4;
+  short *d, diff[MB_PIXELS];
+  int *tgt_line;
+  imgpel *ref_line;
+  short blocksize_x = mv_block->blocksize_x;
+  short blocksize_y = mv_block->blocksize_y;
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  int bs = mv_block->test8x8 ? BLOCK_SIZE_8x8 : BLOCK_SIZE;
+  int pad_size_x = p_Vid->padded_size_x - bs;
+
+  for (y = 0; y < blocksize_y; y += bs)
+  {
+    for (x = 0; x < blocksize_x; x += bs)
+    {
+      d = diff;
+      tgt_line = mv_block->bipred_target[0] + y * blocksize_x + x;
+      ref_line = UMVLine4X(ref1, cand->mv_y + (y << 2), cand->mv_x + (x << 2));
+      for (y4 = 0; y4 < bs; y4++ )
+      {
+        for (x4 = 0; x4 < bs; x4++ )
+          *d++ = (short) ((*tgt_line++ - *ref_line++) >> 1);
+
+        ref_line += pad_size_x;
+        tgt_line += blocksize_x - bs;
+      }
+      mcost += (bs == BLOCK_SIZE) ? HadamardSAD4x4 (diff) : HadamardSAD8x8 (diff);
+      if(mcost > imin_cost) 
+        return dist_scale_f((distblk)mcost);
+    }
+  }
+
+  CHECKOVERFLOW(mcost);
+  return dist_scale((distblk)mcost);
+}
+
+/*!
+************************************************************************
+* \brief
+*    BiPred SATD computation against the materialized weighted fixed
+*    prediction (with weights)
+************************************************************************
+*/
+static distblk computeBiPredTargetSATD2(StorablePicture *ref1, 
+                                        MEBlock *mv_block,
+                                        distblk min_mcost,
+                                        MotionVector *cand)
+{
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int y, x, y4, x4;
+  int weighted_pel;
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int denom = currSlice->luma_log_weight_denom + 1;
+  short weight = mv_block->bipred_weight;
+  short offsetBi = mv_block->offsetBi;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
+  short *d, diff[MB_PIXELS];
+  int *tgt_line;
+  imgpel *src_line, *ref_line;
+  short blocksize_x = mv_block->blocksize_x;
+  short blocksize_y = mv_block->blocksize_y;
+  int bs = mv_block->test8x8 ? BLOCK_SIZE_8x8 : BLOCK_SIZE;
+  int pad_size_x = p_Vid->padded_size_x - bs;
+
+  for (y = 0; y < blocksize_y; y += bs)
+  {
+    for (x = 0; x < blocksize_x; x += bs)
+    {
+      d = diff;
+      src_line = mv_block->orig_pic[0] + y * blocksize_x + x;
+      tgt_line = mv_block->bipred_target[0] + y * blocksize_x + x;
+      ref_line = UMVLine4X(ref1, cand->mv_y + (y << 2), cand->mv_x + (x << 2));
+      for (y4 = 0; y4 < bs; y4++ )
+      {
+        for (x4 = 0; x4 < bs; x4++ )
+        {
+          weighted_pel = iClip1( max_imgpel_value, ((weight * (*ref_line++) + *tgt_line++) >> denom) + offsetBi);
+          *d++ = (short) ((*src_line++) - weighted_pel);
+        }
+
+        ref_line += pad_size_x;
+        tgt_line += blocksize_x - bs;
+        src_line += blocksize_x - bs;
+      }
+      mcost += (bs == BLOCK_SIZE) ? HadamardSAD4x4 (diff) : HadamardSAD8x8 (diff);
+      if(mcost > imin_cost) 
+        return dist_scale_f((distblk)mcost);
+    }
+  }
+
+  CHECKOVERFLOW(mcost);
+  return dist_scale((distblk)mcost);
+}
+
 /*!
 ************************************************************************
 * \brief
@@ -958,6 +1353,9 @@ distblk computeBiPredSATD1(StorablePicture *ref1,
   short blocksize_y = mv_block->blocksize_y;
   VideoParameters *p_Vid = mv_block->p_Vid;
 
+  if (get_bipred_candidate(mv_block, &ref1, ref2, &cand1, cand2))
+    return computeBiPredTargetSATD1(ref1, mv_block, min_mcost, cand1);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = (blocksize_x - BLOCK_SIZE);
@@ -1063,6 +1461,9 @@ distblk computeBiPredSATD2(StorablePicture *ref1,
   short blocksize_x = mv_block->blocksize_x;
   short blocksize_y = mv_block->blocksize_y;
 
+  if (get_bipred_candidate(mv_block, &ref1, ref2, &cand1, cand2))
+    return computeBiPredTargetSATD2(ref1, mv_block, min_mcost, cand1);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = (blocksize_x - BLOCK_SIZE);
@@ -202,6 +202,7 @@ EPZSPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
         if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
         {
           EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
           cand = pad_MVs (tmv, mv_block);
 
           //--- set motion cost (cost for motion vector) and check ---
@@ -229,6 +230,8 @@ EPZSPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
             checkMedian = TRUE;
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
     }
 
@@ -277,6 +280,7 @@ EPZSPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
               if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
               {
                 EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand = pad_MVs (tmv, mv_block);
 
                 mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
@@ -293,6 +297,8 @@ EPZSPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
@@ -523,6 +529,7 @@ EPZSPelBlockMotionSearchSubMB (Macroblock * currMB,     // <--  current Macroblo
         if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
         {
           EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
 
           cand = pad_MVs (tmv, mv_block);
 
@@ -551,6 +558,8 @@ EPZSPelBlockMotionSearchSubMB (Macroblock * currMB,     // <--  current Macroblo
             checkMedian = TRUE;
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
 
       // At this point, let us add an early termination criterion
@@ -611,6 +620,7 @@ EPZSPelBlockMotionSearchSubMB (Macroblock * currMB,     // <--  current Macroblo
               if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
               {
                 EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand = pad_MVs(tmv, mv_block);
 
                 mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
@@ -627,6 +637,8 @@ EPZSPelBlockMotionSearchSubMB (Macroblock * currMB,     // <--  current Macroblo
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
@@ -810,6 +822,7 @@ EPZSBiPredBlockMotionSearch (Macroblock * currMB,     // <--  Current Macroblock
         if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
         {
           EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
 
           cand1 = pad_MVs (tmv, mv_block);
 
@@ -839,6 +852,8 @@ EPZSBiPredBlockMotionSearch (Macroblock * currMB,     // <--  Current Macroblock
             checkMedian = TRUE;
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
     }
 
@@ -887,6 +902,7 @@ EPZSBiPredBlockMotionSearch (Macroblock * currMB,     // <--  Current Macroblock
               if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
               {
                 EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand1 = pad_MVs (tmv, mv_block);
 
                 mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
@@ -904,6 +920,8 @@ EPZSBiPredBlockMotionSearch (Macroblock * currMB,     // <--  Current Macroblock
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
@@ -40,6 +40,8 @@ static const char EPZS_FIXED_PREDICTORS[3][20] = { "Disabled", "All P", "All P +
 static const char EPZS_OTHER_PREDICTORS[2][20] = { "Disabled", "Enabled" };
 static const char EPZS_SUBPEL_METHOD[3][20]    = { "Full", "Basic", "Enhanced" };
 
+static void freeEPZScolocated (EPZSColocParams * p);
+
 //! Define EPZS Refinement patterns
 static const short pattern_data[5][12][4] =
 {
@@ -213,6 +215,9 @@ EPZSDelete (VideoParameters * p_Vid)
   freeEPZSpattern (p_Vid->ediamond);
   freeEPZSpattern (p_Vid->sdiamond);
   freeEPZSpattern (p_Vid->square);
+
+  freeEPZScolocated (p_Vid->p_epzs_coloc);
+  p_Vid->p_epzs_coloc = NULL;
 }
 
 /*!
@@ -432,8 +437,14 @@ EPZSStructInit (Slice * currSlice)
 #endif
   }
 
+  //! The co-located vectors are shared by all slices and only recomputed
+  //! when a slice needs them for a different picture or reference set
   if (p_Inp->EPZSTemporal)
-    p_EPZS->p_colocated = allocEPZScolocated (p_Vid->width, p_Vid->height, p_Vid->active_sps->mb_adaptive_frame_field_flag);
+  {
+    if (p_Vid->p_epzs_coloc == NULL)
+      p_Vid->p_epzs_coloc = allocEPZScolocated (p_Vid->width, p_Vid->FrameHeightInMbs * MB_BLOCK_SIZE, p_Vid->active_sps->mb_adaptive_frame_field_flag);
+    p_EPZS->p_colocated = p_Vid->p_epzs_coloc;
+  }
 
   switch (p_Inp->EPZSPattern)
   {
@@ -495,8 +506,6 @@ EPZSStructDelete (Slice * currSlice)
 {
   InputParameters *p_Inp = currSlice->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
-  if (p_Inp->EPZSTemporal)
-    freeEPZScolocated (p_EPZS->p_colocated);
 
   //free_offset_mem2Dshort(EPZSMap, searcharray, (searcharray>>1), (searcharray>>1));
   free_mem2Dshort ((short **) p_EPZS->EPZSMap);
@@ -523,6 +532,48 @@ EPZSStructDelete (Slice * currSlice)
   currSlice->p_EPZS = NULL;
 }
 
+/*!
+************************************************************************
+* \brief
+*    Stores the slice parameters the co-located vectors depend on
+*
+* \return
+*    TRUE if they differ from those the vectors were computed for
+************************************************************************
+*/
+static int
+update_colocated_key (Slice * currSlice, EPZSColocParams * p, int list)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  StorablePicture *p_Pic = p_Vid->enc_picture;
+  EPZSColocKey key;
+  int j, i;
+
+  memset (&key, 0, sizeof (EPZSColocKey));
+  key.pic               = p_Pic;
+  key.frame_no          = p_Vid->frame_no;
+  key.poc               = p_Pic->poc;
+  key.top_poc           = p_Pic->top_poc;
+  key.bottom_poc        = p_Pic->bottom_poc;
+  key.structure         = currSlice->structure;
+  key.mb_aff_frame_flag = currSlice->mb_aff_frame_flag;
+  key.list              = list;
+  key.num_ref_idx_active = currSlice->num_ref_idx_active[LIST_0];
+
+  for (j = LIST_0; j < 2 + (currSlice->mb_aff_frame_flag << 2); ++j)
+  {
+    key.list_size[j] = currSlice->listXsize[j];
+    for (i = 0; i < currSlice->listXsize[j]; ++i)
+      key.ref[j][i] = currSlice->listX[j][i];
+  }
+
+  if (memcmp (&key, &p->key, sizeof (EPZSColocKey)) == 0)
+    return FALSE;
+
+  memcpy (&p->key, &key, sizeof (EPZSColocKey));
+  return TRUE;
+}
+
 //! For ME purposes restricting the co-located partition is not necessary.
 /*!
 ************************************************************************
@@ -585,7 +636,7 @@ EPZSSliceInit (Slice * currSlice)
     }
   }
 
-  if (p_Inp->EPZSTemporal)
+  if (p_Inp->EPZSTemporal && update_colocated_key (currSlice, p, list))
   {
     MotionVector **MotionVector0 = p->frame[LIST_0];
     MotionVector **MotionVector1 = p->frame[LIST_1];
@@ -1708,7 +1759,7 @@ EPZSDetermineStopCriterion (EPZSParameters * p_EPZS, distblk *prevSad, MEBlock *
 ***********************************************************************
 */
 void
-EPZSOutputStats (InputParameters * p_Inp, FILE * stat, short stats_file)
+EPZSOutputStats (VideoParameters * p_Vid, InputParameters * p_Inp, FILE * stat, short stats_file)
 {
   if (stats_file == 1)
   {
@@ -1720,6 +1771,7 @@ EPZSOutputStats (InputParameters * p_Inp, FILE * stat, short stats_file)
     fprintf (stat, " EPZS Threshold Multipliers   : (%d %d %d)\n", p_Inp->EPZSMedThresScale, p_Inp->EPZSMinThresScale, p_Inp->EPZSMaxThresScale);
     fprintf (stat, " EPZS Subpel ME               : %s\n", EPZS_SUBPEL_METHOD[p_Inp->EPZSSubPelME]);
     fprintf (stat, " EPZS Subpel ME BiPred        : %s\n", EPZS_SUBPEL_METHOD[p_Inp->EPZSSubPelMEBiPred]);
+    EPZSOutputSearchStats (p_Vid, stat, stats_file);
   }
   else
   {
@@ -1731,5 +1783,33 @@ EPZSOutputStats (InputParameters * p_Inp, FILE * stat, short stats_file)
     fprintf (stat, " EPZS Threshold Multipliers        : (%d %d %d)\n", p_Inp->EPZSMedThresScale, p_Inp->EPZSMinThresScale, p_Inp->EPZSMaxThresScale);
     fprintf (stat, " EPZS Subpel ME                    : %s\n", EPZS_SUBPEL_METHOD[p_Inp->EPZSSubPelME]);
     fprintf (stat, " EPZS Subpel ME BiPred             : %s\n", EPZS_SUBPEL_METHOD[p_Inp->EPZSSubPelMEBiPred]);
+    EPZSOutputSearchStats (p_Vid, stat, stats_file);
   }
 }
+
+/*!
+***********************************************************************
+* \brief
+*    Reports the integer pel positions the EPZS block searches did not
+*    cost again because the search map marked them as already visited
+***********************************************************************
+*/
+void
+EPZSOutputSearchStats (VideoParameters * p_Vid, FILE * stat, short stats_file)
+{
+  int64 revisits = p_Vid->epzs_pred_revisits + p_Vid->epzs_pattern_revisits;
+
+  if (p_Vid->epzs_evaluated == 0)
+    return;
+
+  if (stats_file == 1)
+    fprintf (stat, " EPZS Saved Evaluations       : %.2f %% (predictors %.2f %%, pattern %.2f %%)\n",
+      100.0 * (double) revisits / (double) (p_Vid->epzs_evaluated + revisits),
+      100.0 * (double) p_Vid->epzs_pred_revisits / (double) (p_Vid->epzs_evaluated + revisits),
+      100.0 * (double) p_Vid->epzs_pattern_revisits / (double) (p_Vid->epzs_evaluated + revisits));
+  else
+    fprintf (stat, " EPZS Saved Evaluations            : %.2f %% (predictors %.2f %%, pattern %.2f %%)\n",
+      100.0 * (double) revisits / (double) (p_Vid->epzs_evaluated + revisits),
+      100.0 * (double) p_Vid->epzs_pred_revisits / (double) (p_Vid->epzs_evaluated + revisits),
+      100.0 * (double) p_Vid->epzs_pattern_revisits / (double) (p_Vid->epzs_evaluated + revisits));
+}
@@ -218,6 +218,7 @@ EPZSIntPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
         if (*EPZSPoint != p_EPZS->BlkCount)
         {
           *EPZSPoint = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
           cand = pad_MVs (tmv, mv_block);
 
           //--- set motion cost (cost for motion vector) and check ---
@@ -245,6 +246,8 @@ EPZSIntPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
             }
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
     }
 
@@ -314,6 +317,7 @@ EPZSIntPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
               if (*EPZSPoint != p_EPZS->BlkCount)
               {
                 *EPZSPoint = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand = pad_MVs (tmv, mv_block);
 
                 mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
@@ -330,6 +334,8 @@ EPZSIntPelBlockMotionSearch (Macroblock * currMB,     // <--  current Macroblock
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
@@ -568,6 +574,7 @@ EPZSIntPelBlockMotionSearchSubMB (Macroblock * currMB,    // <--  current Macrob
         if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
         {
           EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
 
           cand = pad_MVs (tmv, mv_block);
 
@@ -596,6 +603,8 @@ EPZSIntPelBlockMotionSearchSubMB (Macroblock * currMB,    // <--  current Macrob
             }
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
 
       if ((ref > 0 && currSlice->structure == FRAME) && (*prevSad * 3 < min_mcost))
@@ -670,6 +679,7 @@ EPZSIntPelBlockMotionSearchSubMB (Macroblock * currMB,    // <--  current Macrob
               if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
               {
                 EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand = pad_MVs(tmv, mv_block);
 
                 mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
@@ -686,6 +696,8 @@ EPZSIntPelBlockMotionSearchSubMB (Macroblock * currMB,    // <--  current Macrob
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
@@ -871,6 +883,7 @@ EPZSIntBiPredBlockMotionSearch (Macroblock * currMB,      // <--  Current Macrob
         if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
         {
           EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+          ++p_Vid->epzs_evaluated;
 
           cand1 = pad_MVs (tmv, mv_block);
 
@@ -900,6 +913,8 @@ EPZSIntBiPredBlockMotionSearch (Macroblock * currMB,      // <--  Current Macrob
             checkMedian = TRUE;
           }
         }
+        else
+          ++p_Vid->epzs_pred_revisits;
       }
     }
 
@@ -948,6 +963,7 @@ EPZSIntBiPredBlockMotionSearch (Macroblock * currMB,      // <--  Current Macrob
               if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
               {
                 EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+                ++p_Vid->epzs_evaluated;
                 cand1 = pad_MVs (tmv, mv_block);
 
                 mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
@@ -965,6 +981,8 @@ EPZSIntBiPredBlockMotionSearch (Macroblock * currMB,      // <--  Current Macrob
                   }
                 }
               }
+              else
+                ++p_Vid->epzs_pattern_revisits;
             }
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
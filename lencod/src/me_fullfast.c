@@ -29,8 +29,55 @@
 #include "conformance.h"
 #include "mv_search.h"
 
+#if defined(__SSE2__) && (IMGTYPE == 1) && !(JM_MEM_DISTORTION)
+#define FAST_FULL_SAD_SSE2 1
+#include <emmintrin.h>
+#endif
+
 
 // Functions
+#if (FAST_FULL_SAD_SSE2)
+/*!
+ ***********************************************************************
+ * \brief
+ *    SAD of the four 4x4 blocks in one 16x4 band of the macroblock for a
+ *    single search position (16 bit samples of at most 14 bits)
+ ***********************************************************************
+ */
+static inline void sad_16x4_band_sse2(imgpel *refptr, imgpel *srcptr, int ref_stride, distpel **block_sad, int pos)
+{
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  __m128i even, odd;
+  int sad[4];
+  int y;
+
+  for (y = 0; y < 4; y++)
+  {
+    __m128i r0 = _mm_loadu_si128((const __m128i *) refptr);
+    __m128i r1 = _mm_loadu_si128((const __m128i *) (refptr + 8));
+    __m128i o0 = _mm_loadu_si128((const __m128i *) srcptr);
+    __m128i o1 = _mm_loadu_si128((const __m128i *) (srcptr + 8));
+
+    // |r - o| as max - min, then pairwise sums widened to 32 bit
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_sub_epi16(_mm_max_epi16(r0, o0), _mm_min_epi16(r0, o0)), ones));
+    acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_sub_epi16(_mm_max_epi16(r1, o1), _mm_min_epi16(r1, o1)), ones));
+    refptr += ref_stride;
+    srcptr += MB_BLOCK_SIZE;
+  }
+
+  even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(acc0), _mm_castsi128_ps(acc1), _MM_SHUFFLE(2, 0, 2, 0)));
+  odd  = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(acc0), _mm_castsi128_ps(acc1), _MM_SHUFFLE(3, 1, 3, 1)));
+  _mm_storeu_si128((__m128i *) sad, _mm_add_epi32(even, odd));
+
+  block_sad[0][pos] = (distpel) sad[0];
+  block_sad[1][pos] = (distpel) sad[1];
+  block_sad[2][pos] = (distpel) sad[2];
+  block_sad[3][pos] = (distpel) sad[3];
+}
+#endif
+
 /*!
  ***********************************************************************
  * \brief
@@ -284,6 +331,10 @@ void SetupFastFullPelSearch (Macroblock *currMB, MEBlock *mv_block, int list)  /
   distblk  LineSadBlk0, LineSadBlk1, LineSadBlk2, LineSadBlk3;
   PixelPos block[4];  // neighbor blocks
   MEFullFast *p_me_ffast = p_Vid->p_ffast_me;
+  int     num_threads   = p_Inp->FastFullSearchThreads;
+#if (FAST_FULL_SAD_SSE2)
+  int     use_simd      = (p_Inp->MEErrorMetric[0] == ERROR_SAD) && (p_Vid->max_imgpel_value < 16384);
+#endif
 
 
   short ref = mv_block->ref_idx;
@@ -383,6 +434,10 @@ void SetupFastFullPelSearch (Macroblock *currMB, MEBlock *mv_block, int list)  /
       offset_cr[1] = currSlice->wp_offset[list + list_offset][ref][2];
     }
 
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(num_threads) if (num_threads > 1) schedule(static) \
+  private(cand, srcptr, refptr, bindex, blky, x, y, k, LineSadBlk0, LineSadBlk1, LineSadBlk2, LineSadBlk3, weighted_pel)
+#endif
     for (pos = 0; pos < max_pos; pos++)
     {
       cand = add_MVs(offset, &p_Vid->spiral_qpel_search[pos]);      
@@ -489,6 +544,10 @@ void SetupFastFullPelSearch (Macroblock *currMB, MEBlock *mv_block, int list)  /
   }
   else
   {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(num_threads) if (num_threads > 1) schedule(static) \
+  private(cand, srcptr, refptr, bindex, blky, x, y, k, LineSadBlk0, LineSadBlk1, LineSadBlk2, LineSadBlk3)
+#endif
     for (pos = 0; pos < max_pos; pos++)
     {
       cand = add_MVs(offset, &p_Vid->spiral_qpel_search[pos]);
@@ -497,6 +556,19 @@ void SetupFastFullPelSearch (Macroblock *currMB, MEBlock *mv_block, int list)  /
 
       refptr = UMVLine4X (ref_picture, cand.mv_y, cand.mv_x);
 
+#if (FAST_FULL_SAD_SSE2)
+      if (use_simd)
+      {
+        for (blky = 0; blky < 4; blky++)
+        {
+          sad_16x4_band_sse2(refptr, srcptr, p_Vid->padded_size_x, &block_sad[bindex], pos);
+          bindex += 4;
+          srcptr += 4 * MB_BLOCK_SIZE;
+          refptr += 4 * p_Vid->padded_size_x;
+        }
+      }
+      else
+#endif
       for (blky = 0; blky < 4; blky++)
       {
         LineSadBlk0 = LineSadBlk1 = LineSadBlk2 = LineSadBlk3 = 0;
@@ -29,10 +29,108 @@
 #include "mv_search.h"
 
 // Functions
+/*!
+ ***********************************************************************
+ * \brief
+ *    Computes the sums of all 4x4, 8x8 and 16x16 blocks of the padded
+ *    int-pel plane of a reference picture for successive elimination.
+ *    The sums are kept with the picture and only recomputed when the
+ *    plane used for motion estimation changes (4:4:4 independent coding).
+ ***********************************************************************
+ */
+static void get_sea_block_sums(StorablePicture *ref)
+{
+  imgpel **img = ref->p_curr_img;
+  int size_y = ref->size_y_padded;
+  int size_x = ref->size_x_padded;
+  int **sum;
+  int y, x, level;
+
+  if (ref->sea_plane == img)
+    return;
+
+  if (ref->sea_sum == NULL)
+  {
+    MemTag prev_tag = mem_set_tag(MEM_TAG_ME);
+    get_mem3Dint(&ref->sea_sum, 3, size_y, size_x);
+    mem_set_tag(prev_tag);
+  }
+  sum = ref->sea_sum[0];
+
+  // horizontal sums of 4 pels for every line
+  for (y = 0; y < size_y; y++)
+  {
+    imgpel *line = &img[y - IMG_PAD_SIZE_Y][-IMG_PAD_SIZE_X];
+    int    *s    = sum[y];
+    int     acc  = line[0] + line[1] + line[2];
+
+    for (x = 0; x < size_x - 3; x++)
+    {
+      acc += line[x + 3];
+      s[x] = acc;
+      acc -= line[x];
+    }
+  }
+
+  // vertical sums of 4 lines, done in place from the top
+  for (y = 0; y < size_y - 3; y++)
+  {
+    for (x = 0; x < size_x - 3; x++)
+      sum[y][x] += sum[y + 1][x] + sum[y + 2][x] + sum[y + 3][x];
+  }
+
+  // 8x8 and 16x16 sums from four blocks of the previous size
+  for (level = 1; level < 3; level++)
+  {
+    int **prev = ref->sea_sum[level - 1];
+    int   half = BLOCK_SIZE << (level - 1);
+    int   size = BLOCK_SIZE << level;
+
+    sum = ref->sea_sum[level];
+    for (y = 0; y <= size_y - size; y++)
+    {
+      for (x = 0; x <= size_x - size; x++)
+        sum[y][x] = prev[y][x] + prev[y][x + half] + prev[y + half][x] + prev[y + half][x + half];
+    }
+  }
+
+  ref->sea_plane = img;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Successive elimination bound of a candidate: sum of the absolute
+ *    differences between the sub-block sums of the original and of the
+ *    reference block at (pos_y, pos_x)
+ ***********************************************************************
+ */
+static inline int sea_bound(int **ref_sum, int orig_sum[4][4], int pos_y, int pos_x, int blk_y, int blk_x, int size)
+{
+  int bound = 0;
+  int bx, by;
+
+  for (by = 0; by < blk_y; by++)
+  {
+    int *s = &ref_sum[pos_y + by * size][pos_x];
+    for (bx = 0; bx < blk_x; bx++)
+      bound += iabs(orig_sum[by][bx] - s[bx * size]);
+  }
+  return bound;
+}
+
 /*!
  ***********************************************************************
  * \brief
  *    Full pixel block motion search
+ *
+ *    When the integer pel metric is SAD, candidates are first checked
+ *    against successive elimination bounds: the sum over sub-blocks of
+ *    the partition of |sum(orig) - sum(ref)| can not exceed the SAD, so
+ *    a candidate whose bound already reaches the best cost is dropped
+ *    without computing the SAD. The bound is checked with the largest
+ *    square sub-blocks first and then with 4x4 sub-blocks. The search
+ *    result is identical to the exhaustive search.
  ***********************************************************************
  */
 distblk                                                //  ==> minimum motion cost after search
@@ -59,11 +157,57 @@ FullPelBlockMotionSearch (Macroblock   *currMB ,       // <--  current Macrobloc
 
   MotionVector *mv    = &mv_block->mv[(short) mv_block->list];
   int   check_for_00  = (mv_block->blocktype==1 && !p_Inp->rdopt && currSlice->slice_type!=B_SLICE && ref==0);
+  int   use_sea;
+  int   blk_x = mv_block->blocksize_x >> 2;
+  int   blk_y = mv_block->blocksize_y >> 2;
+  int   sea_level = (blk_x == 4 && blk_y == 4) ? 2 : (blk_x >= 2 && blk_y >= 2) ? 1 : 0;
+  int   orig_sum[3][4][4];
+  int **coarse_sum = NULL, **fine_sum = NULL;
+  int64 sea_checked = 0, sea_skipped = 0;
   center.mv_x      = mv_block->pos_x_padded + mv->mv_x;                        // center position x (in pel units)
   center.mv_y      = mv_block->pos_y_padded + mv->mv_y;                        // center position y (in pel units)
   pred.mv_x        = mv_block->pos_x_padded + pred_mv->mv_x;       // predicted position x (in sub-pel units)
   pred.mv_y        = mv_block->pos_y_padded + pred_mv->mv_y;       // predicted position y (in sub-pel units)
-  
+
+  use_sea = p_Inp->FullSearchSEA && mv_block->computePredFPel == computeSAD
+    && ((center.mv_x | center.mv_y) & 0x03) == 0;
+
+  if (use_sea)
+  {
+    imgpel *orig = mv_block->orig_pic[0];
+    int bx, by, i, j;
+
+    get_sea_block_sums(ref_picture);
+    coarse_sum = ref_picture->sea_sum[sea_level];
+    fine_sum   = ref_picture->sea_sum[0];
+
+    for (by = 0; by < blk_y; by++)
+    {
+      for (bx = 0; bx < blk_x; bx++)
+      {
+        imgpel *line = &orig[(by << 2) * mv_block->blocksize_x + (bx << 2)];
+        int s = 0;
+        for (j = 0; j < BLOCK_SIZE; j++, line += mv_block->blocksize_x)
+        {
+          for (i = 0; i < BLOCK_SIZE; i++)
+            s += line[i];
+        }
+        orig_sum[0][by][bx] = s;
+      }
+    }
+
+    for (i = 1; i <= sea_level; i++)
+    {
+      for (by = 0; by < (blk_y >> i); by++)
+      {
+        for (bx = 0; bx < (blk_x >> i); bx++)
+        {
+          orig_sum[i][by][bx] = orig_sum[i - 1][2 * by][2 * bx] + orig_sum[i - 1][2 * by][2 * bx + 1]
+            + orig_sum[i - 1][2 * by + 1][2 * bx] + orig_sum[i - 1][2 * by + 1][2 * bx + 1];
+        }
+      }
+    }
+  }
 
   //===== loop over all search positions =====
   for (pos=0; pos<max_pos; pos++)
@@ -82,6 +226,21 @@ FullPelBlockMotionSearch (Macroblock   *currMB ,       // <--  current Macrobloc
     }
     if (mcost >= min_mcost)   continue;
 
+    if (use_sea)
+    {
+      // same clipping of the block position as UMVLine4X
+      int pos_y = iClip3(-IMG_PAD_SIZE_Y, ref_picture->size_y_pad, cand.mv_y >> 2) + IMG_PAD_SIZE_Y;
+      int pos_x = iClip3(-IMG_PAD_SIZE_X, ref_picture->size_x_pad, cand.mv_x >> 2) + IMG_PAD_SIZE_X;
+
+      ++sea_checked;
+      if (mcost + dist_scale((distblk) sea_bound(coarse_sum, orig_sum[sea_level], pos_y, pos_x, blk_y >> sea_level, blk_x >> sea_level, BLOCK_SIZE << sea_level)) >= min_mcost
+        || (sea_level && mcost + dist_scale((distblk) sea_bound(fine_sum, orig_sum[0], pos_y, pos_x, blk_y, blk_x, BLOCK_SIZE)) >= min_mcost))
+      {
+        ++sea_skipped;
+        continue;
+      }
+    }
+
     //--- add residual cost to motion cost ---
     mcost += mv_block->computePredFPel(ref_picture, mv_block, min_mcost - mcost, &cand);
 
@@ -94,6 +253,9 @@ FullPelBlockMotionSearch (Macroblock   *currMB ,       // <--  current Macrobloc
   }
 
 
+  p_Vid->sea_candidates += sea_checked;
+  p_Vid->sea_eliminated += sea_skipped;
+
   //===== set best motion vector and return minimum motion cost =====
   if (best_pos)
   {
@@ -0,0 +1,317 @@
+
+/*!
+ *************************************************************************************
+ * \file me_hash.c
+ *
+ * \brief
+ *    Hash based exact match motion search
+ *
+ *    When a reference picture enters the DPB, every 8x8 luma block of its source
+ *    picture is hashed at every integer position into a bucket chained table.
+ *    The bucket depends on the hash and on the band of 64 lines of the position.
+ *    After the integer pel search a block looks up the hashes of its 8x8 blocks
+ *    (or of the 8x8 block it belongs to), takes the matching position with the
+ *    lowest vector cost and keeps it if its cost on the reconstructed reference
+ *    is lower than the search result. Bands are visited starting from the one
+ *    of the predicted position, so that the limited number of checked matches
+ *    are the ones closest to the predictor in repetitive content. Copied or
+ *    scrolled areas of screen content are then found independently of the
+ *    search range.
+ *************************************************************************************
+ */
+
+#include "contributors.h"
+
+#include "global.h"
+#include "memalloc.h"
+#include "mv_search.h"
+#include "me_hash.h"
+
+#define HASH_ROW_MULT  0x9E3779B1u   //!< multiplier along a line
+#define HASH_COL_MULT  0x01000193u   //!< multiplier across lines
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hash of the 8x8 block at (x, y) of a plane. Gives the same value
+ *    as the rolling computation of get_hash_table().
+ ************************************************************************
+ */
+static unsigned int block_hash(imgpel **img, int y, int x)
+{
+  unsigned int hash = 0;
+  int i, j;
+
+  for (j = 0; j < HASH_ME_BLOCK; j++)
+  {
+    unsigned int row = 0;
+    imgpel *line = &img[y + j][x];
+
+    for (i = 0; i < HASH_ME_BLOCK; i++)
+      row = row * HASH_ROW_MULT + line[i];
+    hash = hash * HASH_COL_MULT + row;
+  }
+  return hash;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns TRUE if all pels of the 8x8 block at (x, y) are equal.
+ *    Such blocks match almost everywhere in flat areas and are left
+ *    to the regular search.
+ ************************************************************************
+ */
+static int is_flat_block(imgpel **img, int y, int x)
+{
+  imgpel value = img[y][x];
+  int i, j;
+
+  for (j = 0; j < HASH_ME_BLOCK; j++)
+  {
+    imgpel *line = &img[y + j][x];
+    for (i = 0; i < HASH_ME_BLOCK; i++)
+    {
+      if (line[i] != value)
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static inline int hash_bucket(unsigned int hash, int band)
+{
+  hash += (unsigned int) band * HASH_ROW_MULT;
+  return (int) ((hash ^ (hash >> 16)) & (HASH_ME_BUCKETS - 1));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the hash table of a reference picture from its source
+ *    picture, which is still the current input when the picture is
+ *    stored in the DPB
+ ************************************************************************
+ */
+void get_hash_table(VideoParameters *p_Vid, StorablePicture *s)
+{
+  HashMETable *table = s->p_hash_table;
+  imgpel **img;
+  int width  = s->size_x - HASH_ME_BLOCK + 1;
+  int height = s->size_y - HASH_ME_BLOCK + 1;
+  unsigned int row_pow = 1;
+  unsigned int **hash;
+  int x, y, k;
+
+  if (s->structure == FRAME)
+    img = p_Vid->imgData.frm_data[0];
+  else
+    img = (s->structure == TOP_FIELD) ? p_Vid->imgData.top_data[0] : p_Vid->imgData.bot_data[0];
+
+  if (table == NULL)
+  {
+    MemTag prev_tag = mem_set_tag(MEM_TAG_ME);
+    if ((table = (HashMETable *) calloc(1, sizeof(HashMETable))) == NULL)
+      no_mem_exit("get_hash_table: table");
+    if ((table->head = (int *) malloc(HASH_ME_BUCKETS * sizeof(int))) == NULL)
+      no_mem_exit("get_hash_table: head");
+    // all lines hold the horizontal hashes before the vertical pass
+    get_mem2Dint(&table->hash, s->size_y, width);
+    get_mem2Dint(&table->next, height, width);
+    mem_set_tag(prev_tag);
+    table->width  = width;
+    table->height = height;
+    table->bands  = (height + (1 << HASH_ME_BAND_SHIFT) - 1) >> HASH_ME_BAND_SHIFT;
+    s->p_hash_table = table;
+  }
+  hash = (unsigned int **) table->hash;
+
+  for (k = 1; k < HASH_ME_BLOCK; k++)
+    row_pow *= HASH_ROW_MULT;
+
+  // rolling hash of 8 pels for every line
+  for (y = 0; y < s->size_y; y++)
+  {
+    imgpel *line = img[y];
+    unsigned int *h = hash[y];
+    unsigned int acc = 0;
+
+    for (x = 0; x < HASH_ME_BLOCK; x++)
+      acc = acc * HASH_ROW_MULT + line[x];
+    h[0] = acc;
+    for (x = 1; x < width; x++)
+    {
+      acc = (acc - line[x - 1] * row_pow) * HASH_ROW_MULT + line[x + HASH_ME_BLOCK - 1];
+      h[x] = acc;
+    }
+  }
+
+  // combine 8 lines, done in place from the top
+  for (y = 0; y < height; y++)
+  {
+    for (x = 0; x < width; x++)
+    {
+      unsigned int acc = 0;
+      for (k = 0; k < HASH_ME_BLOCK; k++)
+        acc = acc * HASH_COL_MULT + hash[y + k][x];
+      hash[y][x] = acc;
+    }
+  }
+
+  for (k = 0; k < HASH_ME_BUCKETS; k++)
+    table->head[k] = -1;
+
+  for (y = 0; y < height; y++)
+  {
+    for (x = 0; x < width; x++)
+    {
+      if (is_flat_block(img, y, x))
+      {
+        table->next[y][x] = -1;
+      }
+      else
+      {
+        int bucket = hash_bucket(hash[y][x], y >> HASH_ME_BAND_SHIFT);
+        table->next[y][x] = table->head[bucket];
+        table->head[bucket] = y * width + x;
+      }
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the hash table of a reference picture
+ ************************************************************************
+ */
+void free_hash_table(StorablePicture *s)
+{
+  HashMETable *table = s->p_hash_table;
+
+  if (table)
+  {
+    free_mem2Dint(table->hash);
+    free_mem2Dint(table->next);
+    free(table->head);
+    free(table);
+    s->p_hash_table = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Looks up the block in the hash table of its reference and replaces
+ *    the integer pel search result by the matching position with the
+ *    lowest vector cost if that has the lower motion cost. The bands are
+ *    searched in the order of their distance to the predicted position.
+ *
+ * \return
+ *    the minimum motion cost
+ ************************************************************************
+ */
+distblk hash_me_search(Macroblock *currMB, MEBlock *mv_block, MotionVector *pred, distblk min_mcost, int lambda_factor)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int list = mv_block->list;
+  StorablePicture *ref_picture = currMB->p_Slice->listX[list + currMB->list_offset][(short) mv_block->ref_idx];
+  HashMETable *table = ref_picture->p_hash_table;
+  MotionVector *mv = &mv_block->mv[list];
+  // blocks smaller than 8x8 use the 8x8 block they belong to
+  int anchor_x = mv_block->pos_x & ~(HASH_ME_BLOCK - 1);
+  int anchor_y = mv_block->pos_y & ~(HASH_ME_BLOCK - 1);
+  int blocks_x = imax(1, mv_block->blocksize_x / HASH_ME_BLOCK);
+  int blocks_y = imax(1, mv_block->blocksize_y / HASH_ME_BLOCK);
+  unsigned int cur_hash[2][2];
+  int pos, i, j, d, band, checked = 0;
+  int pred_band;
+  MotionVector best = *mv, cand, pred_pad;
+  distblk best_cost = DISTBLK_MAX, cost;
+
+  if (table == NULL || is_flat_block(p_Vid->pCurImg, anchor_y, anchor_x))
+    return min_mcost;
+
+  ++p_Vid->hash_me_checked;
+  for (j = 0; j < blocks_y; j++)
+  {
+    for (i = 0; i < blocks_x; i++)
+      cur_hash[j][i] = block_hash(p_Vid->pCurImg, anchor_y + j * HASH_ME_BLOCK, anchor_x + i * HASH_ME_BLOCK);
+  }
+
+  pred_band = iClip3(0, table->bands - 1, (anchor_y + (pred->mv_y >> 2)) >> HASH_ME_BAND_SHIFT);
+
+  // bands pred_band, pred_band - 1, pred_band + 1, pred_band - 2, ...
+  for (d = 0; d < 2 * table->bands && checked < HASH_ME_MAX_CHAIN; d++)
+  {
+    band = (d & 1) ? pred_band - ((d + 1) >> 1) : pred_band + (d >> 1);
+    if (band < 0 || band >= table->bands)
+      continue;
+
+    for (pos = table->head[hash_bucket(cur_hash[0][0], band)]; pos >= 0 && checked < HASH_ME_MAX_CHAIN; )
+    {
+      int y = pos / table->width;
+      int x = pos - y * table->width;
+
+      pos = table->next[y][x];
+      // other bands share the bucket
+      if ((unsigned int) table->hash[y][x] != cur_hash[0][0] || (y >> HASH_ME_BAND_SHIFT) != band)
+        continue;
+      ++checked;
+
+      // the other 8x8 blocks of larger partitions have to match as well
+      if (x + (blocks_x - 1) * HASH_ME_BLOCK >= table->width || y + (blocks_y - 1) * HASH_ME_BLOCK >= table->height)
+        continue;
+      for (j = 0; j < blocks_y; j++)
+      {
+        for (i = 0; i < blocks_x; i++)
+        {
+          if ((unsigned int) table->hash[y + j * HASH_ME_BLOCK][x + i * HASH_ME_BLOCK] != cur_hash[j][i])
+            break;
+        }
+        if (i < blocks_x)
+          break;
+      }
+      if (j < blocks_y)
+        continue;
+
+      cand.mv_x = (short) ((x - anchor_x) << 2);
+      cand.mv_y = (short) ((y - anchor_y) << 2);
+
+      // stay within the level limits and codable with the mvbits table
+      if (cand.mv_x < p_Vid->MaxHmvR[4] || cand.mv_x > p_Vid->MaxHmvR[5]
+        || cand.mv_y < p_Vid->MaxVmvR[4] || cand.mv_y > p_Vid->MaxVmvR[5]
+        || iabs(cand.mv_x - pred->mv_x) + 16 > p_Vid->max_mvd
+        || iabs(cand.mv_y - pred->mv_y) + 16 > p_Vid->max_mvd)
+        continue;
+
+      cost = mv_cost(p_Vid, lambda_factor, &cand, pred);
+      if (cost < best_cost)
+      {
+        best_cost = cost;
+        best = cand;
+      }
+    }
+  }
+
+  if (best_cost == DISTBLK_MAX)
+    return min_mcost;
+
+  ++p_Vid->hash_me_found;
+  if ((best.mv_x == mv->mv_x && best.mv_y == mv->mv_y) || best_cost >= min_mcost)
+    return min_mcost;
+
+  // the match is exact in the source pictures, the cost is taken on the reconstruction
+  pred_pad = pad_MVs(*pred, mv_block);
+  cand = pad_MVs(best, mv_block);
+  cost = mv_cost(p_Vid, lambda_factor, &cand, &pred_pad);
+  cost += mv_block->computePredFPel(ref_picture, mv_block, min_mcost - cost, &cand);
+
+  if (cost < min_mcost)
+  {
+    *mv = best;
+    ++p_Vid->hash_me_used;
+    return cost;
+  }
+  return min_mcost;
+}
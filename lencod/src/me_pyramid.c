@@ -0,0 +1,296 @@
+
+/*!
+ *************************************************************************************
+ * \file me_pyramid.c
+ *
+ * \brief
+ *    Hierarchical (pyramid) motion estimation pre-pass
+ *
+ *    Every reference picture and the current picture get 1/2 and 1/4 scaled luma
+ *    levels. For each macroblock and reference a coarse vector is found by a full
+ *    search at the 1/4 level, refined at the 1/2 level and scaled back. Before the
+ *    integer pel search of a block the coarse vector is compared with the search
+ *    centre derived from the median predictor, and the cheaper one becomes the
+ *    centre. Large motion is then found with a small full resolution range.
+ *************************************************************************************
+ */
+
+#include "contributors.h"
+
+#include <limits.h>
+
+#include "global.h"
+#include "memalloc.h"
+#include "mv_search.h"
+#include "me_pyramid.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Halves a luma plane in both directions (2x2 average)
+ ************************************************************************
+ */
+static void downsample_plane(imgpel **dst, imgpel **src, int size_x, int size_y)
+{
+  int x, y;
+
+  for (y = 0; y < (size_y >> 1); y++)
+  {
+    imgpel *s0 = src[2 * y];
+    imgpel *s1 = src[2 * y + 1];
+    imgpel *d  = dst[y];
+
+    for (x = 0; x < (size_x >> 1); x++)
+    {
+      d[x] = (imgpel) ((s0[2 * x] + s0[2 * x + 1] + s1[2 * x] + s1[2 * x + 1] + 2) >> 2);
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    SAD of a square block of two scaled levels
+ ************************************************************************
+ */
+static int block_sad(imgpel **cur, imgpel **ref, int y, int x, int ry, int rx, int size)
+{
+  int i, j, sad = 0;
+
+  for (j = 0; j < size; j++)
+  {
+    imgpel *c = &cur[y + j][x];
+    imgpel *r = &ref[ry + j][rx];
+
+    for (i = 0; i < size; i++)
+      sad += iabs(c[i] - r[i]);
+  }
+  return sad;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Searches a window of a scaled level. Candidates keep the block
+ *    inside the picture; ties go to the shorter vector.
+ ************************************************************************
+ */
+static void search_level(imgpel **cur, imgpel **ref, int size_x, int size_y, int x, int y, int size,
+                         int center_x, int center_y, int range, MotionVector *best)
+{
+  int min_x = imax(-x, center_x - range);
+  int max_x = imin(size_x - size - x, center_x + range);
+  int min_y = imax(-y, center_y - range);
+  int max_y = imin(size_y - size - y, center_y + range);
+  int best_cost = INT_MAX;
+  int i, j, cost;
+
+  best->mv_x = best->mv_y = 0;
+  for (j = min_y; j <= max_y; j++)
+  {
+    for (i = min_x; i <= max_x; i++)
+    {
+      cost = (block_sad(cur, ref, y, x, y + j, x + i, size) << 4) + iabs(i) + iabs(j);
+      if (cost < best_cost)
+      {
+        best_cost = cost;
+        best->mv_x = (short) i;
+        best->mv_y = (short) j;
+      }
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Estimates the coarse vector of a macroblock in quarter pel units
+ ************************************************************************
+ */
+static MotionVector estimate_coarse_mv(MEPyramid *pyr, StorablePicture *ref, int pix_x, int pix_y)
+{
+  MotionVector mv;
+
+  search_level(pyr->cur[1], ref->p_hme_int_img[1], pyr->size_x[1], pyr->size_y[1], pix_x >> 2, pix_y >> 2,
+    MB_BLOCK_SIZE >> 2, 0, 0, pyr->search_range, &mv);
+  search_level(pyr->cur[0], ref->p_hme_int_img[0], pyr->size_x[0], pyr->size_y[0], pix_x >> 1, pix_y >> 1,
+    MB_BLOCK_SIZE >> 1, mv.mv_x << 1, mv.mv_y << 1, PYR_REFINE_RANGE, &mv);
+
+  mv.mv_x = (short) (mv.mv_x << 3);
+  mv.mv_y = (short) (mv.mv_y << 3);
+  return mv;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates the pyramid data of the current picture
+ *
+ * \return
+ *    memory size in bytes
+ ************************************************************************
+ */
+int init_me_pyramid(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  MEPyramid *pyr;
+  int memory_size = 0;
+  int level;
+
+  if ((pyr = (MEPyramid *) calloc(1, sizeof(MEPyramid))) == NULL)
+    no_mem_exit("init_me_pyramid: pyr");
+
+  for (level = 0; level < PYR_LEVELS; level++)
+    memory_size += get_mem2Dpel(&pyr->cur[level], p_Vid->height >> (level + 1), p_Vid->width >> (level + 1));
+
+  pyr->search_range = p_Inp->PyramidSearchRange;
+  p_Vid->p_pyramid = pyr;
+
+  return memory_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the pyramid data of the current picture
+ ************************************************************************
+ */
+void free_me_pyramid(VideoParameters *p_Vid)
+{
+  MEPyramid *pyr = p_Vid->p_pyramid;
+  int list, ref, level;
+
+  for (level = 0; level < PYR_LEVELS; level++)
+    free_mem2Dpel(pyr->cur[level]);
+
+  for (list = 0; list < 6; list++)
+  {
+    for (ref = 0; ref < MAX_REFERENCE_PICTURES; ref++)
+    {
+      free(pyr->mv[list][ref]);
+      free(pyr->mv_id[list][ref]);
+    }
+  }
+
+  free(pyr);
+  p_Vid->p_pyramid = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the scaled levels of the int-pel plane of a reference
+ *    picture used for motion estimation
+ ************************************************************************
+ */
+void get_pyramid_planes(StorablePicture *s)
+{
+  imgpel ***level = s->p_hme_int_img;
+
+  if (level == NULL)
+  {
+    MemTag prev_tag = mem_set_tag(MEM_TAG_ME);
+    if ((level = (imgpel ***) calloc(PYR_LEVELS, sizeof(imgpel **))) == NULL)
+      no_mem_exit("get_pyramid_planes: p_hme_int_img");
+    get_mem2Dpel(&level[0], s->size_y >> 1, s->size_x >> 1);
+    get_mem2Dpel(&level[1], s->size_y >> 2, s->size_x >> 2);
+    mem_set_tag(prev_tag);
+    s->p_hme_int_img = level;
+  }
+
+  downsample_plane(level[0], s->p_curr_img, s->size_x, s->size_y);
+  downsample_plane(level[1], level[0], s->size_x >> 1, s->size_y >> 1);
+  s->hme_plane = s->p_curr_img;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the scaled levels of the current picture and invalidates
+ *    the coarse vectors of the previous slice
+ ************************************************************************
+ */
+void pyramid_slice_init(VideoParameters *p_Vid)
+{
+  MEPyramid *pyr = p_Vid->p_pyramid;
+  StorablePicture *pic = p_Vid->enc_picture;
+  // pCurImg follows the field macroblocks of MBAFF frames
+  imgpel **img = (p_Vid->structure == FRAME) ? p_Vid->imgData.frm_data[0] : p_Vid->pCurImg;
+  int level;
+
+  for (level = 0; level < PYR_LEVELS; level++)
+  {
+    pyr->size_x[level] = pic->size_x >> (level + 1);
+    pyr->size_y[level] = pic->size_y >> (level + 1);
+  }
+
+  downsample_plane(pyr->cur[0], img, pic->size_x, pic->size_y);
+  downsample_plane(pyr->cur[1], pyr->cur[0], pyr->size_x[0], pyr->size_y[0]);
+
+  ++pyr->slice_id;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Moves the integer pel search centre of a block to the coarse vector
+ *    of its macroblock when that vector has the lower motion cost
+ ************************************************************************
+ */
+void set_pyramid_center(Macroblock *currMB, MEBlock *mv_block, MotionVector *pred, int lambda_factor)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  MEPyramid *pyr = p_Vid->p_pyramid;
+  int list = mv_block->list;
+  int cur_list = list + currMB->list_offset;
+  short ref = mv_block->ref_idx;
+  StorablePicture *ref_picture = currMB->p_Slice->listX[cur_list][ref];
+  MotionVector *mv = &mv_block->mv[list];
+  MotionVector coarse_mv, cand, pred_pad;
+  distblk center_cost, coarse_cost;
+  int mb = currMB->mbAddrX;
+
+  if (pyr->mv[cur_list][ref] == NULL)
+  {
+    if ((pyr->mv[cur_list][ref] = (MotionVector *) calloc(p_Vid->FrameSizeInMbs, sizeof(MotionVector))) == NULL)
+      no_mem_exit("set_pyramid_center: mv");
+    if ((pyr->mv_id[cur_list][ref] = (int *) calloc(p_Vid->FrameSizeInMbs, sizeof(int))) == NULL)
+      no_mem_exit("set_pyramid_center: mv_id");
+  }
+
+  if (pyr->mv_id[cur_list][ref][mb] != pyr->slice_id)
+  {
+    if (ref_picture->hme_plane != ref_picture->p_curr_img)
+      get_pyramid_planes(ref_picture);
+
+    pyr->mv[cur_list][ref][mb] = estimate_coarse_mv(pyr, ref_picture, currMB->pix_x, currMB->pix_y);
+    pyr->mv_id[cur_list][ref][mb] = pyr->slice_id;
+  }
+  coarse_mv = pyr->mv[cur_list][ref][mb];
+
+  if (coarse_mv.mv_x == mv->mv_x && coarse_mv.mv_y == mv->mv_y)
+    return;
+
+  // keep every vector of the search window codable with the mvbits table
+  if (iabs(coarse_mv.mv_x - pred->mv_x) + mv_block->searchRange.max_x + 16 > p_Vid->max_mvd
+    || iabs(coarse_mv.mv_y - pred->mv_y) + mv_block->searchRange.max_y + 16 > p_Vid->max_mvd)
+    return;
+
+  ++p_Vid->pyramid_checked;
+  pred_pad = pad_MVs(*pred, mv_block);
+
+  cand = pad_MVs(*mv, mv_block);
+  center_cost = mv_cost(p_Vid, lambda_factor, &cand, &pred_pad);
+  center_cost += mv_block->computePredFPel(ref_picture, mv_block, DISTBLK_MAX - center_cost, &cand);
+
+  cand = pad_MVs(coarse_mv, mv_block);
+  coarse_cost = mv_cost(p_Vid, lambda_factor, &cand, &pred_pad);
+  if (coarse_cost >= center_cost)
+    return;
+  coarse_cost += mv_block->computePredFPel(ref_picture, mv_block, center_cost - coarse_cost, &cand);
+
+  if (coarse_cost < center_cost)
+  {
+    *mv = coarse_mv;
+    ++p_Vid->pyramid_moved;
+  }
+}
@@ -90,9 +90,8 @@ void UMHEX_DefineThreshold(VideoParameters *p_Vid)
 ************************************************************************
 */
 
-void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp)
+void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp, UMHexContext *p_UMHexCtx)
 {
-  UMHexStruct *p_UMHex = p_Vid->p_UMHex;
   int gb_qp_per    = (p_Inp->qp[P_SLICE])/6;
   int gb_qp_rem    = (p_Inp->qp[P_SLICE])%6;
 
@@ -110,25 +109,25 @@ void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp)
   gb_qp_const=(1<<gb_q_bits)/6;
   Thresh4x4 =   ((1<<gb_q_bits) - gb_qp_const)/imax(1, p_Vid->p_Quant->q_params_4x4[0][1][gb_qp_rem][0][0].ScaleComp);
   Quantize_step = Thresh4x4/(4*5.61f)*2.0f*scale_factor;
-  p_UMHex->Bsize[7]=(16*16)*Quantize_step*dbScalar;
+  p_UMHexCtx->Bsize[7]=(16*16)*Quantize_step*dbScalar;
 
-  p_UMHex->Bsize[6] = p_UMHex->Bsize[7]*4*dbScalar;
-  p_UMHex->Bsize[5] = p_UMHex->Bsize[7]*4*dbScalar;
-  p_UMHex->Bsize[4] = p_UMHex->Bsize[5]*4*dbScalar;
-  p_UMHex->Bsize[3] = p_UMHex->Bsize[4]*4*dbScalar;
-  p_UMHex->Bsize[2] = p_UMHex->Bsize[4]*4*dbScalar;
-  p_UMHex->Bsize[1] = p_UMHex->Bsize[2]*4*dbScalar;
+  p_UMHexCtx->Bsize[6] = p_UMHexCtx->Bsize[7]*4*dbScalar;
+  p_UMHexCtx->Bsize[5] = p_UMHexCtx->Bsize[7]*4*dbScalar;
+  p_UMHexCtx->Bsize[4] = p_UMHexCtx->Bsize[5]*4*dbScalar;
+  p_UMHexCtx->Bsize[3] = p_UMHexCtx->Bsize[4]*4*dbScalar;
+  p_UMHexCtx->Bsize[2] = p_UMHexCtx->Bsize[4]*4*dbScalar;
+  p_UMHexCtx->Bsize[1] = p_UMHexCtx->Bsize[2]*4*dbScalar;
 
   for(i=1;i<8;i++)
   {
     //ET_Thd1: early termination after median prediction
-    p_UMHex->Median_Pred_Thd_MB[i]  = (distblk) (Median_Pred_Thd[i]* scale_factor*QP_factor*dbScalar);
+    p_UMHexCtx->Median_Pred_Thd_MB[i]  = (distblk) (Median_Pred_Thd[i]* scale_factor*QP_factor*dbScalar);
     //ET_thd2: early termination after every circle of 16 points Big-Hex Search
-    p_UMHex->Big_Hexagon_Thd_MB[i]  = (distblk) (Big_Hexagon_Thd[i]* scale_factor*QP_factor*dbScalar);
+    p_UMHexCtx->Big_Hexagon_Thd_MB[i]  = (distblk) (Big_Hexagon_Thd[i]* scale_factor*QP_factor*dbScalar);
     //threshold for multi ref case
-    p_UMHex->Multi_Ref_Thd_MB[i]    = (distblk) (Multi_Ref_Thd[i]  * scale_factor*QP_factor*dbScalar);
+    p_UMHexCtx->Multi_Ref_Thd_MB[i]    = (distblk) (Multi_Ref_Thd[i]  * scale_factor*QP_factor*dbScalar);
     //threshold for usage of DSR technique. DSR ref to JVT-R088
-    p_UMHex->Threshold_DSR_MB[i]    = (distblk) (Threshold_DSR[i]  * scale_factor*QP_factor*dbScalar);
+    p_UMHexCtx->Threshold_DSR_MB[i]    = (distblk) (Threshold_DSR[i]  * scale_factor*QP_factor*dbScalar);
   }
 }
 
@@ -146,14 +145,10 @@ int UMHEX_get_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if (NULL==(p_UMHex->flag_intra = calloc ((p_Vid->width>>4)+1,sizeof(byte)))) no_mem_exit("UMHEX_get_mem: p_UMHex->flag_intra"); //fwf 20050330
 
-  memory_size += get_mem2D(&p_UMHex->McostState, 2*p_Inp->search_range+1, 2*p_Inp->search_range+1);
-
-  memory_size += get_mem4Ddistblk(&(p_UMHex->fastme_ref_cost), p_Vid->max_num_references, 9, 4, 4);
   memory_size += get_mem3Ddistblk(&(p_UMHex->fastme_l0_cost), 9, p_Vid->height >> 2, p_Vid->width >> 2);
   memory_size += get_mem3Ddistblk(&(p_UMHex->fastme_l1_cost), 9, p_Vid->height >> 2, p_Vid->width >> 2);
   memory_size += get_mem2Ddistblk(&(p_UMHex->fastme_best_cost), 7, p_Vid->width >> 2);
 
-  memory_size += get_mem2D(&p_UMHex->SearchState, 7, 7);
   if(p_Inp->BiPredMotionEstimation == 1)//memory allocation for bipred mode
   {
     memory_size += get_mem3Ddistblk(&(p_UMHex->fastme_l0_cost_bipred), 9, p_Vid->height >> 2, p_Vid->width >> 2);//for bipred
@@ -172,14 +167,11 @@ int UMHEX_get_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
 void UMHEX_free_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
 {
   UMHexStruct *p_UMHex = p_Vid->p_UMHex;
-  free_mem2D(p_UMHex->McostState);
 
-  free_mem4Ddistblk(p_UMHex->fastme_ref_cost);
   free_mem3Ddistblk(p_UMHex->fastme_l0_cost );
   free_mem3Ddistblk(p_UMHex->fastme_l1_cost);
   free_mem2Ddistblk(p_UMHex->fastme_best_cost);
 
-  free_mem2D(p_UMHex->SearchState);
   free (p_UMHex->flag_intra);
   if(p_Inp->BiPredMotionEstimation == 1)
   {
@@ -189,6 +181,49 @@ void UMHEX_free_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
   free(p_UMHex);
 }
 
+/*!
+************************************************************************
+* \brief
+*    Allocation of the search context of a slice
+*    The MB thresholds are set once here; they only depend on the
+*    sequence parameters and the quantization of the picture
+************************************************************************
+*/
+int UMHEX_get_context_mem(Slice *currSlice)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
+  UMHexContext *p_UMHexCtx = currSlice->p_UMHexCtx;
+
+  int memory_size = 0;
+
+  memory_size += get_mem2D(&p_UMHexCtx->McostState, 2*p_Inp->search_range+1, 2*p_Inp->search_range+1);
+  memory_size += get_mem4Ddistblk(&(p_UMHexCtx->fastme_ref_cost), p_Vid->max_num_references, 9, 4, 4);
+  memory_size += get_mem2D(&p_UMHexCtx->SearchState, 7, 7);
+
+  UMHEX_DefineThresholdMB(p_Vid, p_Inp, p_UMHexCtx);
+
+  return memory_size;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Free the search context of a slice
+************************************************************************
+*/
+void UMHEX_free_context_mem(Slice *currSlice)
+{
+  UMHexContext *p_UMHexCtx = currSlice->p_UMHexCtx;
+
+  free_mem2D(p_UMHexCtx->McostState);
+  free_mem4Ddistblk(p_UMHexCtx->fastme_ref_cost);
+  free_mem2D(p_UMHexCtx->SearchState);
+
+  free(p_UMHexCtx);
+  currSlice->p_UMHexCtx = NULL;
+}
+
 /*!
 ************************************************************************
 * \brief
@@ -231,6 +266,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   UMHexStruct *p_UMHex = p_Vid->p_UMHex;
+  UMHexContext *p_UMHexCtx = mv_block->p_UMHexCtx;
 
   int   blocktype     = mv_block->blocktype;
   short blocksize_x   = mv_block->blocksize_x;  // horizontal block size
@@ -255,7 +291,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
   float betaFourth_1,betaFourth_2;
   int  temp_Big_Hexagon_X[16];//  temp for Big_Hexagon_X;
   int  temp_Big_Hexagon_Y[16];//  temp for Big_Hexagon_Y;
-  distblk ET_Thred = p_UMHex->Median_Pred_Thd_MB[blocktype];//ET threshold in use
+  distblk ET_Thred = p_UMHexCtx->Median_Pred_Thd_MB[blocktype];//ET threshold in use
   int  search_range = mv_block->searchRange.max_x >> 2;
 
   short pic_pix_x = mv_block->pos_x_padded;
@@ -268,7 +304,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
 
 
   //////allocate memory for search state//////////////////////////
-  memset(p_UMHex->McostState[0],0,(2*p_Inp->search_range+1)*(2*p_Inp->search_range+1));
+  memset(p_UMHexCtx->McostState[0],0,(2*p_Inp->search_range+1)*(2*p_Inp->search_range+1));
 
 
   //check the center median predictor
@@ -278,7 +314,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
 
   mcost += mv_block->computePredFPel(ref_picture, mv_block, min_mcost - mcost, &cand);
 
-  p_UMHex->McostState[search_range][search_range] = 1;
+  p_UMHexCtx->McostState[search_range][search_range] = 1;
   if (mcost < min_mcost)
   {
     min_mcost = mcost;
@@ -309,7 +345,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
   }
   /***********************************init process*************************/
   //for multi ref
-  if(ref>0 && currSlice->structure == FRAME  && min_mcost > ET_Thred && SAD_prediction[pic_pix_x2] < p_UMHex->Multi_Ref_Thd_MB[blocktype])
+  if(ref>0 && currSlice->structure == FRAME  && min_mcost > ET_Thred && SAD_prediction[pic_pix_x2] < p_UMHexCtx->Multi_Ref_Thd_MB[blocktype])
     goto terminate_step;
 
   //ET_Thd1: early termination for low motion case
@@ -320,19 +356,19 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
   else // hybrid search for main search loop
   {
     /****************************(MV and SAD prediction)********************************/
-    UMHEX_setup(currMB, ref, mv_block->list, block_y, block_x, blocktype, currSlice->all_mv );
-    ET_Thred = p_UMHex->Big_Hexagon_Thd_MB[blocktype];  // ET_Thd2: early termination Threshold for strong motion
+    UMHEX_setup(currMB, p_UMHexCtx, ref, mv_block->list, block_y, block_x, blocktype, currSlice->all_mv );
+    ET_Thred = p_UMHexCtx->Big_Hexagon_Thd_MB[blocktype];  // ET_Thd2: early termination Threshold for strong motion
 
     // Threshold defined for EARLY_TERMINATION
-    if (p_UMHex->pred_SAD == 0)
+    if (p_UMHexCtx->pred_SAD == 0)
     {
       betaFourth_1=0;
       betaFourth_2=0;
     }
     else
     {
-      betaFourth_1 = p_UMHex->Bsize[blocktype]/((float)p_UMHex->pred_SAD * p_UMHex->pred_SAD)-p_UMHex->AlphaFourth_1[blocktype];
-      betaFourth_2 = p_UMHex->Bsize[blocktype]/((float)p_UMHex->pred_SAD * p_UMHex->pred_SAD)-p_UMHex->AlphaFourth_2[blocktype];
+      betaFourth_1 = p_UMHexCtx->Bsize[blocktype]/((float)p_UMHexCtx->pred_SAD * p_UMHexCtx->pred_SAD)-p_UMHex->AlphaFourth_1[blocktype];
+      betaFourth_2 = p_UMHexCtx->Bsize[blocktype]/((float)p_UMHexCtx->pred_SAD * p_UMHexCtx->pred_SAD)-p_UMHex->AlphaFourth_2[blocktype];
 
     }
     /*********************************************end of init ***********************************************/
@@ -341,17 +377,17 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
 
   if(blocktype>1)
   {
-    cand.mv_x = (short) (pic_pix_x + (p_UMHex->pred_MV_uplayer[0] / 4) * 4);
-    cand.mv_y = (short) (pic_pix_y + (p_UMHex->pred_MV_uplayer[1] / 4) * 4);
+    cand.mv_x = (short) (pic_pix_x + (p_UMHexCtx->pred_MV_uplayer[0] / 4) * 4);
+    cand.mv_y = (short) (pic_pix_y + (p_UMHexCtx->pred_MV_uplayer[1] / 4) * 4);
     SEARCH_ONE_PIXEL
   }
 
 
   //prediction using mV of last ref moiton vector
-  if(p_UMHex->pred_MV_ref_flag == 1)      //Notes: for interlace case, ref==1 should be added
+  if(p_UMHexCtx->pred_MV_ref_flag == 1)      //Notes: for interlace case, ref==1 should be added
   {
-    cand.mv_x = (short) (pic_pix_x + (p_UMHex->pred_MV_ref[0] / 4) * 4);
-    cand.mv_y = (short) (pic_pix_y + (p_UMHex->pred_MV_ref[1] / 4) * 4);
+    cand.mv_x = (short) (pic_pix_x + (p_UMHexCtx->pred_MV_ref[0] / 4) * 4);
+    cand.mv_y = (short) (pic_pix_y + (p_UMHexCtx->pred_MV_ref[1] / 4) * 4);
     SEARCH_ONE_PIXEL
   }
   // Small local search
@@ -479,7 +515,7 @@ terminate_step:
     {
       if(mv_block->list == 0)
       {
-        p_UMHex->fastme_ref_cost[ref][blocktype][block_y+j][block_x+i] = min_mcost;
+        p_UMHexCtx->fastme_ref_cost[ref][blocktype][block_y+j][block_x+i] = min_mcost;
         if (ref==0)
           p_UMHex->fastme_l0_cost[blocktype][(currMB->block_y)+block_y+j][(currMB->block_x)+block_x+i] = min_mcost;
       }
@@ -508,7 +544,7 @@ UMHEXSubPelBlockMotionSearch (Macroblock *currMB,     // <--  current Macroblock
 {
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
-  UMHexStruct *p_UMHex = p_Vid->p_UMHex;
+  UMHexContext *p_UMHexCtx = mv_block->p_UMHexCtx;
   static const MotionVector DiamondQ[4] = {{-1, 0}, { 0, 1}, { 1, 0}, { 0, -1}};
   distblk mcost;
   MotionVector cand, iMinNow, currmv = {0, 0}, candWithPad;
@@ -529,15 +565,15 @@ UMHEXSubPelBlockMotionSearch (Macroblock *currMB,     // <--  current Macroblock
   pred_frac_mv_x = (pred_mv->mv_x - mv->mv_x) & 0x03;
   pred_frac_mv_y = (pred_mv->mv_y - mv->mv_y) & 0x03;
 
-  //pred_frac_up_mv_x = (p_UMHex->pred_MV_uplayer[0] - mv->mv_x) & 0x03;
-  //pred_frac_up_mv_y = (p_UMHex->pred_MV_uplayer[1] - mv->mv_y) & 0x03;
+  //pred_frac_up_mv_x = (p_UMHexCtx->pred_MV_uplayer[0] - mv->mv_x) & 0x03;
+  //pred_frac_up_mv_y = (p_UMHexCtx->pred_MV_uplayer[1] - mv->mv_y) & 0x03;
 
 
-  memset(p_UMHex->SearchState[0], 0,(2 * dynamic_search_range + 1)*(2 * dynamic_search_range + 1));
+  memset(p_UMHexCtx->SearchState[0], 0,(2 * dynamic_search_range + 1)*(2 * dynamic_search_range + 1));
 
   if( !p_Vid->start_me_refinement_hp )
   {
-    p_UMHex->SearchState[dynamic_search_range][dynamic_search_range] = 1;
+    p_UMHexCtx->SearchState[dynamic_search_range][dynamic_search_range] = 1;
     cand = *mv;
     mcost = mv_cost (p_Vid, lambda_factor, &cand, pred_mv);
     candWithPad = pad_MVs (cand, mv_block); //cand = pad_MVs (cand, mv_block);
@@ -551,7 +587,7 @@ UMHEXSubPelBlockMotionSearch (Macroblock *currMB,     // <--  current Macroblock
   }
   else
   {
-    p_UMHex->SearchState[dynamic_search_range][dynamic_search_range] = 1;
+    p_UMHexCtx->SearchState[dynamic_search_range][dynamic_search_range] = 1;
     currmv = *mv;
   }
 
@@ -560,7 +596,7 @@ UMHEXSubPelBlockMotionSearch (Macroblock *currMB,     // <--  current Macroblock
     cand.mv_x = (short) (mv->mv_x + pred_frac_mv_x);
     cand.mv_y = (short) (mv->mv_y + pred_frac_mv_y);
     mcost = mv_cost (p_Vid, lambda_factor, &cand, pred_mv);
-    p_UMHex->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
+    p_UMHexCtx->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
     candWithPad = pad_MVs (cand, mv_block); //cand = pad_MVs (cand, mv_block);
 
     mcost += mv_block->computePredQPel( ref_picture, mv_block, min_mcost - mcost, &candWithPad); //&cand);
@@ -584,9 +620,9 @@ UMHEXSubPelBlockMotionSearch (Macroblock *currMB,     // <--  current Macroblock
 
       if(iabs(cand.mv_x - mv->mv_x) <= dynamic_search_range && iabs(cand.mv_y - mv->mv_y) <= dynamic_search_range)
       {
-        if(!p_UMHex->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x -mv->mv_x + dynamic_search_range])
+        if(!p_UMHexCtx->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x -mv->mv_x + dynamic_search_range])
         {
-          p_UMHex->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x -mv->mv_x + dynamic_search_range] = 1;
+          p_UMHexCtx->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x -mv->mv_x + dynamic_search_range] = 1;
           mcost = mv_cost (p_Vid, lambda_factor, &cand, pred_mv);
           candWithPad = pad_MVs (cand, mv_block); //cand = pad_MVs (cand, mv_block);
 
@@ -645,7 +681,7 @@ UMHEXSubPelBlockME (Macroblock *currMB,        // <-- Current Macroblock
 *    2003.4
 ************************************************************************
 */
-void UMHEX_decide_intrabk_SAD(Macroblock *currMB)
+void UMHEX_decide_intrabk_SAD(Macroblock *currMB, UMHexContext *p_UMHexCtx)
 {
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
@@ -654,25 +690,25 @@ void UMHEX_decide_intrabk_SAD(Macroblock *currMB)
   {
     if (currMB->pix_x == 0 && currMB->pix_y == 0)
     {
-      p_UMHex->flag_intra_SAD = 0;
+      p_UMHexCtx->flag_intra_SAD = 0;
     }
     else if (currMB->pix_x == 0)
     {
-      p_UMHex->flag_intra_SAD = p_UMHex->flag_intra[(currMB->pix_x)>>4];
+      p_UMHexCtx->flag_intra_SAD = p_UMHex->flag_intra[(currMB->pix_x)>>4];
     }
     else if (currMB->pix_y == 0)
     {
-      p_UMHex->flag_intra_SAD = p_UMHex->flag_intra[((currMB->pix_x)>>4)-1];
+      p_UMHexCtx->flag_intra_SAD = p_UMHex->flag_intra[((currMB->pix_x)>>4)-1];
     }
     else
     {
-      p_UMHex->flag_intra_SAD = ((p_UMHex->flag_intra[(currMB->pix_x)>>4])||(p_UMHex->flag_intra[((currMB->pix_x)>>4)-1])||(p_UMHex->flag_intra[((currMB->pix_x)>>4)+1])) ;
+      p_UMHexCtx->flag_intra_SAD = ((p_UMHex->flag_intra[(currMB->pix_x)>>4])||(p_UMHex->flag_intra[((currMB->pix_x)>>4)-1])||(p_UMHex->flag_intra[((currMB->pix_x)>>4)+1])) ;
     }
   }
   return;
 }
 
-void UMHEX_skip_intrabk_SAD(Macroblock *currMB, int ref_max)
+void UMHEX_skip_intrabk_SAD(Macroblock *currMB, UMHexContext *p_UMHexCtx, int ref_max)
 {
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
@@ -694,7 +730,7 @@ void UMHEX_skip_intrabk_SAD(Macroblock *currMB, int ref_max)
 
           for (ref=0; ref < ref_max;ref++)
           {
-            p_UMHex->fastme_ref_cost[ref][k][j][i] = 0;
+            p_UMHexCtx->fastme_ref_cost[ref][k][j][i] = 0;
           }
         }
       }
@@ -705,7 +741,7 @@ void UMHEX_skip_intrabk_SAD(Macroblock *currMB, int ref_max)
 }
 
 
-void UMHEX_setup(Macroblock *currMB, short ref, int list, int block_y, int block_x, int blocktype, MotionVector  *****all_mv)
+void UMHEX_setup(Macroblock *currMB, UMHexContext *p_UMHexCtx, short ref, int list, int block_y, int block_x, int blocktype, MotionVector  *****all_mv)
 {
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
@@ -725,47 +761,47 @@ void UMHEX_setup(Macroblock *currMB, short ref, int list, int block_y, int block
   if (blocktype>1)
   {
     temp_blocktype = indication_blocktype[blocktype];
-    p_UMHex->pred_MV_uplayer[0] = all_mv[list][ref][temp_blocktype][block_y][block_x].mv_x;
-    p_UMHex->pred_MV_uplayer[1] = all_mv[list][ref][temp_blocktype][block_y][block_x].mv_y;
+    p_UMHexCtx->pred_MV_uplayer[0] = all_mv[list][ref][temp_blocktype][block_y][block_x].mv_x;
+    p_UMHexCtx->pred_MV_uplayer[1] = all_mv[list][ref][temp_blocktype][block_y][block_x].mv_y;
   }
 
 
   //MV ref-frame prediction
-  p_UMHex->pred_MV_ref_flag = 0;
+  p_UMHexCtx->pred_MV_ref_flag = 0;
   if(list==0)
   {
     if (p_Vid->field_picture)
     {
       if ( ref > 1)
       {
-        p_UMHex->pred_MV_ref[0] = all_mv[0][ref-2][blocktype][block_y][block_x].mv_x;
-        p_UMHex->pred_MV_ref[0] = (int)(p_UMHex->pred_MV_ref[0]*((ref>>1)+1)/(float)((ref>>1)));
-        p_UMHex->pred_MV_ref[1] = all_mv[0][ref-2][blocktype][block_y][block_x].mv_y;
-        p_UMHex->pred_MV_ref[1] = (int)(p_UMHex->pred_MV_ref[1]*((ref>>1)+1)/(float)((ref>>1)));
-        p_UMHex->pred_MV_ref_flag = 1;
+        p_UMHexCtx->pred_MV_ref[0] = all_mv[0][ref-2][blocktype][block_y][block_x].mv_x;
+        p_UMHexCtx->pred_MV_ref[0] = (int)(p_UMHexCtx->pred_MV_ref[0]*((ref>>1)+1)/(float)((ref>>1)));
+        p_UMHexCtx->pred_MV_ref[1] = all_mv[0][ref-2][blocktype][block_y][block_x].mv_y;
+        p_UMHexCtx->pred_MV_ref[1] = (int)(p_UMHexCtx->pred_MV_ref[1]*((ref>>1)+1)/(float)((ref>>1)));
+        p_UMHexCtx->pred_MV_ref_flag = 1;
       }
       if (currSlice->slice_type == B_SLICE &&  (ref==0 || ref==1) )
       {
-        p_UMHex->pred_MV_ref[0] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref[1] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref_flag = 1;
+        p_UMHexCtx->pred_MV_ref[0] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[1] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref_flag = 1;
       }
     }
     else //frame case
     {
       if ( ref > 0)
       {
-        p_UMHex->pred_MV_ref[0] = all_mv[0][ref-1][blocktype][block_y][block_x].mv_x;
-        p_UMHex->pred_MV_ref[0] = (int)(p_UMHex->pred_MV_ref[0]*(ref+1)/(float)(ref));
-        p_UMHex->pred_MV_ref[1] = all_mv[0][ref-1][blocktype][block_y][block_x].mv_y;
-        p_UMHex->pred_MV_ref[1] = (int)(p_UMHex->pred_MV_ref[1]*(ref+1)/(float)(ref));
-        p_UMHex->pred_MV_ref_flag = 1;
+        p_UMHexCtx->pred_MV_ref[0] = all_mv[0][ref-1][blocktype][block_y][block_x].mv_x;
+        p_UMHexCtx->pred_MV_ref[0] = (int)(p_UMHexCtx->pred_MV_ref[0]*(ref+1)/(float)(ref));
+        p_UMHexCtx->pred_MV_ref[1] = all_mv[0][ref-1][blocktype][block_y][block_x].mv_y;
+        p_UMHexCtx->pred_MV_ref[1] = (int)(p_UMHexCtx->pred_MV_ref[1]*(ref+1)/(float)(ref));
+        p_UMHexCtx->pred_MV_ref_flag = 1;
       }
       if (currSlice->slice_type == B_SLICE && (ref==0)) //B frame forward prediction, first ref
       {
-        p_UMHex->pred_MV_ref[0] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref[1] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref_flag = 1;
+        p_UMHexCtx->pred_MV_ref[0] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[1] =(int) (all_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref_flag = 1;
       }
     }
   }
@@ -773,9 +809,9 @@ void UMHEX_setup(Macroblock *currMB, short ref, int list, int block_y, int block
   if (list==0 && ref>0)  //pred_SAD_ref
   {
 
-    if (p_UMHex->flag_intra_SAD) //add this for irregular motion
+    if (p_UMHexCtx->flag_intra_SAD) //add this for irregular motion
     {
-      p_UMHex->pred_SAD = 0;
+      p_UMHexCtx->pred_SAD = 0;
     }
     else
     {
@@ -783,33 +819,33 @@ void UMHEX_setup(Macroblock *currMB, short ref, int list, int block_y, int block
       {
         if (ref > 1)
         {
-          p_UMHex->pred_SAD = p_UMHex->fastme_ref_cost[ref-2][blocktype][block_y][block_x];
+          p_UMHexCtx->pred_SAD = p_UMHexCtx->fastme_ref_cost[ref-2][blocktype][block_y][block_x];
         }
         else
         {
-          p_UMHex->pred_SAD = p_UMHex->fastme_ref_cost[0][blocktype][block_y][block_x];
+          p_UMHexCtx->pred_SAD = p_UMHexCtx->fastme_ref_cost[0][blocktype][block_y][block_x];
         }
       }
       else
       {
-        p_UMHex->pred_SAD = p_UMHex->fastme_ref_cost[ref-1][blocktype][block_y][block_x];
+        p_UMHexCtx->pred_SAD = p_UMHexCtx->fastme_ref_cost[ref-1][blocktype][block_y][block_x];
       }
 
     }
   }
   else if (blocktype>1)  // pred_SAD_uplayer
   {
-    if (p_UMHex->flag_intra_SAD)
+    if (p_UMHexCtx->flag_intra_SAD)
     {
-      p_UMHex->pred_SAD = 0;
+      p_UMHexCtx->pred_SAD = 0;
     }
     else
     {
-      p_UMHex->pred_SAD = (list==1) ? (p_UMHex->fastme_l1_cost[temp_blocktype][(currMB->block_y)+block_y][(currMB->block_x)+block_x]) : (p_UMHex->fastme_l0_cost[temp_blocktype][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
-      p_UMHex->pred_SAD /= 2;
+      p_UMHexCtx->pred_SAD = (list==1) ? (p_UMHex->fastme_l1_cost[temp_blocktype][(currMB->block_y)+block_y][(currMB->block_x)+block_x]) : (p_UMHex->fastme_l0_cost[temp_blocktype][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
+      p_UMHexCtx->pred_SAD /= 2;
     }
   }
-  else p_UMHex->pred_SAD = 0 ;  // pred_SAD_space
+  else p_UMHexCtx->pred_SAD = 0 ;  // pred_SAD_space
 
 }
 
@@ -845,6 +881,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   UMHexStruct *p_UMHex = p_Vid->p_UMHex;
+  UMHexContext *p_UMHexCtx = mv_block->p_UMHexCtx;
   int   temp_Big_Hexagon_X[16];// = Big_Hexagon_X;
   int   temp_Big_Hexagon_Y[16];// = Big_Hexagon_Y;
 
@@ -862,7 +899,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
 
   short block_x       = mv_block->block_x;
   short block_y       = mv_block->block_y;
-  distblk   ET_Thred      = p_UMHex->Median_Pred_Thd_MB[blocktype];
+  distblk   ET_Thred      = p_UMHexCtx->Median_Pred_Thd_MB[blocktype];
   short ref           = mv_block->ref_idx;
 
   StorablePicture *ref_picture1 = currSlice->listX[list + currMB->list_offset][ref];
@@ -880,7 +917,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
   //////////////////////////////////////////////////////////////////////////
 
   //////allocate memory for search state//////////////////////////
-  memset(p_UMHex->McostState[0],0,(2*search_range+1)*(2*search_range+1));
+  memset(p_UMHexCtx->McostState[0],0,(2*search_range+1)*(2*search_range+1));
 
   //check the center median predictor
   best = cand = center2;
@@ -888,7 +925,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
   mcost += mv_cost (p_Vid, lambda_factor, &cand, &pred2); 
   mcost += mv_block->computeBiPredFPel(ref_picture1, ref_picture2, mv_block, DISTBLK_MAX-mcost, &center1, &cand);
 
-  p_UMHex->McostState[search_range][search_range] = 1;
+  p_UMHexCtx->McostState[search_range][search_range] = 1;
 
   if (mcost < min_mcost)
   {
@@ -944,29 +981,29 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     {
       if (p_Vid->field_picture)
       {
-        p_UMHex->pred_MV_ref[0] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref[1] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[0] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[1] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
       }
       else //frame case
       {
-        p_UMHex->pred_MV_ref[0] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
-        p_UMHex->pred_MV_ref[1] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[0] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_x * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
+        p_UMHexCtx->pred_MV_ref[1] =(int) (bipred_mv[1][0][blocktype][block_y][block_x].mv_y * (-n_Bframe)/(N_Bframe-n_Bframe+1.0f));
       }
     }
     /******************************SAD prediction**********************************/
-    p_UMHex->pred_SAD =distblkmin(distblkmin(p_UMHex->SAD_a,p_UMHex->SAD_b),p_UMHex->SAD_c);  // pred_SAD_space
-    ET_Thred = p_UMHex->Big_Hexagon_Thd_MB[blocktype];
+    p_UMHexCtx->pred_SAD =distblkmin(distblkmin(p_UMHexCtx->SAD_a,p_UMHexCtx->SAD_b),p_UMHexCtx->SAD_c);  // pred_SAD_space
+    ET_Thred = p_UMHexCtx->Big_Hexagon_Thd_MB[blocktype];
 
     ///////Threshold defined for early termination///////////////////
-    if (p_UMHex->pred_SAD == 0)
+    if (p_UMHexCtx->pred_SAD == 0)
     {
       betaFourth_1=0;
       betaFourth_2=0;
     }
     else
     {
-      betaFourth_1 = p_UMHex->Bsize[blocktype]/(p_UMHex->pred_SAD * p_UMHex->pred_SAD)-p_UMHex->AlphaFourth_1[blocktype];
-      betaFourth_2 = p_UMHex->Bsize[blocktype]/(p_UMHex->pred_SAD * p_UMHex->pred_SAD)-p_UMHex->AlphaFourth_2[blocktype];
+      betaFourth_1 = p_UMHexCtx->Bsize[blocktype]/(p_UMHexCtx->pred_SAD * p_UMHexCtx->pred_SAD)-p_UMHex->AlphaFourth_1[blocktype];
+      betaFourth_2 = p_UMHexCtx->Bsize[blocktype]/(p_UMHexCtx->pred_SAD * p_UMHexCtx->pred_SAD)-p_UMHex->AlphaFourth_2[blocktype];
     }
   }
 
@@ -978,8 +1015,8 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
   //prediction using mV of last ref moiton vector
   if(list == 0)
   {
-    cand.mv_x = (short) (pic_pix_x + (p_UMHex->pred_MV_ref[0] / 4) * 4);
-    cand.mv_y = (short) (pic_pix_y + (p_UMHex->pred_MV_ref[1] / 4) * 4);
+    cand.mv_x = (short) (pic_pix_x + (p_UMHexCtx->pred_MV_ref[0] / 4) * 4);
+    cand.mv_y = (short) (pic_pix_y + (p_UMHexCtx->pred_MV_ref[1] / 4) * 4);
     SEARCH_ONE_PIXEL_BIPRED;
   }
 
@@ -1128,6 +1165,7 @@ void UMHEXSetMotionVectorPredictor (Macroblock *currMB,
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   UMHexStruct *p_UMHex = p_Vid->p_UMHex;
+  UMHexContext *p_UMHexCtx = mv_block->p_UMHexCtx;
   int mv_a, mv_b, mv_c;
   short pred_vec=0;
   int mvPredType, rFrameL, rFrameU, rFrameUR;
@@ -1136,8 +1174,8 @@ void UMHEXSetMotionVectorPredictor (Macroblock *currMB,
   PixelPos block_a, block_b, block_c, block_d;
 
   // added for bipred mode
-  distblk *** fastme_l0_cost_flag = (p_UMHex->bipred_flag ? p_UMHex->fastme_l0_cost_bipred : p_UMHex->fastme_l0_cost);
-  distblk *** fastme_l1_cost_flag = (p_UMHex->bipred_flag ? p_UMHex->fastme_l1_cost_bipred : p_UMHex->fastme_l1_cost);
+  distblk *** fastme_l0_cost_flag = (p_UMHexCtx->bipred_flag ? p_UMHex->fastme_l0_cost_bipred : p_UMHex->fastme_l0_cost);
+  distblk *** fastme_l1_cost_flag = (p_UMHexCtx->bipred_flag ? p_UMHex->fastme_l1_cost_bipred : p_UMHex->fastme_l1_cost);
   //Dynamic Search Range
 
   int dsr_temp_search_range[2];
@@ -1145,10 +1183,10 @@ void UMHEXSetMotionVectorPredictor (Macroblock *currMB,
   int *mb_size = p_Vid->mb_size[IS_LUMA];
 
   // neighborhood SAD init
-  p_UMHex->SAD_a = 0;
-  p_UMHex->SAD_b = 0;
-  p_UMHex->SAD_c = 0;
-  p_UMHex->SAD_d = 0;
+  p_UMHexCtx->SAD_a = 0;
+  p_UMHexCtx->SAD_b = 0;
+  p_UMHexCtx->SAD_c = 0;
+  p_UMHexCtx->SAD_d = 0;
 
   get4x4Neighbour(currMB, mb_x - 1           , mb_y    , mb_size, &block_a);
   get4x4Neighbour(currMB, mb_x               , mb_y - 1, mb_size, &block_b);
@@ -1260,10 +1298,10 @@ void UMHEXSetMotionVectorPredictor (Macroblock *currMB,
   // neighborhood SAD prediction
   if((p_Inp->UMHexDSR == 1 || p_Inp->BiPredMotionEstimation == 1))
   {
-    p_UMHex->SAD_a = block_a.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHex->UMHEX_blocktype][block_a.pos_y][block_a.pos_x]) : (fastme_l0_cost_flag[p_UMHex->UMHEX_blocktype][block_a.pos_y][block_a.pos_x])) : 0;
-    p_UMHex->SAD_b = block_b.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHex->UMHEX_blocktype][block_b.pos_y][block_b.pos_x]) : (fastme_l0_cost_flag[p_UMHex->UMHEX_blocktype][block_b.pos_y][block_b.pos_x])) : 0;
-    p_UMHex->SAD_d = block_d.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHex->UMHEX_blocktype][block_d.pos_y][block_d.pos_x]) : (fastme_l0_cost_flag[p_UMHex->UMHEX_blocktype][block_d.pos_y][block_d.pos_x])) : 0;
-    p_UMHex->SAD_c = block_c.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHex->UMHEX_blocktype][block_c.pos_y][block_c.pos_x]) : (fastme_l0_cost_flag[p_UMHex->UMHEX_blocktype][block_c.pos_y][block_c.pos_x])) : p_UMHex->SAD_d;
+    p_UMHexCtx->SAD_a = block_a.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_a.pos_y][block_a.pos_x]) : (fastme_l0_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_a.pos_y][block_a.pos_x])) : 0;
+    p_UMHexCtx->SAD_b = block_b.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_b.pos_y][block_b.pos_x]) : (fastme_l0_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_b.pos_y][block_b.pos_x])) : 0;
+    p_UMHexCtx->SAD_d = block_d.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_d.pos_y][block_d.pos_x]) : (fastme_l0_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_d.pos_y][block_d.pos_x])) : 0;
+    p_UMHexCtx->SAD_c = block_c.available ? ((list==1) ? (fastme_l1_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_c.pos_y][block_c.pos_x]) : (fastme_l0_cost_flag[p_UMHexCtx->UMHEX_blocktype][block_c.pos_y][block_c.pos_x])) : p_UMHexCtx->SAD_d;
   }
   for (hv=0; hv < 2; hv++)
   {
@@ -1353,7 +1391,7 @@ void UMHEXSetMotionVectorPredictor (Macroblock *currMB,
         else if(dsr_mv_sum > 3 ) dsr_small_search_range = (p_Inp->search_range + 2) >>2;
         else dsr_small_search_range = (3*p_Inp->search_range + 8) >> 4;
         dsr_temp_search_range[hv]=imin(p_Inp->search_range,imax(dsr_small_search_range,dsr_mv_max<<1));
-        if(distblkmax(p_UMHex->SAD_a, distblkmax(p_UMHex->SAD_b,p_UMHex->SAD_c)) > p_UMHex->Threshold_DSR_MB[p_UMHex->UMHEX_blocktype])
+        if(distblkmax(p_UMHexCtx->SAD_a, distblkmax(p_UMHexCtx->SAD_b,p_UMHexCtx->SAD_c)) > p_UMHexCtx->Threshold_DSR_MB[p_UMHexCtx->UMHEX_blocktype])
           dsr_temp_search_range[hv] = p_Inp->search_range;
       }
     }
@@ -110,7 +110,6 @@ int smpUMHEX_get_mem(VideoParameters *p_Vid)
 
   memory_size += get_mem3Ddistblk(&p_UMHexSMP->l0_cost, 9, p_Vid->height >> 2, p_Vid->width >> 2);
   memory_size += get_mem3Ddistblk(&p_UMHexSMP->l1_cost, 9, p_Vid->height >> 2, p_Vid->width >> 2);
-  memory_size += get_mem2D(&p_UMHexSMP->SearchState, 7, 7);
 
   return memory_size;
 }
@@ -126,12 +125,38 @@ void smpUMHEX_free_mem(VideoParameters *p_Vid)
   UMHexSMPStruct *p_UMHexSMP = p_Vid->p_UMHexSMP;
   free_mem3Ddistblk(p_UMHexSMP->l0_cost );
   free_mem3Ddistblk(p_UMHexSMP->l1_cost );
-  free_mem2D(p_UMHexSMP->SearchState);
 
   free (p_UMHexSMP->flag_intra);
   free (p_UMHexSMP);
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocation of the search context of a slice
+ ************************************************************************
+ */
+int smpUMHEX_get_context_mem(Slice *currSlice)
+{
+  UMHexSMPContext *p_UMHexSMPCtx = currSlice->p_UMHexSMPCtx;
+
+  return get_mem2D(&p_UMHexSMPCtx->SearchState, 7, 7);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the search context of a slice
+ ************************************************************************
+ */
+void smpUMHEX_free_context_mem(Slice *currSlice)
+{
+  free_mem2D(currSlice->p_UMHexSMPCtx->SearchState);
+
+  free (currSlice->p_UMHexSMPCtx);
+  currSlice->p_UMHexSMPCtx = NULL;
+}
+
 
 /*!
 ************************************************************************
@@ -150,6 +175,7 @@ smpUMHEXIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current Ma
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice           *currSlice = currMB->p_Slice;
   UMHexSMPStruct *p_UMHexSMP = p_Vid->p_UMHexSMP;
+  UMHexSMPContext *p_UMHexSMPCtx = mv_block->p_UMHexSMPCtx;
   int   blocktype     = mv_block->blocktype;  
   short blocksize_x   = mv_block->blocksize_x;            // horizontal block size  
   short blocksize_y   = mv_block->blocksize_y;            // vertical block size
@@ -277,8 +303,8 @@ smpUMHEXIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current Ma
   // Search up_layer predictor for non 16x16 blocks
   if (blocktype > 1)
   {
-    cand.mv_x = pic_pix_x + (p_UMHexSMP->pred_MV_uplayer_X / 4) * 4;
-    cand.mv_y = pic_pix_y + (p_UMHexSMP->pred_MV_uplayer_Y / 4) * 4;
+    cand.mv_x = pic_pix_x + (p_UMHexSMPCtx->pred_MV_uplayer_X / 4) * 4;
+    cand.mv_y = pic_pix_y + (p_UMHexSMPCtx->pred_MV_uplayer_Y / 4) * 4;
     SEARCH_ONE_PIXEL;
   }
 
@@ -519,6 +545,7 @@ smpUMHEXSubPelBlockMotionSearch  (
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
   UMHexSMPStruct *p_UMHexSMP = p_Vid->p_UMHexSMP;
+  UMHexSMPContext *p_UMHexSMPCtx = mv_block->p_UMHexSMPCtx;
   distblk   mcost;
   MotionVector cand, iMinNow, currmv = {0, 0}, candWithPad;
 
@@ -537,12 +564,12 @@ smpUMHEXSubPelBlockMotionSearch  (
   pred_frac_mv_x = (pred_mv->mv_x - mv->mv_x) %4; //& 0x03;
   pred_frac_mv_y = (pred_mv->mv_y - mv->mv_y) %4; //& 0x03;
 
-  pred_frac_up_mv_x = (p_UMHexSMP->pred_MV_uplayer_X - mv->mv_x) & 0x03;
-  pred_frac_up_mv_y = (p_UMHexSMP->pred_MV_uplayer_Y - mv->mv_y) & 0x03;
+  pred_frac_up_mv_x = (p_UMHexSMPCtx->pred_MV_uplayer_X - mv->mv_x) & 0x03;
+  pred_frac_up_mv_y = (p_UMHexSMPCtx->pred_MV_uplayer_Y - mv->mv_y) & 0x03;
 
-  memset(p_UMHexSMP->SearchState[0], 0, (2 * dynamic_search_range + 1)*(2 * dynamic_search_range + 1));
+  memset(p_UMHexSMPCtx->SearchState[0], 0, (2 * dynamic_search_range + 1)*(2 * dynamic_search_range + 1));
 
-  p_UMHexSMP->SearchState[dynamic_search_range][dynamic_search_range] = 1;
+  p_UMHexSMPCtx->SearchState[dynamic_search_range][dynamic_search_range] = 1;
   if( !p_Vid->start_me_refinement_hp )
   {
     cand.mv_x = mv->mv_x;
@@ -577,7 +604,7 @@ smpUMHEXSubPelBlockMotionSearch  (
   {
     cand.mv_x = (short) (mv->mv_x + pred_frac_mv_x);
     cand.mv_y = (short) (mv->mv_y + pred_frac_mv_y);
-    p_UMHexSMP->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
+    p_UMHexSMPCtx->SearchState[cand.mv_y -mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
     mcost = mv_cost (p_Vid, lambda_factor, &cand, pred_mv);
 
     candWithPad = pad_MVs (cand, mv_block); //cand = pad_MVs (cand, mv_block);
@@ -604,9 +631,9 @@ smpUMHEXSubPelBlockMotionSearch  (
 
       if(iabs(cand.mv_x - mv->mv_x) <= dynamic_search_range && iabs(cand.mv_y - mv->mv_y)  <= dynamic_search_range)
       {
-        if(!p_UMHexSMP->SearchState[cand.mv_y - mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range])
+        if(!p_UMHexSMPCtx->SearchState[cand.mv_y - mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range])
         {
-          p_UMHexSMP->SearchState[cand.mv_y - mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
+          p_UMHexSMPCtx->SearchState[cand.mv_y - mv->mv_y + dynamic_search_range][cand.mv_x - mv->mv_x + dynamic_search_range] = 1;
           mcost = mv_cost (p_Vid, lambda_factor, &cand, pred_mv);
           candWithPad = pad_MVs (cand, mv_block); //cand = pad_MVs (cand, mv_block);
           mcost += mv_block->computePredQPel( ref_picture, mv_block, min_mcost - mcost, &candWithPad); //&cand);
@@ -679,6 +706,7 @@ smpUMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  curr
   VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
   UMHexSMPStruct *p_UMHexSMP = p_Vid->p_UMHexSMP;
+  UMHexSMPContext *p_UMHexSMPCtx = mv_block->p_UMHexSMPCtx;
 
   int   search_step;
   int   i, m;
@@ -799,8 +827,8 @@ smpUMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  curr
   // Search up_layer predictor for non 16x16 blocks
   if (blocktype > 1)
   {
-    cand.mv_x = pic_pix_x + (p_UMHexSMP->pred_MV_uplayer_X / 4) * 4;
-    cand.mv_y = pic_pix_y + (p_UMHexSMP->pred_MV_uplayer_Y / 4) * 4;
+    cand.mv_x = pic_pix_x + (p_UMHexSMPCtx->pred_MV_uplayer_X / 4) * 4;
+    cand.mv_y = pic_pix_y + (p_UMHexSMPCtx->pred_MV_uplayer_Y / 4) * 4;
     SEARCH_ONE_PIXEL_BIPRED;
   }
 
@@ -883,7 +911,7 @@ smpUMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  curr
  *    used for fast motion estimation
  ************************************************************************
  */
-void smpUMHEX_decide_intrabk_SAD(Macroblock *currMB)
+void smpUMHEX_decide_intrabk_SAD(Macroblock *currMB, UMHexSMPContext *p_UMHexSMPCtx)
 {
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
@@ -893,19 +921,19 @@ void smpUMHEX_decide_intrabk_SAD(Macroblock *currMB)
   {
     if (currMB->pix_x == 0 && currMB->pix_y == 0)
     {
-      p_UMHexSMP->flag_intra_SAD = 0;
+      p_UMHexSMPCtx->flag_intra_SAD = 0;
     }
     else if (currMB->pix_x == 0)
     {
-      p_UMHexSMP->flag_intra_SAD = p_UMHexSMP->flag_intra[(currMB->pix_x)>>4];
+      p_UMHexSMPCtx->flag_intra_SAD = p_UMHexSMP->flag_intra[(currMB->pix_x)>>4];
     }
     else if (currMB->pix_y == 0)
     {
-      p_UMHexSMP->flag_intra_SAD = p_UMHexSMP->flag_intra[((currMB->pix_x)>>4)-1];
+      p_UMHexSMPCtx->flag_intra_SAD = p_UMHexSMP->flag_intra[((currMB->pix_x)>>4)-1];
     }
     else
     {
-      p_UMHexSMP->flag_intra_SAD = ((p_UMHexSMP->flag_intra[(currMB->pix_x)>>4])||
+      p_UMHexSMPCtx->flag_intra_SAD = ((p_UMHexSMP->flag_intra[(currMB->pix_x)>>4])||
         (p_UMHexSMP->flag_intra[((currMB->pix_x)>>4)-1])||
         (p_UMHexSMP->flag_intra[((currMB->pix_x)>>4)+1])) ;
     }
@@ -957,6 +985,7 @@ void smpUMHEX_skip_intrabk_SAD(Macroblock *currMB)
  ************************************************************************
  */
 void smpUMHEX_setup(Macroblock *currMB,
+                    UMHexSMPContext *p_UMHexSMPCtx,
                     short ref,
                     int list,
                     int block_y,
@@ -969,57 +998,57 @@ void smpUMHEX_setup(Macroblock *currMB,
 
   if (blocktype > 6)
   {
-    p_UMHexSMP->pred_MV_uplayer_X = all_mv[list][ref][5][block_y][block_x].mv_x;
-    p_UMHexSMP->pred_MV_uplayer_Y = all_mv[list][ref][5][block_y][block_x].mv_y;
+    p_UMHexSMPCtx->pred_MV_uplayer_X = all_mv[list][ref][5][block_y][block_x].mv_x;
+    p_UMHexSMPCtx->pred_MV_uplayer_Y = all_mv[list][ref][5][block_y][block_x].mv_y;
   }
   else if (blocktype > 4)
   {
-    p_UMHexSMP->pred_MV_uplayer_X = all_mv[list][ref][4][block_y][block_x].mv_x;
-    p_UMHexSMP->pred_MV_uplayer_Y = all_mv[list][ref][4][block_y][block_x].mv_y;
+    p_UMHexSMPCtx->pred_MV_uplayer_X = all_mv[list][ref][4][block_y][block_x].mv_x;
+    p_UMHexSMPCtx->pred_MV_uplayer_Y = all_mv[list][ref][4][block_y][block_x].mv_y;
   }
   else if (blocktype == 4)
   {
-    p_UMHexSMP->pred_MV_uplayer_X = all_mv[list][ref][2][block_y][block_x].mv_x;
-    p_UMHexSMP->pred_MV_uplayer_Y = all_mv[list][ref][2][block_y][block_x].mv_y;
+    p_UMHexSMPCtx->pred_MV_uplayer_X = all_mv[list][ref][2][block_y][block_x].mv_x;
+    p_UMHexSMPCtx->pred_MV_uplayer_Y = all_mv[list][ref][2][block_y][block_x].mv_y;
   }
   else if (blocktype > 1)
   {
-    p_UMHexSMP->pred_MV_uplayer_X = all_mv[list][ref][1][block_y][block_x].mv_x;
-    p_UMHexSMP->pred_MV_uplayer_Y = all_mv[list][ref][1][block_y][block_x].mv_y;
+    p_UMHexSMPCtx->pred_MV_uplayer_X = all_mv[list][ref][1][block_y][block_x].mv_x;
+    p_UMHexSMPCtx->pred_MV_uplayer_Y = all_mv[list][ref][1][block_y][block_x].mv_y;
   }
 
   if (blocktype > 1)
   {
     if (blocktype > 6)
     {
-      p_UMHexSMP->pred_SAD_uplayer = (list==1) ?
+      p_UMHexSMPCtx->pred_SAD_uplayer = (list==1) ?
         (p_UMHexSMP->l1_cost[5][(currMB->block_y)+block_y][(currMB->block_x)+block_x])
         : (p_UMHexSMP->l0_cost[5][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
-      p_UMHexSMP->pred_SAD_uplayer /= 2;
+      p_UMHexSMPCtx->pred_SAD_uplayer /= 2;
     }
     else if (blocktype > 4)
     {
-      p_UMHexSMP->pred_SAD_uplayer = (list==1) ?
+      p_UMHexSMPCtx->pred_SAD_uplayer = (list==1) ?
         (p_UMHexSMP->l1_cost[4][(currMB->block_y)+block_y][(currMB->block_x)+block_x])
         : (p_UMHexSMP->l0_cost[4][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
-      p_UMHexSMP->pred_SAD_uplayer /= 2;
+      p_UMHexSMPCtx->pred_SAD_uplayer /= 2;
     }
     else if (blocktype == 4)
     {
-      p_UMHexSMP->pred_SAD_uplayer = (list==1) ?
+      p_UMHexSMPCtx->pred_SAD_uplayer = (list==1) ?
         (p_UMHexSMP->l1_cost[2][(currMB->block_y)+block_y][(currMB->block_x)+block_x])
         : (p_UMHexSMP->l0_cost[2][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
-      p_UMHexSMP->pred_SAD_uplayer /= 2;
+      p_UMHexSMPCtx->pred_SAD_uplayer /= 2;
     }
     else
     {
-      p_UMHexSMP->pred_SAD_uplayer = (list==1) ?
+      p_UMHexSMPCtx->pred_SAD_uplayer = (list==1) ?
         (p_UMHexSMP->l1_cost[1][(currMB->block_y)+block_y][(currMB->block_x)+block_x])
         : (p_UMHexSMP->l0_cost[1][(currMB->block_y)+block_y][(currMB->block_x)+block_x]);
-      p_UMHexSMP->pred_SAD_uplayer /= 2;
+      p_UMHexSMPCtx->pred_SAD_uplayer /= 2;
     }
 
-    p_UMHexSMP->pred_SAD_uplayer = p_UMHexSMP->flag_intra_SAD ? 0 : p_UMHexSMP->pred_SAD_uplayer;
+    p_UMHexSMPCtx->pred_SAD_uplayer = p_UMHexSMPCtx->flag_intra_SAD ? 0 : p_UMHexSMPCtx->pred_SAD_uplayer;
   }
 }
 
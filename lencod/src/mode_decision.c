@@ -26,6 +26,7 @@
 #include "slice.h"
 #include "conformance.h"
 #include "rdopt.h"
+#include "mode_pruning.h"
 
 extern FILE *ourModes;
 
@@ -84,11 +85,14 @@ void end_encode_one_macroblock(Macroblock *currMB) {
     currSlice->rddata->min_rate = (double) currMB->min_rate;
 
     if (p_Inp->SearchMode == UM_HEX) {
-        UMHEX_skip_intrabk_SAD(currMB, currSlice->listXsize[currMB->list_offset]);
+        UMHEX_skip_intrabk_SAD(currMB, currSlice->p_UMHexCtx, currSlice->listXsize[currMB->list_offset]);
     } else if (p_Inp->SearchMode == UM_HEX_SIMPLE) {
         smpUMHEX_skip_intrabk_SAD(currMB);
     }
 
+    if (p_Inp->AdaptiveModePruning)
+        update_mode_pruning(currMB);
+
     //--- constrain intra prediction ---
     if (p_Inp->UseConstrainedIntraPred && (currSlice->slice_type == P_SLICE || currSlice->slice_type == B_SLICE)) {
         p_Vid->intra_block[currMB->mbAddrX] = IS_INTRA(currMB);
@@ -152,6 +156,9 @@ void init_enc_mb_params(Macroblock* currMB, RD_PARAMS *enc_mb, int intra) {
 
     //END DANIEL
 
+    if (p_Inp->AdaptiveModePruning)
+        prune_modes(currMB, enc_mb);
+
     if (currSlice->UseRDOQuant && p_Inp->RDOQ_CP_Mode && (p_Vid->qp != p_Vid->masterQP))
         RDOQ_update_mode(currSlice, enc_mb);
 
@@ -231,10 +238,9 @@ void init_enc_mb_params(Macroblock* currMB, RD_PARAMS *enc_mb, int intra) {
     currMB->c_ipred_mode = DC_PRED_8;
 
     if (p_Inp->SearchMode == UM_HEX) {
-        UMHEX_decide_intrabk_SAD(currMB);
-        UMHEX_DefineThresholdMB(p_Vid, p_Inp);
+        UMHEX_decide_intrabk_SAD(currMB, currSlice->p_UMHexCtx);
     } else if (p_Inp->SearchMode == UM_HEX_SIMPLE) {
-        smpUMHEX_decide_intrabk_SAD(currMB);
+        smpUMHEX_decide_intrabk_SAD(currMB, currSlice->p_UMHexSMPCtx);
     }
 
 }
@@ -263,6 +269,10 @@ void list_prediction_cost(Macroblock *currMB, int list, int block, int mode, RD_
                 if ((!p_Inp->sp2_frame_indicator && !p_Inp->sp_output_indicator) ||
                         ((p_Inp->sp2_frame_indicator || p_Inp->sp_output_indicator) && (currSlice->slice_type != P_SLICE && currSlice->slice_type != SP_SLICE)) ||
                         ((p_Inp->sp2_frame_indicator || p_Inp->sp_output_indicator) && ((currSlice->slice_type == P_SLICE || currSlice->slice_type == SP_SLICE) && (ref == 0)))) {
+                    // references skipped by the fast reference search are marked with DISTBLK_MAX
+                    if (p_Vid->motion_cost[mode][list][ref][block] == DISTBLK_MAX)
+                        continue;
+
                     mcost = ref_cost(currSlice, ref_lambda, (short) ref, cur_list);
 
                     mcost += p_Vid->motion_cost[mode][list][ref][block];
@@ -263,13 +263,10 @@ void submacroblock_mode_decision_p_slice(Macroblock *currMB,
     }
 #endif
 
-    if (!transform8x8)
-    {
-      if (min_cost8x8 != DISTBLK_MAX)
-        dataTr->mb_p8x8_cost += min_cost8x8;
-      else
-        dataTr->mb_p8x8_cost = DISTBLK_MAX;
-    }
+    if (min_cost8x8 != DISTBLK_MAX)
+      dataTr->mb_p8x8_cost += min_cost8x8;
+    else
+      dataTr->mb_p8x8_cost = DISTBLK_MAX;
 
     //----- set cbp and count of nonzero coefficients ---
     if (best_cnt_nonz)
@@ -610,13 +607,10 @@ void submacroblock_mode_decision_b_slice(Macroblock *currMB,
     }
 #endif
 
-    if (!transform8x8)
-    {
-      if (min_cost8x8 != DISTBLK_MAX)
-        dataTr->mb_p8x8_cost += min_cost8x8;
-      else
-        dataTr->mb_p8x8_cost = DISTBLK_MAX;
-    }
+    if (min_cost8x8 != DISTBLK_MAX)
+      dataTr->mb_p8x8_cost += min_cost8x8;
+    else
+      dataTr->mb_p8x8_cost = DISTBLK_MAX;
 
     //----- set cbp and count of nonzero coefficients ---
     if (best_cnt_nonz)
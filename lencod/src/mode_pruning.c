@@ -0,0 +1,225 @@
+/*!
+ *************************************************************************************
+ * \file mode_pruning.c
+ *
+ * \brief
+ *    Adaptive macroblock mode pruning
+ *
+ *    Counts, per slice type and neighbourhood, how often each partition wins the
+ *    mode decision on full search refresh frames. On the following frames of the
+ *    same slice type, partitions whose win rate is below AMPThreshold are not 
+ *    evaluated. Statistics are kept separately for each range of MP_QP_STEP slice
+ *    QPs, so that frames coded at different QPs (e.g. the levels of a hierarchical
+ *    GOP) neither share nor reset each other's statistics, and are rebuilt every
+ *    AMPRefreshPeriod frames of a slice type and QP range.
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "mode_pruning.h"
+
+//! inter partitions that may be pruned, P16x16 is always checked
+static const int prunable_mb_mode[3]  = { P16x8, P8x16, P8x8 };
+static const int prunable_sub_mode[3] = { SMB8x4, SMB4x8, SMB4x4 };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates the adaptive mode pruning statistics
+ *
+ * \return
+ *    memory size in bytes
+ ************************************************************************
+ */
+int init_mode_pruning(VideoParameters *p_Vid)
+{
+  ModePruning *mp;
+  int i, j;
+
+  if ((mp = (ModePruning *) calloc(1, sizeof(ModePruning))) == NULL)
+    no_mem_exit("init_mode_pruning: mp");
+
+  for (i = 0; i < MP_SLICE_TYPES; i++)
+  {
+    mp->frame_no[i] = -1;
+    for (j = 0; j < MP_QP_BUCKETS; j++)
+      mp->frames[i][j] = -1;
+  }
+
+  p_Vid->p_mode_prune = mp;
+
+  return sizeof(ModePruning);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the adaptive mode pruning statistics
+ ************************************************************************
+ */
+void free_mode_pruning(VideoParameters *p_Vid)
+{
+  if (p_Vid->p_mode_prune)
+  {
+    free(p_Vid->p_mode_prune);
+    p_Vid->p_mode_prune = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Statistics index of a slice, -1 for slices without inter partitions
+ ************************************************************************
+ */
+static inline int pruning_slice_index(Slice *currSlice)
+{
+  if (currSlice->slice_type == P_SLICE)
+    return 0;
+  else if (currSlice->slice_type == B_SLICE)
+    return 1;
+  else
+    return -1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Neighbourhood context: number of the left and upper macroblocks
+ *    that were coded with a partitioned or intra mode
+ ************************************************************************
+ */
+static inline int pruning_context(Macroblock *currMB)
+{
+  Macroblock *mb_data = currMB->p_Vid->mb_data;
+  int ctx = 0;
+
+  if (currMB->mbAvailA && mb_data[currMB->mbAddrA].mb_type > P16x16)
+    ++ctx;
+  if (currMB->mbAvailB && mb_data[currMB->mbAddrB].mb_type > P16x16)
+    ++ctx;
+
+  return ctx;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts a new frame of a slice type and decides whether it is a
+ *    full search refresh frame
+ ************************************************************************
+ */
+static void start_pruning_frame(ModePruning *mp, InputParameters *p_Inp, Slice *currSlice, int st)
+{
+  int b = iClip3(0, MP_QP_BUCKETS - 1, currSlice->qp / MP_QP_STEP);
+
+  mp->bucket[st] = b;
+  if (mp->frames[st][b] >= 0 && ++mp->frames[st][b] < p_Inp->AMPRefreshPeriod)
+  {
+    mp->refresh[st] = FALSE;
+  }
+  else
+  {
+    mp->refresh[st]   = TRUE;
+    mp->frames[st][b] = 0;
+    memset(mp->mb_count[st][b],  0, MP_CONTEXTS * sizeof(int));
+    memset(mp->sub_count[st][b], 0, MP_CONTEXTS * sizeof(int));
+    memset(mp->wins[st][b],      0, MP_CONTEXTS * MAXMODE * sizeof(int));
+  }
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Disables the inter partitions that rarely won in the macroblock neighbourhood
+ *    on the last refresh frame
+ *************************************************************************************
+ */
+void prune_modes(Macroblock *currMB, RD_PARAMS *enc_mb)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  InputParameters *p_Inp = currMB->p_Inp;
+  ModePruning *mp = p_Vid->p_mode_prune;
+  int st = pruning_slice_index(currMB->p_Slice);
+  int ctx, i, mode;
+  int *mb_count, *sub_count, (*wins)[MAXMODE];
+  double threshold = p_Inp->AMPThreshold / 100.0;
+
+  if (st < 0)
+    return;
+
+  if (mp->frame_no[st] != p_Vid->frame_no)
+  {
+    start_pruning_frame(mp, p_Inp, currMB->p_Slice, st);
+    mp->frame_no[st] = p_Vid->frame_no;
+  }
+
+  mb_count  = mp->mb_count[st][mp->bucket[st]];
+  sub_count = mp->sub_count[st][mp->bucket[st]];
+  wins      = mp->wins[st][mp->bucket[st]];
+
+  ctx = pruning_context(currMB);
+  if (mp->refresh[st] || mb_count[ctx] < MP_MIN_SAMPLES)
+    return;
+
+  ++mp->checked;
+
+  for (i = 0; i < 3; i++)
+  {
+    mode = prunable_mb_mode[i];
+    if (enc_mb->valid[mode] && wins[ctx][mode] < threshold * mb_count[ctx])
+    {
+      enc_mb->valid[mode] = 0;
+      ++mp->pruned[mode];
+    }
+  }
+
+  if (!enc_mb->valid[P8x8])
+  {
+    for (mode = SMB8x8; mode <= SMB4x4; mode++)
+      enc_mb->valid[mode] = 0;
+  }
+  else if (sub_count[ctx] >= MP_MIN_SAMPLES)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      mode = prunable_sub_mode[i];
+      if (enc_mb->valid[mode] && wins[ctx][mode] < threshold * sub_count[ctx])
+      {
+        enc_mb->valid[mode] = 0;
+        ++mp->pruned[mode];
+      }
+    }
+    enc_mb->valid[P8x8] = (short) (enc_mb->valid[SMB8x8] || enc_mb->valid[SMB8x4] || enc_mb->valid[SMB4x8] || enc_mb->valid[SMB4x4]);
+  }
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Counts the mode decision of a macroblock of a refresh frame
+ *************************************************************************************
+ */
+void update_mode_pruning(Macroblock *currMB)
+{
+  ModePruning *mp = currMB->p_Vid->p_mode_prune;
+  int st = pruning_slice_index(currMB->p_Slice);
+  int ctx, block, b;
+
+  if (st < 0 || !mp->refresh[st])
+    return;
+
+  b   = mp->bucket[st];
+  ctx = pruning_context(currMB);
+  ++mp->mb_count[st][b][ctx];
+  ++mp->wins[st][b][ctx][currMB->mb_type];
+
+  if (currMB->mb_type == P8x8)
+  {
+    for (block = 0; block < 4; block++)
+    {
+      ++mp->sub_count[st][b][ctx];
+      ++mp->wins[st][b][ctx][(int) currMB->b8x8[block].mode];
+    }
+  }
+}
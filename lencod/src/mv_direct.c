@@ -366,6 +366,48 @@ static void test_valid_direct(Slice *currSlice, seq_parameter_set_rbsp_t *active
   }
 }
 
+/*!
+*************************************************************************************
+* \brief
+*    Checks whether a co-located block is moving (i.e. not co-located zero)
+*************************************************************************************
+*/
+static inline int is_moving(PicMotionParams *fs)
+{
+  return !((((fs->ref_idx[LIST_0] == 0)
+    &&  (iabs(fs->mv[LIST_0].mv_x)>>1 == 0)
+    &&  (iabs(fs->mv[LIST_0].mv_y)>>1 == 0)))
+    || ((fs->ref_idx[LIST_0] == -1)
+    &&  (fs->ref_idx[LIST_1] == 0)
+    &&  (iabs(fs->mv[LIST_1].mv_x)>>1 == 0)
+    &&  (iabs(fs->mv[LIST_1].mv_y)>>1 == 0)));
+}
+
+/*!
+*************************************************************************************
+* \brief
+*    Returns the moving flags of all 4x4 blocks of a co-located picture.
+*    The motion of a stored reference does not change, so the flags are
+*    computed the first time the picture is used and then shared by all
+*    slices and mode evaluations.
+*************************************************************************************
+*/
+static byte **get_moving_blocks(StorablePicture *list1)
+{
+  if (list1->moving_block == NULL)
+  {
+    int i, j;
+    get_mem2D(&list1->moving_block, list1->size_y >> 2, list1->size_x >> 2);
+
+    for (j = 0; j < (list1->size_y >> 2); j++)
+    {
+      for (i = 0; i < (list1->size_x >> 2); i++)
+        list1->moving_block[j][i] = (byte) is_moving(&list1->mv_info[j][i]);
+    }
+  }
+  return list1->moving_block;
+}
+
 /*!
 *************************************************************************************
 * \brief
@@ -413,30 +455,15 @@ int get_colocated_info(Macroblock *currMB, StorablePicture *list1, int i, int j)
           }
         }
       }
-      moving = !((((fs->ref_idx[LIST_0] == 0)
-        &&  (iabs(fs->mv[LIST_0].mv_x)>>1 == 0)
-        &&  (iabs(fs->mv[LIST_0].mv_y)>>1 == 0)))
-        || ((fs->ref_idx[LIST_0] == -1)
-        &&  (fs->ref_idx[LIST_1] == 0)
-        &&  (iabs(fs->mv[LIST_1].mv_x)>>1 == 0)
-        &&  (iabs(fs->mv[LIST_1].mv_y)>>1 == 0)));
+      moving = is_moving(fs);
       return moving;
     }
     else
     {
-      PicMotionParams *fs = &list1->mv_info[RSD(j)][RSD(i)];
-      int moving;
       if(currMB->p_Vid->yuv_format == YUV444 && !currSlice->P444_joined)
-        fs = &list1->JVmv_info[(int)(p_Vid->colour_plane_id)][RSD(j)][RSD(i)];
-      moving= !((((fs->ref_idx[LIST_0] == 0)
-        &&  (iabs(fs->mv[LIST_0].mv_x)>>1 == 0)
-        &&  (iabs(fs->mv[LIST_0].mv_y)>>1 == 0)))
-        || ((fs->ref_idx[LIST_0] == -1)
-        &&  (fs->ref_idx[LIST_1] == 0)
-        &&  (iabs(fs->mv[LIST_1].mv_x)>>1 == 0)
-        &&  (iabs(fs->mv[LIST_1].mv_y)>>1 == 0)));
-
-      return moving;  
+        return is_moving(&list1->JVmv_info[(int)(p_Vid->colour_plane_id)][RSD(j)][RSD(i)]);
+
+      return get_moving_blocks(list1)[RSD(j)][RSD(i)];
     }
   }
 }
@@ -452,19 +479,7 @@ int get_colocated_info_4x4(Macroblock *currMB, StorablePicture *list1, int i, in
   if (list1->is_long_term)
     return 1;
   else
-  {
-    PicMotionParams *fs = &list1->mv_info[j][i];
-
-    int moving = !((((fs->ref_idx[LIST_0] == 0)
-      &&  (iabs(fs->mv[LIST_0].mv_x)>>1 == 0)
-      &&  (iabs(fs->mv[LIST_0].mv_y)>>1 == 0)))
-      || ((fs->ref_idx[LIST_0] == -1)
-      &&  (fs->ref_idx[LIST_1] == 0)
-      &&  (iabs(fs->mv[LIST_1].mv_x)>>1 == 0)
-      &&  (iabs(fs->mv[LIST_1].mv_y)>>1 == 0)));
-
-    return moving;  
-  }
+    return get_moving_blocks(list1)[j][i];
 }
 
 /*!
@@ -49,6 +49,8 @@
 #include "me_fullsearch.h"
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
+#include "me_pyramid.h"
+#include "me_hash.h"
 #include "rdoq.h"
 
 
@@ -89,6 +91,76 @@ void get_search_range(MEBlock *mv_block, InputParameters *p_Inp, short ref, int
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Adapts the search range of get_search_range to the neighbourhood of
+ *    the block. The vectors of the spatial neighbours A, B, C and of the
+ *    co-located block in the first reference give the spread around the
+ *    predictor and the motion magnitude. Agreeing neighbours with small
+ *    motion shrink the window, diverging ones let it grow back to the
+ *    static range.
+ ************************************************************************
+ */
+static void adapt_search_range(Macroblock *currMB, MEBlock *mv_block, MotionVector *pred)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  SearchWindow *searchRange = &mv_block->searchRange;
+  PicMotionParams **mv_info = p_Vid->enc_picture->mv_info;
+  StorablePicture *ref_picture = currMB->p_Slice->listX[(int) mv_block->list][0];
+  int list = mv_block->list;
+  int max_range = imax(searchRange->max_x, searchRange->max_y) >> 2;
+  int range = max_range;
+  int spread = 0, motion = 0, count = 0;
+  int i;
+  MotionVector mv[4];
+
+  for (i = 0; i < 3; i++)
+  {
+    PixelPos *block = &mv_block->block[i];
+    if (block->available && mv_info[block->pos_y][block->pos_x].ref_idx[list] >= 0)
+      mv[count++] = mv_info[block->pos_y][block->pos_x].mv[list];
+  }
+
+  if (ref_picture->mv_info != NULL && ref_picture->size_x == p_Vid->enc_picture->size_x 
+    && ref_picture->size_y == p_Vid->enc_picture->size_y)
+  {
+    PicMotionParams *colocated = &ref_picture->mv_info[mv_block->pos_y2][mv_block->pos_x2];
+    if (colocated->ref_idx[LIST_0] >= 0)
+      mv[count++] = colocated->mv[LIST_0];
+    else if (colocated->ref_idx[LIST_1] >= 0)
+      mv[count++] = colocated->mv[LIST_1];
+  }
+
+  // too little context to judge, keep the static range
+  if (count >= 2)
+  {
+    for (i = 0; i < count; i++)
+    {
+      spread = imax(spread, imax(iabs(mv[i].mv_x - pred->mv_x), iabs(mv[i].mv_y - pred->mv_y)));
+      motion = imax(motion, imax(iabs(mv[i].mv_x), iabs(mv[i].mv_y)));
+    }
+    // integer pels, rounded up
+    spread = (spread + 3) >> 2;
+    motion = (motion + 3) >> 2;
+
+    range = imax(imax(2, max_range >> 3), 2 * spread + motion + 1);
+    range = imin(range, max_range);
+
+    searchRange->max_x = imin(searchRange->max_x, range << 2);
+    searchRange->max_y = imin(searchRange->max_y, range << 2);
+    searchRange->min_x = -searchRange->max_x;
+    searchRange->min_y = -searchRange->max_y;
+  }
+
+  ++p_Vid->asr_searches;
+  p_Vid->asr_range_sum     += range;
+  p_Vid->asr_max_range_sum += max_range;
+  ++p_Vid->asr_frame_searches;
+  p_Vid->asr_frame_range_sum     += range;
+  p_Vid->asr_frame_max_range_sum += max_range;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -320,7 +392,9 @@ void Init_Motion_Search_Module (VideoParameters *p_Vid, InputParameters *p_Inp)
   int max_search_points          = imax(9, (2 * search_range + 1) * (2 * search_range + 1));
   int max_ref_bits               = 1 + 2 * (int)floor(log(imax(16, p_Vid->max_num_references + 1)) / log(2) + 1e-10);
   int max_ref                    = (1<<((max_ref_bits>>1)+1))-1;
-  int number_of_subpel_positions = 4 * (2*search_range+3);
+  int pyramid_range              = p_Inp->PyramidME ? (p_Inp->PyramidSearchRange << 2) + 2 * PYR_REFINE_RANGE : 0;
+  int hash_range                 = p_Inp->HashME ? imax(p_Vid->width, p_Vid->height) : 0;
+  int number_of_subpel_positions = 4 * (2*(search_range + pyramid_range + hash_range)+3);
   int max_mv_bits                = 3 + 2 * (int)ceil (log(number_of_subpel_positions + 1) / log(2) + 1e-10);
   int max_mvd                    = p_Inp->UseMVLimits? imax(4*imax(p_Inp->SetMVXLimit, p_Inp->SetMVYLimit), ((1<<( max_mv_bits >>1) ) - 1)): ((1<<( max_mv_bits >>1)) - 1);
   
@@ -478,6 +552,9 @@ void Init_Motion_Search_Module (VideoParameters *p_Vid, InputParameters *p_Inp)
 
     if (p_Inp->SearchMode == UM_HEX)
       UMHEX_DefineThreshold(p_Vid);
+
+    if (p_Inp->PyramidME)
+      init_me_pyramid(p_Vid, p_Inp);
   }
 }
 
@@ -521,6 +598,9 @@ Clear_Motion_Search_Module (VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if ((p_Inp->SearchMode == FAST_FULL_SEARCH) && (!p_Inp->IntraProfile) )
     ClearFastFullIntegerSearch (p_Vid);
+
+  if (p_Vid->p_pyramid)
+    free_me_pyramid (p_Vid);
 }
 static inline int mv_bits_cost(VideoParameters *p_Vid, short ***all_mv, short ***p_mv, int by, int bx, int step_v0, int step_v, int step_h0, int step_h, int mvd_bits)
 {
@@ -704,6 +784,8 @@ void init_mv_block(Macroblock *currMB, MEBlock *mv_block, short blocktype, int l
   // Init WP parameters
   mv_block->p_Vid             = p_Vid;
   mv_block->p_Slice           = currSlice;
+  mv_block->p_UMHexCtx        = currSlice->p_UMHexCtx;
+  mv_block->p_UMHexSMPCtx     = currSlice->p_UMHexSMPCtx;
   mv_block->cost              = INT_MAX;
   mv_block->search_pos2       = 9;
   mv_block->search_pos4       = 9;
@@ -712,6 +794,12 @@ void init_mv_block(Macroblock *currMB, MEBlock *mv_block, short blocktype, int l
     get_mem2Dpel(&mv_block->orig_pic, 3, mv_block->blocksize_x * mv_block->blocksize_y);
   else
     get_mem2Dpel(&mv_block->orig_pic, 1, mv_block->blocksize_x * mv_block->blocksize_y);
+
+  if (p_Inp->BiPredMotionEstimation)
+    get_mem2Dint(&mv_block->bipred_target, p_Inp->ChromaMEEnable ? 3 : 1, mv_block->blocksize_x * mv_block->blocksize_y);
+  else
+    mv_block->bipred_target = NULL;
+  mv_block->bipred_ref = NULL;
   
   mv_block->ChromaMEEnable = p_Inp->ChromaMEEnable;
 
@@ -768,6 +856,11 @@ void free_mv_block(MEBlock *mv_block)
   {
     free_mem2Dpel(mv_block->orig_pic);
   }
+  if (mv_block->bipred_target)
+  {
+    free_mem2Dint(mv_block->bipred_target);
+    mv_block->bipred_target = NULL;
+  }
 }
 
 
@@ -890,13 +983,13 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   //===========================================
   if (p_Inp->SearchMode == UM_HEX)
   {
-    p_Vid->p_UMHex->UMHEX_blocktype = blocktype;
-    p_Vid->p_UMHex->bipred_flag = 0;
+    mv_block->p_UMHexCtx->UMHEX_blocktype = blocktype;
+    mv_block->p_UMHexCtx->bipred_flag = 0;
     UMHEXSetMotionVectorPredictor(currMB, &pred, p_Vid->enc_picture->mv_info, ref, list, mb_x, mb_y, bsx, bsy, mv_block);
   }
   else if (p_Inp->SearchMode == UM_HEX_SIMPLE)
   {
-    smpUMHEX_setup(currMB, ref, list, block_y, block_x, blocktype, currSlice->all_mv );
+    smpUMHEX_setup(currMB, mv_block->p_UMHexSMPCtx, ref, list, block_y, block_x, blocktype, currSlice->all_mv );
     currMB->GetMVPredictor (currMB, mv_block->block, &pred, ref, p_Vid->enc_picture->mv_info, list, mb_x, mb_y, bsx, bsy);
   }
   else
@@ -924,6 +1017,13 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
 #endif
   }
 
+  if (p_Inp->AdaptiveSearchRange && currMB->list_offset == 0)
+    adapt_search_range(currMB, mv_block, &pred);
+
+  // not used in MBAFF frames; field macroblocks have no coarse vectors
+  if (p_Vid->p_pyramid && !currSlice->mb_aff_frame_flag)
+    set_pyramid_center(currMB, mv_block, &pred, lambda_factor[F_PEL]);
+
   if (!p_Inp->rdopt)
   {
     MotionVector center = *mv;
@@ -941,6 +1041,9 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   //--- perform motion search ---
   min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
 
+  if (p_Inp->HashME && currMB->list_offset == 0)
+    min_mcost = hash_me_search(currMB, mv_block, &pred, min_mcost, lambda_factor[F_PEL]);
+
   //==============================
   //=====   SUB-PEL SEARCH   =====
   //============================== 
@@ -1006,6 +1109,27 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
 }
 
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Materializes the prediction kept fixed while the bipred search of
+ *    list refines the other one
+ ***********************************************************************
+ */
+static void prepare_bipred_target(Macroblock *currMB, MEBlock *mv_block, int list, MotionVector *fixed_mv, int fixed_first)
+{
+  Slice *currSlice = currMB->p_Slice;
+  MotionVector mv = pad_MVs(*fixed_mv, mv_block);
+
+  if (mv_block->bipred_target == NULL)
+    return;
+
+  if (fixed_first)
+    set_bipred_target(mv_block, currSlice->listX[list + currMB->list_offset][(short) mv_block->ref_idx], &mv, 1);
+  else
+    set_bipred_target(mv_block, currSlice->listX[(list ^ 1) + currMB->list_offset][0], &mv, 2);
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -1027,6 +1151,7 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
   short       bipred_type = list ? 0 : 1;
   MotionVector ***** bipred_mv = currSlice->bipred_mv[bipred_type];
   distblk     min_mcostbi = DISTBLK_MAX;
+  distblk     prev_mcostbi;
   MotionVector *mv = &mv_block->mv[list];
   MotionVector bimv, tempmv;
   MotionVector pred_mv1, pred_mv2, pred_bi;
@@ -1043,7 +1168,7 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 
   if (p_Inp->SearchMode == UM_HEX)
   {
-    p_Vid->p_UMHex->bipred_flag = 1;
+    mv_block->p_UMHexCtx->bipred_flag = 1;
     UMHEXSetMotionVectorPredictor(currMB, &pred_bi, p_Vid->enc_picture->mv_info, 0, list ^ 1, mb_x, mb_y, bsx, bsy, mv_block);
   }
   else
@@ -1061,6 +1186,8 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
     bimv = pred_bi;
   }
 
+  ++p_Vid->bipred_me_searches;
+
   //Bi-predictive motion Refinements
   for (mv_block->iteration_no = 0; mv_block->iteration_no <= p_Inp->BiPredMERefinements; mv_block->iteration_no++)
   {
@@ -1084,6 +1211,15 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
     tempmv = *bi_mv1;
 
     PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist, currMB->list_offset, mv_block->ref_idx);
+    // The UMHEX searches pass the fixed prediction first (smpUMHEX with the vector of the other list)
+    if (p_Inp->SearchMode == UM_HEX)
+      prepare_bipred_target(currMB, mv_block, iterlist, bi_mv1, TRUE);
+    else if (p_Inp->SearchMode == UM_HEX_SIMPLE)
+      prepare_bipred_target(currMB, mv_block, iterlist, bi_mv2, TRUE);
+    else
+      prepare_bipred_target(currMB, mv_block, iterlist, bi_mv2, FALSE);
+
+    prev_mcostbi = min_mcostbi;
     // Get bipred mvs for list iterlist given previously computed mvs from other list
     min_mcostbi = currMB->BiPredME (currMB, iterlist, 
       &pred_mv1, &pred_mv2, bi_mv1, bi_mv2, mv_block, 
@@ -1093,6 +1229,14 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
     {
       break;
     }
+
+    // converged: the iteration lowered the cost by less than BiPredMEConvergence percent
+    if (mv_block->iteration_no > 0 && p_Inp->BiPredMEConvergence 
+      && (double) (prev_mcostbi - min_mcostbi) * 100.0 < (double) prev_mcostbi * p_Inp->BiPredMEConvergence)
+    {
+      ++p_Vid->bipred_me_converged;
+      break;
+    }
   }
 
   if (!p_Inp->DisableSubpelME)
@@ -1102,6 +1246,7 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 			if ( !p_Vid->start_me_refinement_hp )
 				min_mcostbi = DISTBLK_MAX;
       PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist, currMB->list_offset, mv_block->ref_idx);
+      prepare_bipred_target(currMB, mv_block, iterlist, bi_mv2, FALSE);
 
       min_mcostbi =  currMB->SubPelBiPredME (currMB, mv_block, iterlist, &pred_mv1, &pred_mv2, bi_mv1, bi_mv2, min_mcostbi, lambda_factor);
     }
@@ -1111,10 +1256,12 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 			if ( !p_Vid->start_me_refinement_qp )
         min_mcostbi = DISTBLK_MAX;
       PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist ^ 1, currMB->list_offset, mv_block->ref_idx);
+      prepare_bipred_target(currMB, mv_block, iterlist ^ 1, bi_mv1, FALSE);
 
       min_mcostbi =  currMB->SubPelBiPredME (currMB, mv_block, iterlist ^ 1, &pred_mv2, &pred_mv1, bi_mv2, bi_mv1, min_mcostbi, lambda_factor);
     }
   }
+  mv_block->bipred_ref = NULL;
 
   clip_mv_range(p_Vid, 0, bi_mv1, Q_PEL);
   clip_mv_range(p_Vid, 0, bi_mv2, Q_PEL);
@@ -1555,6 +1702,56 @@ distblk GetDirectCostMB (Macroblock *currMB)
   return cost;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Checks whether the references beyond ref 1 can be skipped for a
+ *    block: ref 1 did not improve on ref 0 and none of the left, upper
+ *    and upper right neighbours outside the macroblock uses them
+ ************************************************************************
+ */
+static int skip_far_references(Macroblock *currMB, int list, distblk **ref_cost, int block8x8, int bx, int by, int width)
+{
+  PicMotionParams **motion = currMB->p_Vid->enc_picture->mv_info;
+  int *mb_size = currMB->p_Vid->mb_size[IS_LUMA];
+  PixelPos pos[3];
+  int i;
+
+  if (ref_cost[1][block8x8] < ref_cost[0][block8x8])
+    return FALSE;
+
+  get4x4Neighbour(currMB, (bx << 2) - 1, (by << 2)    , mb_size, &pos[0]);
+  get4x4Neighbour(currMB, (bx << 2)    , (by << 2) - 1, mb_size, &pos[1]);
+  get4x4Neighbour(currMB, (bx << 2) + width, (by << 2) - 1, mb_size, &pos[2]);
+
+  for (i = 0; i < 3; i++)
+  {
+    if (pos[i].available && pos[i].mb_addr != currMB->mbAddrX && motion[pos[i].pos_y][pos[i].pos_x].ref_idx[list] > 1)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Marks a skipped reference so that it is never selected; its vectors
+ *    are taken from ref 1 for the predictors of later searches
+ ************************************************************************
+ */
+static void skip_reference(Slice *currSlice, distblk *m_cost, int list, int ref, int blocktype, int bx, int by, int step_h, int step_v)
+{
+  MotionVector **src = currSlice->all_mv[list][1][blocktype];
+  MotionVector **dst = currSlice->all_mv[list][ref][blocktype];
+  int j;
+
+  for (j = by; j < by + step_v; j++)
+    memcpy(&dst[j][bx], &src[j][bx], step_h * sizeof(MotionVector));
+
+  *m_cost = DISTBLK_MAX;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -1622,6 +1819,7 @@ void PartitionMotionSearch (Macroblock *currMB,
     short ref = 0;
     MEBlock  mv_block;
     distblk *m_cost;
+    int   skip_refs;
 
 
     PicMotionParams **motion = p_Vid->enc_picture->mv_info;  
@@ -1648,11 +1846,28 @@ void PartitionMotionSearch (Macroblock *currMB,
       {
         //----- set arrays -----
         mv_block.list = (char) list;
+        skip_refs = FALSE;
         for (ref=0; ref < currSlice->listXsize[list+list_offset]; ref++) 
         {
+#if GET_REF_METIME
+            TIME_T ref_time_start;
+            TIME_T ref_time_end;
+#endif
             mv_block.ref_idx = (char) ref;
             m_cost = &p_Vid->motion_cost[blocktype][list][ref][block8x8];
 
+            if (ref == 2 && p_Inp->FastRefSearch)
+              skip_refs = skip_far_references(currMB, list, p_Vid->motion_cost[blocktype][list], block8x8, bx, by, step_h << 2);
+            if (skip_refs)
+            {
+              skip_reference(currSlice, m_cost, list, ref, blocktype, bx, by, step_h, step_v);
+              ++p_Vid->me_ref_skipped[ref];
+              continue;
+            }
+
+#if GET_REF_METIME
+            gettime(&ref_time_start);
+#endif
             {
               //----- set search range ---
               get_search_range(&mv_block, p_Inp, ref, blocktype);
@@ -1662,6 +1877,11 @@ void PartitionMotionSearch (Macroblock *currMB,
             }
             //--- set motion vectors and reference frame ---            
             set_me_parameters(motion, &currSlice->all_mv[list][ref][blocktype][by][bx], list, (char) ref, step_h, step_v, pic_block_y, pic_block_x);
+#if GET_REF_METIME
+            gettime(&ref_time_end);
+            p_Vid->me_ref_time[ref] += timediff(&ref_time_start, &ref_time_end);
+#endif
+            ++p_Vid->me_ref_searched[ref];
         }
       }
     }
@@ -1765,6 +1985,7 @@ void SubPartitionMotionSearch (Macroblock *currMB,
     distblk  mcost; 
     int   v, h;
     int   pic_block_y;
+    int   skip_refs;
 
     // Set if 8x8 transform will be used if SATD is used
     mv_block.test8x8 = p_Inp->Transform8x8Mode && blocktype == 4;
@@ -1796,38 +2017,62 @@ void SubPartitionMotionSearch (Macroblock *currMB,
     for (list=0; list<numlists;list++)
     {
       mv_block.list = (char) list;
+      skip_refs = FALSE;
       for (ref=0; ref < currSlice->listXsize[list+list_offset]; ref++)
       {
+#if GET_REF_METIME
+          TIME_T ref_time_start;
+          TIME_T ref_time_end;
+#endif
           mv_block.ref_idx = (char) ref;
           m_cost = &p_Vid->motion_cost[blocktype][list][ref][block8x8];
-          //----- set search range ---
-          get_search_range(&mv_block, p_Inp, ref, blocktype);
-
-          //----- init motion cost -----
-          *m_cost = 0;
 
-          //===== LOOP OVER SUB MACRO BLOCK partitions
-          for (v=by; v<by + step_v0; v += step_v)
+          if (ref == 2 && p_Inp->FastRefSearch)
+            skip_refs = skip_far_references(currMB, list, p_Vid->motion_cost[blocktype][list], block8x8, bx, by, step_h0 << 2);
+          if (skip_refs)
           {
-            pic_block_y = currMB->block_y + v;
+            skip_reference(currSlice, m_cost, list, ref, blocktype, bx, by, step_h0, step_v0);
+            ++p_Vid->me_ref_skipped[ref];
+          }
+          else
+          {
+#if GET_REF_METIME
+            gettime(&ref_time_start);
+#endif
+            //----- set search range ---
+            get_search_range(&mv_block, p_Inp, ref, blocktype);
+
+            //----- init motion cost -----
+            *m_cost = 0;
 
-            for (h=bx; h<bx+step_h0; h+=step_h)
+            //===== LOOP OVER SUB MACRO BLOCK partitions
+            for (v=by; v<by + step_v0; v += step_v)
             {
-              all_mv = &currSlice->all_mv[list][ref][blocktype][v][h];
+              pic_block_y = currMB->block_y + v;
 
-              //--- motion search for block ---          
-              update_mv_block(currMB, &mv_block, h, v);
+              for (h=bx; h<bx+step_h0; h+=step_h)
               {
-                //----- set search range ---
-                get_search_range(&mv_block, p_Inp, ref, blocktype);
+                all_mv = &currSlice->all_mv[list][ref][blocktype][v][h];
 
-                mcost = BlockMotionSearch (currMB, &mv_block, h<<2, v<<2, lambda_factor);
+                //--- motion search for block ---          
+                update_mv_block(currMB, &mv_block, h, v);
+                {
+                  //----- set search range ---
+                  get_search_range(&mv_block, p_Inp, ref, blocktype);
 
-                *m_cost += mcost;
+                  mcost = BlockMotionSearch (currMB, &mv_block, h<<2, v<<2, lambda_factor);
+
+                  *m_cost += mcost;
+                }
+                //--- set motion vectors and reference frame (for motion vector prediction) ---
+                set_me_parameters(motion, all_mv, list, (char) ref, step_h, step_v, pic_block_y, currMB->block_x + h);
               }
-              //--- set motion vectors and reference frame (for motion vector prediction) ---
-              set_me_parameters(motion, all_mv, list, (char) ref, step_h, step_v, pic_block_y, currMB->block_x + h);
             }
+#if GET_REF_METIME
+            gettime(&ref_time_end);
+            p_Vid->me_ref_time[ref] += timediff(&ref_time_start, &ref_time_end);
+#endif
+            ++p_Vid->me_ref_searched[ref];
           }
 
           if ((p_Inp->Transform8x8Mode == 1) && p_Inp->RDOQ_CP_MV && (blocktype == 4))
@@ -73,26 +73,39 @@ void SODBtoRBSP(Bitstream *currStream)
 
 int RBSPtoEBSP(byte *NaluBuffer, unsigned char *rbsp, int rbsp_size)
 {
-  int j     = 0;
-  int count = 0;
-  int i;
-
-  for(i = 0; i < rbsp_size; i++)
+  const byte *end   = rbsp + rbsp_size;
+  const byte *last  = rbsp + imax(rbsp_size - ZEROBYTES_SHORTSTARTCODE, 0); // end of the bytes that may start an escaped pair
+  const byte *start = rbsp;   // first byte not yet copied
+  const byte *cur   = rbsp;   // first byte that may start a zero pair
+  byte *dst = NaluBuffer;
+
+  // Emulation is only possible after a zero byte. Zero bytes are located
+  // with memchr, and the runs between escapes are copied with memcpy.
+  while (cur < last)
   {
-    if(count == ZEROBYTES_SHORTSTARTCODE && !(rbsp[i] & 0xFC))
+    const byte *zero = (const byte *) memchr(cur, 0x00, last - cur);
+
+    if (zero == NULL)
+      break;
+
+    if (zero[1] == 0x00 && !(zero[2] & 0xFC))
     {
-      NaluBuffer[j] = 0x03;
-      j++;
-      count = 0;
+      size_t run = (zero + ZEROBYTES_SHORTSTARTCODE) - start;
+
+      memcpy(dst, start, run);
+      dst += run;
+      *dst++ = 0x03;
+      start = zero + ZEROBYTES_SHORTSTARTCODE;
     }
-    NaluBuffer[j] = rbsp[i];
-    if(rbsp[i] == 0x00)
-      count++;
-    else
-      count = 0;
-    j++;
+    // the next zero pair can not start before zero + 2, either because
+    // zero[1] is non zero or zero[2] is non zero or the pair was escaped
+    cur = zero + 2;
   }
-  return j;
+
+  memcpy(dst, start, end - start);
+  dst += end - start;
+
+  return (int) (dst - NaluBuffer);
 }
 
 /*!
@@ -16,6 +16,7 @@
  */
 
 #include <limits.h>
+#include <math.h>
 
 #include "global.h"
 
@@ -29,6 +30,7 @@
 #include "q_around.h"
 #include "intra4x4.h"
 #include "intra8x8.h"
+#include "rd_intra_threads.h"
 #include "md_common.h"
 #include "transform8x8.h"
 #include "md_distortion.h"
@@ -40,6 +42,84 @@
 
 extern int MBType2Value (Macroblock* currMB);
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    Lagrangian multiplier for the preselection costs of the fast intra RDO.
+ *    The costs use the mode decision metric, i.e. the multiplier has to be
+ *    the square root of the RDO multiplier unless the metric is SSE.
+ *************************************************************************************
+ */
+static int fast_intra_lambda(InputParameters *p_Inp, int lambda)
+{
+  if (p_Inp->ModeDecisionMetric == ERROR_SSE)
+    return lambda;
+  else
+    return LAMBDA_FACTOR(sqrt((double) lambda / (double) (1 << LAMBDA_ACCURACY_BITS)));
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Ranks the intra prediction modes by their preselection cost (equal costs
+ *    keep the lower mode first) and marks the best top_k modes and the most
+ *    probable mode for full RDO. Unavailable modes have a cost of DISTBLK_MAX.
+ *
+ * \param mode_cost
+ *    preselection cost of each mode
+ * \param mostProbableMode
+ *    most probable mode, always checked with RDO
+ * \param top_k
+ *    number of best ranked modes that are checked with RDO
+ * \param rdo_mode
+ *    returns 1 for the modes that have to be checked with RDO
+ * \param mode_rank
+ *    returns the rank of each available mode
+ *************************************************************************************
+ */
+static void select_intra_rdo_modes(distblk mode_cost[NO_INTRA_PMODE], int mostProbableMode, int top_k, byte rdo_mode[NO_INTRA_PMODE], byte mode_rank[NO_INTRA_PMODE])
+{
+  int order[NO_INTRA_PMODE];
+  int num_modes = 0;
+  int ipmode, i;
+
+  for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+  {
+    rdo_mode [ipmode] = 0;
+    mode_rank[ipmode] = 0;
+
+    if (mode_cost[ipmode] == DISTBLK_MAX)
+      continue;
+
+    for (i = num_modes; i > 0 && mode_cost[order[i - 1]] > mode_cost[ipmode]; i--)
+      order[i] = order[i - 1];
+    order[i] = ipmode;
+    num_modes++;
+  }
+
+  for (i = 0; i < num_modes; i++)
+  {
+    mode_rank[order[i]] = (byte) i;
+    rdo_mode [order[i]] = (byte) (i < top_k);
+  }
+
+  if (mode_cost[mostProbableMode] != DISTBLK_MAX)
+    rdo_mode[mostProbableMode] = 1;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Number of intra 4x4/8x8 modes passed to RDO for the QP of the macroblock
+ *************************************************************************************
+ */
+static inline int fast_intra_top_k(Macroblock *currMB)
+{
+  InputParameters *p_Inp = currMB->p_Inp;
+
+  return (currMB->qp < p_Inp->FastIntraQPThreshold) ? p_Inp->FastIntraTopKLowQP : p_Inp->FastIntraTopK;
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -52,6 +132,7 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   InputParameters *p_Inp = currMB->p_Inp;
   Slice *currSlice = currMB->p_Slice;
   RDOPTStructure  *p_RDO = currSlice->p_RDO;
+  IntraThreads    *p_IT  = get_intra_threads(currSlice);
 
   int     ipmode, best_ipmode = 0, y;
   int     available_mode;
@@ -82,6 +163,10 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   int block_x4 = block_x>>2;
   int block_y4 = block_y>>2;
 
+  byte rdo_mode [NO_INTRA_PMODE];
+  byte mode_rank[NO_INTRA_PMODE];
+  byte mode_cand[NO_INTRA_PMODE];
+
 #ifdef BEST_NZ_COEFF
   int best_coded_block_flag = 0;
   int bit_pos = 1 + ((((b8>>1)<<1)+(b4>>1))<<2) + (((b8&1)<<1)+(b4&1));
@@ -113,30 +198,73 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   // set intra prediction values for 4x4 intra prediction
   currSlice->set_intrapred_4x4(currMB, PLANE_Y, pic_pix_x, pic_pix_y, &left_available, &up_available, &all_available);  
 
-  //===== LOOP OVER ALL 4x4 INTRA PREDICTION MODES =====
+  //===== PRESELECTION OF THE MODES CHECKED WITH RDO =====
+  if (p_Inp->FastIntraRDO)
+  {
+    distblk mode_cost[NO_INTRA_PMODE];
+    int     rank_lambda = fast_intra_lambda(p_Inp, lambda);
+    distblk fixedcost   = weighted_cost(rank_lambda, 4);
+    distblk onecost     = weighted_cost(rank_lambda, 1);
+
+    for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    {
+      available_mode =  (all_available) || (ipmode==DC_PRED) ||
+        (up_available && (ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED)) ||
+        (left_available && (ipmode==HOR_PRED||ipmode==HOR_UP_PRED));
+
+      mode_cost[ipmode] = DISTBLK_MAX;
+      if (available_mode && valid_intra_mode(currSlice, ipmode) != 0)
+      {
+        get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
+        mode_cost[ipmode]  = (ipmode == mostProbableMode) ? onecost : fixedcost;
+        mode_cost[ipmode] += currSlice->compute_cost4x4(p_Vid, &p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], pic_opix_x, DISTBLK_MAX);
+      }
+    }
+    select_intra_rdo_modes(mode_cost, mostProbableMode, fast_intra_top_k(currMB), rdo_mode, mode_rank);
+  }
+
+  //===== MODES CHECKED WITH RDO =====
   for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
   {
     available_mode =  (all_available) || (ipmode==DC_PRED) ||
       (up_available && (ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED)) ||
       (left_available && (ipmode==HOR_PRED||ipmode==HOR_UP_PRED));
 
-    if (valid_intra_mode(currSlice, ipmode) == 0)
-      continue;
+    mode_cand[ipmode] = (byte) (available_mode && valid_intra_mode(currSlice, ipmode) != 0 && (!p_Inp->FastIntraRDO || rdo_mode[ipmode]));
+  }
+
+  // the workers code all candidates once the coding state is the stored one
+  if (p_IT && p_IT->ready)
+    intra_threads_evaluate_4x4(currMB, b8, b4, lambda, mostProbableMode, left_available, up_available, mode_cand, 0);
 
-    if( available_mode)
+  //===== LOOP OVER ALL 4x4 INTRA PREDICTION MODES =====
+  for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+  {
+    if (mode_cand[ipmode])
     {
-      // generate intra 4x4 prediction block given availability
-      get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
+      if (p_IT && p_IT->done[ipmode])
+      {
+        rdcost = intra_threads_replay_4x4 (currMB, b8, b4, ipmode, min_rdcost, &c_nz);
+      }
+      else
+      {
+        // generate intra 4x4 prediction block given availability
+        get_intrapred_4x4(currMB, PLANE_Y, ipmode, block_x, block_y, left_available, up_available);
 
-      // get prediction and prediction error
-      generate_pred_error_4x4(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_opix_x, block_x);     
+        // get prediction and prediction error
+        generate_pred_error_4x4(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_opix_x, block_x);     
 
-      // get and check rate-distortion cost
+        // get and check rate-distortion cost
 #ifdef BEST_NZ_COEFF
-      currMB->cbp_bits[0] = cbp_bits;
+        currMB->cbp_bits[0] = cbp_bits;
 #endif      
 
-      rdcost = currSlice->rdcost_for_4x4_intra_blocks (currMB, &c_nz, b8, b4, ipmode, lambda, mostProbableMode, min_rdcost);
+        rdcost = currSlice->rdcost_for_4x4_intra_blocks (currMB, &c_nz, b8, b4, ipmode, lambda, mostProbableMode, min_rdcost);
+
+        if (p_IT && !p_IT->ready)
+          intra_threads_evaluate_4x4(currMB, b8, b4, lambda, mostProbableMode, left_available, up_available, mode_cand, ipmode + 1);
+      }
+
       if ((rdcost < min_rdcost) || (rdcost == min_rdcost && ipmode == mostProbableMode))
       {
         //--- set coefficients ---
@@ -182,6 +310,9 @@ int mode_decision_for_I4x4_blocks_JM_High (Macroblock *currMB, int  b8,  int  b4
   cbp_bits |= (int64)(best_coded_block_flag<<bit_pos);
 #endif
 
+  if (p_Inp->FastIntraRDO)
+    p_Vid->fast_intra_rank[0][mode_rank[best_ipmode]]++;
+
   //===== set intra mode prediction =====
   p_Vid->ipredmode[pic_block_y][pic_block_x] = (char) best_ipmode;
   currMB->intra_pred_modes[4*b8+b4] =
@@ -224,6 +355,7 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
   InputParameters *p_Inp = currMB->p_Inp;
   Slice *currSlice = currMB->p_Slice;
   RDOPTStructure  *p_RDO = currSlice->p_RDO;
+  IntraThreads    *p_IT  = get_intra_threads(currSlice);
 
   int     ipmode, best_ipmode = 0, j;
   int     c_nz, nonzero = 0;  
@@ -253,6 +385,10 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
 
   int *mb_size = p_Vid->mb_size[IS_LUMA];
 
+  byte rdo_mode [NO_INTRA_PMODE];
+  byte mode_rank[NO_INTRA_PMODE];
+  byte mode_cand[NO_INTRA_PMODE];
+
   get4x4Neighbour(currMB, block_x - 1, block_y    , mb_size, &left_block);
   get4x4Neighbour(currMB, block_x,     block_y - 1, mb_size, &top_block );
 
@@ -280,23 +416,69 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
   //===== INTRA PREDICTION FOR 8x8 BLOCK =====
   currSlice->set_intrapred_8x8(currMB, PLANE_Y, pic_pix_x, pic_pix_y, &left_available, &up_available, &all_available);
 
-  //===== LOOP OVER ALL 8x8 INTRA PREDICTION MODES =====
+  //===== PRESELECTION OF THE MODES CHECKED WITH RDO =====
+  if (p_Inp->FastIntraRDO)
+  {
+    distblk mode_cost[NO_INTRA_PMODE];
+    int     rank_lambda = fast_intra_lambda(p_Inp, lambda);
+    distblk fixedcost   = weighted_cost(rank_lambda, 4);
+    distblk onecost     = weighted_cost(rank_lambda, 1);
+
+    for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+    {
+      mode_cost[ipmode] = DISTBLK_MAX;
+      if( (ipmode==DC_PRED) ||
+        ((ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED) && up_available ) ||
+        ((ipmode==HOR_PRED||ipmode==HOR_UP_PRED) && left_available ) ||
+        (all_available) )
+      {
+        get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
+        mode_cost[ipmode]  = (ipmode == mostProbableMode) ? onecost : fixedcost;
+        mode_cost[ipmode] += currSlice->compute_cost8x8(p_Vid, &p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], pic_opix_x, DISTBLK_MAX);
+      }
+    }
+    select_intra_rdo_modes(mode_cost, mostProbableMode, fast_intra_top_k(currMB), rdo_mode, mode_rank);
+  }
+
+  //===== MODES CHECKED WITH RDO =====
   for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
   {
-    if( (ipmode==DC_PRED) ||
+    mode_cand[ipmode] = (byte) ((!p_Inp->FastIntraRDO || rdo_mode[ipmode]) &&
+      ((ipmode==DC_PRED) ||
       ((ipmode==VERT_PRED||ipmode==VERT_LEFT_PRED||ipmode==DIAG_DOWN_LEFT_PRED) && up_available ) ||
       ((ipmode==HOR_PRED||ipmode==HOR_UP_PRED) && left_available ) ||
-      (all_available) )
+      (all_available)));
+  }
+
+  // the workers code all candidates once the coding state is the stored one
+  if (p_IT && p_IT->ready)
+    intra_threads_evaluate_8x8(currMB, b8, lambda, mostProbableMode, left_available, up_available, mode_cand, 0);
+
+  //===== LOOP OVER ALL 8x8 INTRA PREDICTION MODES =====
+  for (ipmode = 0; ipmode < NO_INTRA_PMODE; ipmode++)
+  {
+    if (mode_cand[ipmode])
     {
-      get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
-      // get prediction and prediction error
-      generate_pred_error_8x8(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], &mb_pred[block_y], &mb_ores[block_y], pic_opix_x, block_x);     
+      if (p_IT && p_IT->done[ipmode])
+      {
+        rdcost = intra_threads_replay_8x8 (currMB, b8, ipmode, min_rdcost, &c_nz);
+      }
+      else
+      {
+        get_intrapred_8x8(currMB, PLANE_Y, ipmode, left_available, up_available);
+        // get prediction and prediction error
+        generate_pred_error_8x8(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], &mb_pred[block_y], &mb_ores[block_y], pic_opix_x, block_x);     
+
+        currMB->ipmode_DPCM = (short) ipmode;
 
-      currMB->ipmode_DPCM = (short) ipmode;
+        // get and check rate-distortion cost
 
-      // get and check rate-distortion cost
+        rdcost = currSlice->rdcost_for_8x8_intra_blocks (currMB, &c_nz, b8, ipmode, lambda, min_rdcost, mostProbableMode);
+
+        if (p_IT && !p_IT->ready)
+          intra_threads_evaluate_8x8(currMB, b8, lambda, mostProbableMode, left_available, up_available, mode_cand, ipmode + 1);
+      }
 
-      rdcost = currSlice->rdcost_for_8x8_intra_blocks (currMB, &c_nz, b8, ipmode, lambda, min_rdcost, mostProbableMode);
       if ((rdcost < min_rdcost) || (rdcost == min_rdcost && ipmode == mostProbableMode))
       {
         //--- set coefficients ---
@@ -322,6 +504,9 @@ int mode_decision_for_I8x8_blocks_JM_High (Macroblock *currMB, int b8, int lambd
     }
   }
 
+  if (p_Inp->FastIntraRDO)
+    p_Vid->fast_intra_rank[1][mode_rank[best_ipmode]]++;
+
   //===== set intra mode prediction =====
   p_Vid->ipredmode8x8[pic_block_y][pic_block_x] = (char) best_ipmode;
   currMB->ipmode_DPCM = (short) best_ipmode; //For residual DPCM
@@ -391,6 +576,7 @@ int mode_decision_for_I4x4_MB (Macroblock *currMB, int lambda,  distblk* cost)
   int non_zero[3] = {0, 0, 0};
 
   currSlice->cmp_cbp[1] = currSlice->cmp_cbp[2] = 0;
+  intra_threads_begin(currMB, FALSE);
   
   for (*cost=0, b8=0; b8<4; b8++)
   {
@@ -0,0 +1,682 @@
+/*!
+ *************************************************************************************
+ * \file rd_intra_threads.c
+ *
+ * \brief
+ *    Intra 4x4/8x8 mode decision on worker threads
+ *
+ *    The RD costs of the prediction modes of a block are independent of each
+ *    other: every mode is coded from the same stored coding state. Each OpenMP
+ *    thread owns private copies of the picture, slice, macroblock and coding
+ *    state (mb_pred, mb_ores, cofAC, the CABAC contexts with their journal and
+ *    a small bitstream) and codes the modes it is given. The block loop of
+ *    rd_intra_jm.c then takes the results in mode order, applying the early
+ *    termination and the tie rule of the sequential loop, so the selected
+ *    modes and the bitstream do not depend on the number of threads.
+ *
+ *    The first mode of a macroblock mode decision is coded sequentially. It
+ *    leaves the live coding state at the stored one (cs_cm), which is where
+ *    the workers start from.
+ *
+ *    The copies of VideoParameters, Slice and Macroblock are shallow. On the
+ *    worker path (the plain 4x4/8x8 residual, quant and rdcost functions and
+ *    the CAVLC/CABAC writers checked in intra_threads_begin()) only these
+ *    pointers are written through, and all of them are re-pointed:
+ *      VideoParameters: enc_picture (imgY, p_curr_img), nz_coeff[mbAddrX]
+ *      Slice:           mb_pred, mb_ores, mb_rres, tblk16x16, cofAC, partArr
+ *                       (bitstream, ee_cabac), tex_ctx, mot_ctx,
+ *                       p_RDO (cs_cm, ctx_journal)
+ *    Everything else reached from the copies is only read. Macroblock and
+ *    the Slice coefficient buffer (coeff) are written in place.
+ *************************************************************************************
+ */
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "contributors.h"
+
+#include "global.h"
+#include "memalloc.h"
+#include "block.h"
+#include "transform8x8.h"
+#include "quant4x4.h"
+#include "quant8x8.h"
+#include "intra4x4.h"
+#include "intra8x8.h"
+#include "md_distortion.h"
+#include "macroblock.h"
+#include "cabac.h"
+#include "vlc.h"
+#include "rd_intra_jm.h"
+#include "rd_intra_threads.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates the workers of a slice (NULL if IntraRDOThreads or the
+ *    number of processors is below 2)
+ ************************************************************************
+ */
+IntraThreads *create_intra_threads (Slice *currSlice)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
+  IntraThreads *p_IT;
+  int i, k, y;
+
+#if defined(_OPENMP)
+  int num_threads = imin(p_Inp->IntraRDOThreads, omp_get_num_procs());
+#else
+  int num_threads = 1;
+#endif
+
+  // more threads than processors only add overhead
+  if (num_threads < 2 || p_Inp->rdopt == 0 || TRACE)
+    return NULL;
+
+  if ((p_IT = (IntraThreads *) calloc(1, sizeof(IntraThreads))) == NULL)
+    no_mem_exit("create_intra_threads: p_IT");
+  p_IT->num_threads = num_threads;
+  if ((p_IT->worker = (IntraWorker **) calloc(p_IT->num_threads, sizeof(IntraWorker *))) == NULL)
+    no_mem_exit("create_intra_threads: p_IT->worker");
+
+  for (i = 0; i < p_IT->num_threads; i++)
+  {
+    IntraWorker *w;
+
+    if ((w = p_IT->worker[i] = (IntraWorker *) calloc(1, sizeof(IntraWorker))) == NULL)
+      no_mem_exit("create_intra_threads: worker");
+
+    for (k = 0; k < 3; k++)
+    {
+      if ((w->stream_buf[k] = (byte *) calloc(INTRA_THREADS_STREAM_SIZE, sizeof(byte))) == NULL)
+        no_mem_exit("create_intra_threads: stream_buf");
+    }
+    w->cs_cm       = create_coding_state (p_Inp);
+    w->ctx_journal = create_ctx_journal ();
+
+    get_mem2Dpel(&w->rec, MB_BLOCK_SIZE, p_Vid->width);
+    if ((w->rec_rows = (imgpel **) calloc(p_Vid->FrameHeightInMbs * MB_BLOCK_SIZE, sizeof(imgpel *))) == NULL)
+      no_mem_exit("create_intra_threads: rec_rows");
+    for (y = 0; y < p_Vid->FrameHeightInMbs * MB_BLOCK_SIZE; y++)
+      w->rec_rows[y] = w->rec[y & (MB_BLOCK_SIZE - 1)];
+
+    if ((w->nz_coeff = (int ***) calloc(p_Vid->FrameSizeInMbs, sizeof(int **))) == NULL)
+      no_mem_exit("create_intra_threads: nz_coeff");
+    get_mem2Dint(&w->nz_mb, BLOCK_SIZE, BLOCK_SIZE + p_Vid->num_blk8x8_uv);
+
+    get_mem3Dpel(&w->mb_pred, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint(&w->mb_ores, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint(&w->mb_rres, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem2Dint(&w->tblk16x16, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem_ACcoeff(p_Vid, &w->cofAC);
+  }
+
+  return p_IT;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the workers of a slice
+ ************************************************************************
+ */
+void delete_intra_threads (IntraThreads *p_IT)
+{
+  int i, k;
+
+  if (p_IT == NULL)
+    return;
+
+  for (i = 0; i < p_IT->num_threads; i++)
+  {
+    IntraWorker *w = p_IT->worker[i];
+
+    for (k = 0; k < 3; k++)
+      free(w->stream_buf[k]);
+    delete_coding_state (w->cs_cm);
+    delete_ctx_journal (w->ctx_journal);
+    free_mem2Dpel(w->rec);
+    free(w->rec_rows);
+    free(w->nz_coeff);
+    free_mem2Dint(w->nz_mb);
+    free_mem3Dpel(w->mb_pred);
+    free_mem3Dint(w->mb_ores);
+    free_mem3Dint(w->mb_rres);
+    free_mem2Dint(w->tblk16x16);
+    free_mem_ACcoeff(w->cofAC);
+    free(w);
+  }
+  free(p_IT->worker);
+  free(p_IT);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts the intra 4x4 or 8x8 mode decision of a macroblock. The
+ *    workers are used with the plain transform, quantization and rdcost
+ *    functions only; 4:4:4, lossless, SP/SI, RDOQ, adaptive rounding and
+ *    MBAFF keep the sequential loop.
+ ************************************************************************
+ */
+void intra_threads_begin (Macroblock *currMB, int transform_8x8)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  IntraThreads *p_IT = currSlice->p_RDO->intra_threads;
+
+  if (p_IT == NULL)
+    return;
+
+  p_IT->active = (p_Vid->yuv_format != YUV444) && !currSlice->P444_joined && !currSlice->mb_aff_frame_flag
+    && !p_Vid->AdaptiveRounding && (currSlice->slice_type != SP_SLICE) && (currSlice->slice_type != SI_SLICE);
+
+  // writers audited for the shallow worker copies
+  if (currSlice->symbol_mode == CABAC)
+    p_IT->active = p_IT->active && (currSlice->writeIntraPredMode == writeIntraPredMode_CABAC)
+      && (currSlice->write_and_store_CBP_block_bit == write_and_store_CBP_block_bit);
+  else
+    p_IT->active = p_IT->active && (currSlice->writeIntraPredMode == writeIntraPredMode_CAVLC)
+      && (currSlice->writeCoeff4x4_CAVLC == writeCoeff4x4_CAVLC_normal);
+
+  if (transform_8x8)
+  {
+    p_IT->active = p_IT->active
+      && (currSlice->mode_decision_for_I8x8_blocks == mode_decision_for_I8x8_blocks_JM_High)
+      && (currSlice->rdcost_for_8x8_intra_blocks == rdcost_for_8x8_intra_blocks)
+      && (currSlice->quant_8x8 == quant_8x8_normal) && (currSlice->quant_8x8cavlc == quant_8x8cavlc_normal)
+      && (currMB->residual_transform_quant_luma_8x8 == residual_transform_quant_luma_8x8
+       || currMB->residual_transform_quant_luma_8x8 == residual_transform_quant_luma_8x8_cavlc);
+  }
+  else
+  {
+    p_IT->active = p_IT->active
+      && (currSlice->mode_decision_for_I4x4_blocks == mode_decision_for_I4x4_blocks_JM_High)
+      && (currSlice->rdcost_for_4x4_intra_blocks == rdcost_for_4x4_intra_blocks)
+      && (currSlice->quant_4x4 == quant_4x4_normal)
+      && (currMB->residual_transform_quant_luma_4x4 == residual_transform_quant_luma_4x4);
+  }
+
+  p_IT->ready = FALSE;
+  ++p_IT->session;
+  memset(p_IT->done, 0, NO_INTRA_PMODE * sizeof(byte));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Maps a context of the live tables onto the tables of a worker
+ ************************************************************************
+ */
+static inline BiContextType *worker_ctx(IntraWorker *w, CtxJournal *jr, int idx)
+{
+  return (idx < jr->num_mot) ? ((BiContextType *) &w->mot_ctx) + idx : ((BiContextType *) &w->tex_ctx) + idx - jr->num_mot;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Picture and slice level state of the current macroblock
+ ************************************************************************
+ */
+static void sync_slice_state(IntraWorker *w, Macroblock *currMB)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+
+  w->pic = *p_Vid->enc_picture;
+  w->pic.imgY = w->pic.p_curr_img = w->pic.p_img[0] = w->rec_rows;
+
+  memcpy(w->nz_coeff, p_Vid->nz_coeff, p_Vid->FrameSizeInMbs * sizeof(int **));
+  w->nz_coeff[currMB->mbAddrX] = w->nz_mb;
+
+  // shallow copies, see the list of re-pointed members at the top of the file
+  w->vid = *p_Vid;
+  w->vid.enc_picture  = &w->pic;
+  w->vid.nz_coeff     = w->nz_coeff;
+  w->vid.currentSlice = &w->slice;
+
+  w->rdo = *currSlice->p_RDO;
+  w->rdo.cs_cm         = w->cs_cm;
+  w->rdo.ctx_journal   = currSlice->p_RDO->ctx_journal ? w->ctx_journal : NULL;
+  w->rdo.intra_threads = NULL;
+
+  w->slice = *currSlice;
+  w->slice.p_Vid     = &w->vid;
+  w->slice.p_RDO     = &w->rdo;
+  w->slice.partArr   = w->part;
+  w->slice.tex_ctx   = currSlice->tex_ctx ? &w->tex_ctx : NULL;
+  w->slice.mot_ctx   = currSlice->mot_ctx ? &w->mot_ctx : NULL;
+  w->slice.mb_pred   = w->mb_pred;
+  w->slice.mb_ores   = w->mb_ores;
+  w->slice.mb_rres   = w->mb_rres;
+  w->slice.tblk16x16 = w->tblk16x16;
+  w->slice.cofAC     = w->cofAC;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Copies the stored coding state of the macroblock (equal to the
+ *    live one while the workers run) with the streams rebased onto the
+ *    private buffers
+ ************************************************************************
+ */
+static void sync_coding_state(IntraWorker *w, Macroblock *currMB)
+{
+  Slice *currSlice = currMB->p_Slice;
+  CSobj *cs  = currSlice->p_RDO->cs_cm;
+  CSobj *wcs = w->cs_cm;
+  CtxJournal *jr = currSlice->p_RDO->ctx_journal;
+  int base[3] = {0, 0, 0};
+  int i;
+
+  if (currSlice->tex_ctx)
+    w->tex_ctx = *currSlice->tex_ctx;
+  if (currSlice->mot_ctx)
+    w->mot_ctx = *currSlice->mot_ctx;
+
+  for (i = 0; i < currSlice->max_part_nr; i++)
+  {
+    DataPartition *part = &w->part[i];
+
+    *part = currSlice->partArr[i];
+    part->p_Slice = &w->slice;
+    part->p_Vid   = &w->vid;
+
+    base[i] = part->bitstream->byte_pos;
+    w->stream[i] = *part->bitstream;
+    w->stream[i].streamBuffer = w->stream_buf[i];
+    w->stream[i].buffer_size  = INTRA_THREADS_STREAM_SIZE;
+    w->stream[i].byte_pos     = 0;
+    part->bitstream = &w->stream[i];
+
+    part->ee_cabac.p_Vid         = &w->vid;
+    part->ee_cabac.Ecodestrm     = w->stream_buf[i];
+    part->ee_cabac.Ecodestrm_len = &w->stream[i].byte_pos;
+    if (part->ee_cabac.Ejournal)
+      part->ee_cabac.Ejournal = w->ctx_journal;
+  }
+
+  //=== stored state ===
+  for (i = 0; i < cs->no_part && i < currSlice->max_part_nr; i++)
+  {
+    wcs->bitstream[i] = cs->bitstream[i];
+    wcs->bitstream[i].streamBuffer = w->stream_buf[i];
+    wcs->bitstream[i].buffer_size  = INTRA_THREADS_STREAM_SIZE;
+    wcs->bitstream[i].byte_pos    -= base[i];
+    if (cs->encenv != NULL)
+    {
+      wcs->encenv[i] = cs->encenv[i];
+      wcs->encenv[i].Ecodestrm     = w->stream_buf[i];
+      wcs->encenv[i].Ecodestrm_len = &w->stream[i].byte_pos;
+      if (wcs->encenv[i].Ejournal)
+        wcs->encenv[i].Ejournal = w->ctx_journal;
+    }
+  }
+  wcs->bits = cs->bits;
+  memcpy(wcs->mvd, cs->mvd, sizeof(cs->mvd));
+  memcpy(wcs->cbp_bits, cs->cbp_bits, sizeof(cs->cbp_bits));
+
+  if (jr != NULL)
+  {
+    CtxJournal *wjr = w->ctx_journal;
+
+    wcs->num_ctx = cs->num_ctx;
+    for (i = 0; i < cs->num_ctx; i++)
+    {
+      wcs->ctx_entry[i]     = cs->ctx_entry[i];
+      wcs->ctx_entry[i].ctx = worker_ctx(w, jr, cs->ctx_entry[i].idx);
+      wcs->ctx_cur[i]       = cs->ctx_cur[i];
+    }
+
+    wjr->mot_base = (BiContextType *) &w->mot_ctx;
+    wjr->tex_base = (BiContextType *) &w->tex_ctx;
+    wjr->num = jr->num;
+    for (i = 0; i < jr->num; i++)
+    {
+      wjr->entry[i]     = jr->entry[i];
+      wjr->entry[i].ctx = worker_ctx(w, jr, jr->entry[i].idx);
+    }
+    memcpy(wjr->touched, jr->touched, (jr->num_mot + jr->num_tex) * sizeof(byte));
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Copies the macroblock state of the current block
+ ************************************************************************
+ */
+static void sync_block_state(IntraWorker *w, Macroblock *currMB, int block)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int **nz_coeff = p_Vid->nz_coeff[currMB->mbAddrX];
+  int i;
+
+  w->mb = *currMB;
+  w->mb.p_Vid   = &w->vid;
+  w->mb.p_Slice = &w->slice;
+
+  for (i = 0; i < BLOCK_SIZE; i++)
+    memcpy(w->nz_mb[i], nz_coeff[i], (BLOCK_SIZE + p_Vid->num_blk8x8_uv) * sizeof(int));
+
+  w->block = block;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Checks that the members written on the worker path do not point
+ *    into the live encoder state
+ ************************************************************************
+ */
+static void assert_private_state(IntraWorker *w, Macroblock *currMB)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  int i;
+
+  assert(w->mb.p_Vid == &w->vid && w->mb.p_Slice == &w->slice);
+  assert(w->vid.enc_picture != p_Vid->enc_picture && w->pic.imgY != p_Vid->enc_picture->imgY);
+  assert(w->pic.p_curr_img == w->pic.imgY);
+  assert(w->vid.nz_coeff != p_Vid->nz_coeff && w->vid.nz_coeff[currMB->mbAddrX] == w->nz_mb);
+  assert(w->slice.p_Vid == &w->vid && w->slice.p_RDO == &w->rdo);
+  assert(w->slice.mb_pred != currSlice->mb_pred && w->slice.mb_ores != currSlice->mb_ores);
+  assert(w->slice.mb_rres != currSlice->mb_rres && w->slice.tblk16x16 != currSlice->tblk16x16);
+  assert(w->slice.cofAC != currSlice->cofAC && w->slice.partArr != currSlice->partArr);
+  assert(currSlice->tex_ctx == NULL || w->slice.tex_ctx != currSlice->tex_ctx);
+  assert(currSlice->mot_ctx == NULL || w->slice.mot_ctx != currSlice->mot_ctx);
+  assert(w->rdo.cs_cm != currSlice->p_RDO->cs_cm && w->rdo.intra_threads == NULL);
+  assert(w->rdo.ctx_journal == NULL || w->rdo.ctx_journal != currSlice->p_RDO->ctx_journal);
+  for (i = 0; i < currSlice->max_part_nr; i++)
+  {
+    assert(w->part[i].bitstream != currSlice->partArr[i].bitstream);
+    assert(w->part[i].bitstream->streamBuffer != currSlice->partArr[i].bitstream->streamBuffer);
+    assert(w->part[i].ee_cabac.Ecodestrm_len == &w->part[i].bitstream->byte_pos);
+    assert(w->part[i].ee_cabac.Ejournal == NULL || w->part[i].ee_cabac.Ejournal == w->rdo.ctx_journal);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Worker of the calling thread, brought up to date with the current
+ *    macroblock and block
+ ************************************************************************
+ */
+static IntraWorker *get_worker(IntraThreads *p_IT, Macroblock *currMB)
+{
+#if defined(_OPENMP)
+  IntraWorker *w = p_IT->worker[omp_get_thread_num()];
+#else
+  IntraWorker *w = p_IT->worker[0];
+#endif
+
+  if (w->session != p_IT->session)
+  {
+    sync_slice_state(w, currMB);
+    sync_coding_state(w, currMB);
+    w->session = p_IT->session;
+  }
+  if (w->block != p_IT->block)
+  {
+    sync_block_state(w, currMB, p_IT->block);
+    assert_private_state(w, currMB);
+  }
+
+  return w;
+}
+
+static int block_nonzero(int **mb_ores, int block_x, int size)
+{
+  int i, j;
+
+  for (j = 0; j < size; j++)
+  {
+    for (i = block_x; i < block_x + size; i++)
+    {
+      if (mb_ores[j][i] != 0)
+        return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes one 4x4 prediction mode on a worker
+ ************************************************************************
+ */
+static void code_mode_4x4(IntraWorker *w, int b8, int b4, int ipmode, int lambda, int mostProbableMode, IntraModeResult *res)
+{
+  VideoParameters *p_Vid = &w->vid;
+  Slice *currSlice = &w->slice;
+  Macroblock *currMB = &w->mb;
+  int block_x    = ((b8 & 0x01) << 3) + ((b4 & 0x01) << 2);
+  int block_y    = ((b8 >> 1) << 3)  + ((b4 >> 1) << 2);
+  int pic_pix_x  = currMB->pix_x  + block_x;
+  int pic_pix_y  = currMB->pix_y  + block_y;
+  int pic_opix_y = currMB->opix_y + block_y;
+  int j;
+
+  generate_pred_error_4x4(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_pix_x, block_x);
+  res->ores_nonzero = block_nonzero(&currSlice->mb_ores[0][block_y], block_x, BLOCK_SIZE);
+
+  res->rdcost     = currSlice->rdcost_for_4x4_intra_blocks (currMB, &res->nonzero, b8, b4, ipmode, lambda, mostProbableMode, DISTBLK_MAX);
+  res->distortion = compute_SSE4x4(&p_Vid->pCurImg[pic_opix_y], &p_Vid->enc_picture->imgY[pic_pix_y], pic_pix_x, pic_pix_x);
+
+  memcpy(res->cof,      currSlice->cofAC[b8][b4][0], 18 * sizeof(int));
+  memcpy(res->cof + 18, currSlice->cofAC[b8][b4][1], 18 * sizeof(int));
+  for (j = 0; j < BLOCK_SIZE; j++)
+    memcpy(res->rec[j], &p_Vid->enc_picture->imgY[pic_pix_y + j][pic_pix_x], BLOCK_SIZE * sizeof(imgpel));
+  res->nz_coeff[0][0] = p_Vid->nz_coeff[currMB->mbAddrX][block_x >> 2][block_y >> 2];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes one 8x8 prediction mode on a worker
+ ************************************************************************
+ */
+static void code_mode_8x8(IntraWorker *w, int b8, int ipmode, int lambda, int mostProbableMode, IntraModeResult *res)
+{
+  VideoParameters *p_Vid = &w->vid;
+  Slice *currSlice = &w->slice;
+  Macroblock *currMB = &w->mb;
+  int block_x    = (b8 & 0x01) << 3;
+  int block_y    = (b8 >> 1) << 3;
+  int pic_pix_x  = currMB->pix_x  + block_x;
+  int pic_pix_y  = currMB->pix_y  + block_y;
+  int pic_opix_y = currMB->opix_y + block_y;
+  int i, j;
+
+  generate_pred_error_8x8(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_pix_x, block_x);
+  currMB->ipmode_DPCM = (short) ipmode;
+
+  res->rdcost     = currSlice->rdcost_for_8x8_intra_blocks (currMB, &res->nonzero, b8, ipmode, lambda, DISTBLK_MAX, mostProbableMode);
+  res->distortion = compute_SSE8x8(&p_Vid->pCurImg[pic_opix_y], &p_Vid->enc_picture->imgY[pic_pix_y], pic_pix_x, pic_pix_x);
+
+  memcpy(res->cof, currSlice->cofAC[b8][0][0], 4 * 2 * 65 * sizeof(int));
+  for (j = 0; j < BLOCK_SIZE_8x8; j++)
+    memcpy(res->rec[j], &p_Vid->enc_picture->imgY[pic_pix_y + j][pic_pix_x], BLOCK_SIZE_8x8 * sizeof(imgpel));
+  for (i = 0; i < 2; i++)
+  {
+    for (j = 0; j < 2; j++)
+      res->nz_coeff[i][j] = p_Vid->nz_coeff[currMB->mbAddrX][(block_x >> 2) + i][(block_y >> 2) + j];
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes the selected 4x4 prediction modes from first_mode on in
+ *    parallel. The predictions are formed here, in the live slice.
+ ************************************************************************
+ */
+void intra_threads_evaluate_4x4 (Macroblock *currMB, int b8, int b4, int lambda, int mostProbableMode, int left_available, int up_available, const byte *modes, int first_mode)
+{
+  IntraThreads *p_IT = currMB->p_Slice->p_RDO->intra_threads;
+  int block_x = ((b8 & 0x01) << 3) + ((b4 & 0x01) << 2);
+  int block_y = ((b8 >> 1) << 3)  + ((b4 >> 1) << 2);
+  int list[NO_INTRA_PMODE];
+  int num = 0, i;
+
+  p_IT->ready = TRUE;
+  ++p_IT->block;
+  memset(p_IT->done, 0, NO_INTRA_PMODE * sizeof(byte));
+
+  for (i = first_mode; i < NO_INTRA_PMODE; i++)
+  {
+    if (modes[i])
+    {
+      get_intrapred_4x4(currMB, PLANE_Y, i, block_x, block_y, left_available, up_available);
+      list[num++] = i;
+    }
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(p_IT->num_threads) if (num > 1) schedule(dynamic, 1)
+#endif
+  for (i = 0; i < num; i++)
+  {
+    IntraWorker *w = get_worker(p_IT, currMB);
+    code_mode_4x4(w, b8, b4, list[i], lambda, mostProbableMode, &p_IT->result[list[i]]);
+  }
+
+  for (i = 0; i < num; i++)
+    p_IT->done[list[i]] = TRUE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes the selected 8x8 prediction modes from first_mode on in
+ *    parallel
+ ************************************************************************
+ */
+void intra_threads_evaluate_8x8 (Macroblock *currMB, int b8, int lambda, int mostProbableMode, int left_available, int up_available, const byte *modes, int first_mode)
+{
+  IntraThreads *p_IT = currMB->p_Slice->p_RDO->intra_threads;
+  int list[NO_INTRA_PMODE];
+  int num = 0, i;
+
+  p_IT->ready = TRUE;
+  ++p_IT->block;
+  memset(p_IT->done, 0, NO_INTRA_PMODE * sizeof(byte));
+
+  for (i = first_mode; i < NO_INTRA_PMODE; i++)
+  {
+    if (modes[i])
+    {
+      get_intrapred_8x8(currMB, PLANE_Y, i, left_available, up_available);
+      list[num++] = i;
+    }
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(p_IT->num_threads) if (num > 1) schedule(dynamic, 1)
+#endif
+  for (i = 0; i < num; i++)
+  {
+    IntraWorker *w = get_worker(p_IT, currMB);
+    code_mode_8x8(w, b8, list[i], lambda, mostProbableMode, &p_IT->result[list[i]]);
+  }
+
+  for (i = 0; i < num; i++)
+    p_IT->done[list[i]] = TRUE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes the result of a 4x4 mode in place of rdcost_for_4x4_intra_blocks():
+ *    returns the same cost and leaves the live macroblock, coefficients and
+ *    reconstruction as the sequential call would, including its early
+ *    termination against min_rdcost
+ ************************************************************************
+ */
+distblk intra_threads_replay_4x4 (Macroblock *currMB, int b8, int b4, int ipmode, distblk min_rdcost, int *nonzero)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  IntraModeResult *res = &currSlice->p_RDO->intra_threads->result[ipmode];
+  int block_x    = ((b8 & 0x01) << 3) + ((b4 & 0x01) << 2);
+  int block_y    = ((b8 >> 1) << 3)  + ((b4 >> 1) << 2);
+  int pic_pix_x  = currMB->pix_x  + block_x;
+  int pic_pix_y  = currMB->pix_y  + block_y;
+  int pic_opix_y = currMB->opix_y + block_y;
+  int early      = INTRA_RDCOSTCALC_ET && (res->distortion >= min_rdcost);
+  int coded      = !early;
+  int j;
+
+  generate_pred_error_4x4(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_4x4[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_pix_x, block_x);
+  memcpy(currSlice->cofAC[b8][b4][0], res->cof,      18 * sizeof(int));
+  memcpy(currSlice->cofAC[b8][b4][1], res->cof + 18, 18 * sizeof(int));
+  for (j = 0; j < BLOCK_SIZE; j++)
+    memcpy(&p_Vid->enc_picture->imgY[pic_pix_y + j][pic_pix_x], res->rec[j], BLOCK_SIZE * sizeof(imgpel));
+
+  // fields set by the transform and the entropy coding
+  if (res->ores_nonzero || (coded && currSlice->symbol_mode == CABAC))
+  {
+    currMB->subblock_x = (short) block_x;
+    currMB->subblock_y = (short) block_y;
+  }
+  if (coded && currSlice->symbol_mode == CABAC)
+    currMB->is_intra_block = TRUE;
+  if (coded && currSlice->symbol_mode == CAVLC)
+    p_Vid->nz_coeff[currMB->mbAddrX][block_x >> 2][block_y >> 2] = res->nz_coeff[0][0];
+  currMB->ipmode_DPCM = coded ? NO_INTRA_PMODE : (short) ipmode;
+
+  *nonzero = res->nonzero;
+  return coded ? res->rdcost : res->distortion;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes the result of an 8x8 mode in place of rdcost_for_8x8_intra_blocks()
+ ************************************************************************
+ */
+distblk intra_threads_replay_8x8 (Macroblock *currMB, int b8, int ipmode, distblk min_rdcost, int *nonzero)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  IntraModeResult *res = &currSlice->p_RDO->intra_threads->result[ipmode];
+  int block_x    = (b8 & 0x01) << 3;
+  int block_y    = (b8 >> 1) << 3;
+  int pic_pix_x  = currMB->pix_x  + block_x;
+  int pic_pix_y  = currMB->pix_y  + block_y;
+  int pic_opix_y = currMB->opix_y + block_y;
+  int coded      = (res->distortion <= min_rdcost);
+  int i, j;
+
+  generate_pred_error_8x8(&p_Vid->pCurImg[pic_opix_y], currSlice->mpr_8x8[0][ipmode], &currSlice->mb_pred[0][block_y], &currSlice->mb_ores[0][block_y], pic_pix_x, block_x);
+  memcpy(currSlice->cofAC[b8][0][0], res->cof, 4 * 2 * 65 * sizeof(int));
+  for (j = 0; j < BLOCK_SIZE_8x8; j++)
+    memcpy(&p_Vid->enc_picture->imgY[pic_pix_y + j][pic_pix_x], res->rec[j], BLOCK_SIZE_8x8 * sizeof(imgpel));
+
+  // fields set by the entropy coding
+  if (coded && currSlice->symbol_mode == CABAC)
+  {
+    currMB->subblock_x     = (short) block_x;
+    currMB->subblock_y     = (short) block_y;
+    currMB->is_intra_block = TRUE;
+  }
+  if (coded && currSlice->symbol_mode == CAVLC)
+  {
+    for (i = 0; i < 2; i++)
+    {
+      for (j = 0; j < 2; j++)
+        p_Vid->nz_coeff[currMB->mbAddrX][(block_x >> 2) + i][(block_y >> 2) + j] = res->nz_coeff[i][j];
+    }
+  }
+  currMB->ipmode_DPCM = coded ? NO_INTRA_PMODE : (short) ipmode;
+
+  *nonzero = res->nonzero;
+  return coded ? res->rdcost : res->distortion;
+}
@@ -45,6 +45,7 @@
 #include "md_common.h"
 #include "md_distortion.h"
 #include "intra16x16.h"
+#include "rd_intra_threads.h"
 
 #define FASTMODE 1
 
@@ -148,6 +149,10 @@ void clear_rdopt (Slice *currSlice)
   delete_coding_state (p_RDO->cs_b8);
   delete_coding_state (p_RDO->cs_cm);
   delete_coding_state (p_RDO->cs_tmp);
+  delete_ctx_journal  (p_RDO->ctx_journal);
+  p_RDO->ctx_journal = NULL;
+  delete_intra_threads (p_RDO->intra_threads);
+  p_RDO->intra_threads = NULL;
 }
 
 void setupDistCost(Slice *currSlice, InputParameters *p_Inp)
@@ -267,6 +272,8 @@ void init_rdopt (Slice *currSlice)
   p_RDO->cs_b8  = create_coding_state (p_Inp);
   p_RDO->cs_cm  = create_coding_state (p_Inp);
   p_RDO->cs_tmp = create_coding_state (p_Inp);
+  p_RDO->ctx_journal = (p_Inp->rdopt && currSlice->symbol_mode == CABAC) ? create_ctx_journal () : NULL;
+  p_RDO->intra_threads = create_intra_threads (currSlice);
   if (p_Inp->CtxAdptLagrangeMult == 1)
   {
     p_Vid->mb16x16_cost = CALM_MF_FACTOR_THRESHOLD;
@@ -1037,8 +1044,13 @@ void set_modes_and_refs_for_blocks_p_slice(Macroblock *currMB, short mode)
     if (!mode) // Skip
     {
       for (j = currMB->block_y; j < currMB->block_y + 4; j++)
+      {
         for (i = currMB->block_x; i < currMB->block_x + 4; i++)
+        {
           motion[j][i].ref_idx[LIST_0] = 0;
+          motion[j][i].ref_pic[LIST_0] = currSlice->listX[LIST_0 + currMB->list_offset][0];
+        }
+      }
     }
     else // Intra
     {
@@ -1227,7 +1239,10 @@ void set_modes_and_refs_for_blocks_b_slice(Macroblock *currMB, short mode)
       for (j = currMB->block_y; j < currMB->block_y + 4; j++)
       {
         for (i = currMB->block_x; i < currMB->block_x + 4; i++)
+        {
           motion[j][i].ref_idx[clist] = currSlice->direct_ref_idx[j][i][clist];
+          motion[j][i].ref_pic[clist] = (motion[j][i].ref_idx[clist] >= 0) ? currSlice->listX[clist + currMB->list_offset][(short) motion[j][i].ref_idx[clist]] : NULL;
+        }
       }
     }
   }
@@ -19,6 +19,11 @@
 #include "rdopt_coding_state.h"
 #include "cabac.h"
 #include "memalloc.h"
+#include "rdopt.h"
+
+#define NUM_MOT_CTX    ((int) (sizeof(MotionInfoContexts)  / sizeof(BiContextType)))
+#define NUM_TEX_CTX    ((int) (sizeof(TextureInfoContexts) / sizeof(BiContextType)))
+#define NUM_CTX_TOTAL  (NUM_MOT_CTX + NUM_TEX_CTX)
 
 /*!
  ************************************************************************
@@ -43,8 +48,16 @@ void delete_coding_state (CSobj *cs)
     }
 
     //=== contexts for binary arithmetic coding ===
-    delete_contexts_MotionInfo  (cs->mot_ctx);
-    delete_contexts_TextureInfo (cs->tex_ctx);
+    if (cs->ctx_entry != NULL)
+    {
+      free (cs->ctx_entry);
+      cs->ctx_entry = NULL;
+    }
+    if (cs->ctx_cur != NULL)
+    {
+      free (cs->ctx_cur);
+      cs->ctx_cur = NULL;
+    }
 
     if (cs->cbp_bits_8x8 != NULL)
     {
@@ -83,9 +96,10 @@ CSobj *create_coding_state (InputParameters *p_Inp)
     if ((cs->bitstream = (Bitstream*) calloc (cs->no_part, sizeof(Bitstream))) == NULL)
       no_mem_exit("init_coding_state: cs->bitstream");
     //=== context for binary arithmetic coding ===
-    cs->mot_ctx = create_contexts_MotionInfo ();
-    cs->tex_ctx = create_contexts_TextureInfo();
-
+    if ((cs->ctx_entry = (CtxJournalEntry*) calloc (NUM_CTX_TOTAL, sizeof(CtxJournalEntry))) == NULL)
+      no_mem_exit("init_coding_state: cs->ctx_entry");
+    if ((cs->ctx_cur = (BiContextType*) calloc (NUM_CTX_TOTAL, sizeof(BiContextType))) == NULL)
+      no_mem_exit("init_coding_state: cs->ctx_cur");
   }
   else
   {
@@ -93,8 +107,8 @@ CSobj *create_coding_state (InputParameters *p_Inp)
     if ((cs->bitstream = (Bitstream*) calloc (cs->no_part, sizeof(Bitstream))) == NULL)
       no_mem_exit("init_coding_state: cs->bitstream");
 
-    cs->mot_ctx = NULL;
-    cs->tex_ctx = NULL;
+    cs->ctx_entry = NULL;
+    cs->ctx_cur   = NULL;
   }
   
   if (p_Inp->ProfileIDC == 244)
@@ -161,6 +175,13 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   Slice *currSlice = currMB->p_Slice;
   int  i_last = currSlice->idr_flag? 1:cs->no_part;  
   DataPartition *partArr = &currSlice->partArr[0];
+  CtxJournal *jr = currSlice->p_RDO->ctx_journal;
+
+  // created by init_rdopt() for every RDO slice that uses CABAC
+  assert(jr != NULL);
+
+  if (partArr->ee_cabac.Ejournal == NULL)
+    begin_ctx_journal(currSlice);
 
   //=== important variables of data partition array ===
   //only one partition for an IDR picture
@@ -171,8 +192,12 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   }
 
   //=== contexts for binary arithmetic coding ===
-  *cs->mot_ctx = *currSlice->mot_ctx;
-  *cs->tex_ctx = *currSlice->tex_ctx;
+  cs->num_ctx = jr->num;
+  memcpy (cs->ctx_entry, jr->entry, jr->num * sizeof(CtxJournalEntry));
+  for (i = 0; i < jr->num; i++)
+  {
+    cs->ctx_cur[i] = *jr->entry[i].ctx;
+  }
 
   //=== syntax element number and bitcounters ===
   cs->bits = currMB->bits;
@@ -240,6 +265,9 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   Slice *currSlice = currMB->p_Slice;
   int  i_last = currSlice->idr_flag? 1:cs->no_part;   
   DataPartition *partArr = &currSlice->partArr[0];
+  CtxJournal *jr = currSlice->p_RDO->ctx_journal;
+
+  assert(jr != NULL);
 
   //=== important variables of data partition array ===
   //only one partition for an IDR picture
@@ -251,8 +279,19 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   }
 
   //=== contexts for binary arithmetic coding ===
-  *currSlice->mot_ctx = *cs->mot_ctx;
-  *currSlice->tex_ctx = *cs->tex_ctx;
+  // undo all logged changes, then apply the ones of the stored state
+  for (i = 0; i < jr->num; i++)
+  {
+    *jr->entry[i].ctx = jr->entry[i].org;
+    jr->touched[jr->entry[i].idx] = 0;
+  }
+  jr->num = cs->num_ctx;
+  memcpy (jr->entry, cs->ctx_entry, cs->num_ctx * sizeof(CtxJournalEntry));
+  for (i = 0; i < cs->num_ctx; i++)
+  {
+    *jr->entry[i].ctx = cs->ctx_cur[i];
+    jr->touched[jr->entry[i].idx] = 1;
+  }
 
   //=== syntax element number and bit counters ===
   currMB->bits = cs->bits;
@@ -270,6 +309,93 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
 
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    create the context journal of the RD mode decision
+ ************************************************************************
+ */
+CtxJournal *create_ctx_journal (void)
+{
+  CtxJournal *jr;
+
+  if ((jr = (CtxJournal *) calloc (1, sizeof(CtxJournal))) == NULL)
+    no_mem_exit("create_ctx_journal: jr");
+
+  jr->num_mot = NUM_MOT_CTX;
+  jr->num_tex = NUM_TEX_CTX;
+  if ((jr->entry = (CtxJournalEntry *) calloc (NUM_CTX_TOTAL, sizeof(CtxJournalEntry))) == NULL)
+    no_mem_exit("create_ctx_journal: jr->entry");
+  if ((jr->touched = (byte *) calloc (NUM_CTX_TOTAL, sizeof(byte))) == NULL)
+    no_mem_exit("create_ctx_journal: jr->touched");
+
+  return jr;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    delete the context journal
+ ************************************************************************
+ */
+void delete_ctx_journal (CtxJournal *jr)
+{
+  if (jr != NULL)
+  {
+    free (jr->entry);
+    free (jr->touched);
+    free (jr);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    take the current contexts of the slice as the base of the journal
+ *    and start logging context changes
+ ************************************************************************
+ */
+void begin_ctx_journal (Slice *currSlice)
+{
+  CtxJournal *jr = currSlice->p_RDO->ctx_journal;
+  int i;
+
+  for (i = 0; i < jr->num; i++)
+  {
+    jr->touched[jr->entry[i].idx] = 0;
+  }
+  jr->num = 0;
+  jr->mot_base = (BiContextType *) currSlice->mot_ctx;
+  jr->tex_base = (BiContextType *) currSlice->tex_ctx;
+
+  for (i = 0; i < currSlice->max_part_nr; i++)
+  {
+    currSlice->partArr[i].ee_cabac.Ejournal = jr;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    stop logging context changes (the chosen mode is about to be coded)
+ ************************************************************************
+ */
+void end_ctx_journal (Slice *currSlice)
+{
+  CtxJournal *jr = currSlice->p_RDO->ctx_journal;
+  int i;
+
+  for (i = 0; i < currSlice->max_part_nr; i++)
+  {
+    currSlice->partArr[i].ee_cabac.Ejournal = NULL;
+  }
+  for (i = 0; i < jr->num; i++)
+  {
+    jr->touched[jr->entry[i].idx] = 0;
+  }
+  jr->num = 0;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -14,32 +14,13 @@
 
 #include "global.h"
 #include "cabac.h"
+#include "biariencode.h"
 #include "image.h"
 #include "fmo.h"
 #include "macroblock.h"
 #include "mb_access.h"
 #include "rdoq.h"
 
-static const int entropyBits[128]= 
-{
-     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
-    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
-    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
-    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
-    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
-    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
-   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
-   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
-   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
-   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
-   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
-   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
-  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
-  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
-  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
-  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
-};
-
 
 static int biari_no_bits(signed short symbol, BiContextTypePtr bi_ct )
 {
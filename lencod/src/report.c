@@ -21,6 +21,8 @@
 #include "filehandle.h"
 #include "fmo.h"
 #include "image.h"
+#include "img_luma.h"
+#include "memalloc.h"
 #include "intrarefresh.h"
 #include "leaky_bucket.h"
 #include "me_epzs.h"
@@ -29,6 +31,7 @@
 #include "parset.h"
 #include "report.h"
 #include "img_process_types.h"
+#include "mode_pruning.h"
 
 extern FILE *resultsPSNRbits;
 
@@ -222,6 +225,189 @@ double report_slice_pred_stats(FILE *p_stat, StatParameters *p_Stats, int slice_
             + p_Stats->bit_use_mode[slice_type][3] + p_Stats->bit_use_mode[slice_type][P8x8]) / bit_use;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Appends the memory currently allocated by each subsystem to
+ *    stat_memory.dat (MemoryReport = 2)
+ ************************************************************************
+ */
+void report_frame_memory(VideoParameters *p_Vid, InputParameters *p_Inp) {
+    FILE *p_mem = NULL;
+    MemTagStats stats;
+    int tag;
+
+    if ((p_mem = fopen("stat_memory.dat", (p_Vid->curr_frm_idx == 0) ? "w" : "a")) == NULL) {
+        snprintf(errortext, ET_SIZE, "Error open file %s  \n", "stat_memory.dat");
+        error(errortext, 500);
+    }
+
+    if (p_Vid->curr_frm_idx == 0) {
+        fprintf(p_mem, "  Frm |");
+        for (tag = 0; tag <= MEM_TAG_NUM; tag++)
+            fprintf(p_mem, " %14s |", (tag < MEM_TAG_NUM) ? mem_tag_name((MemTag) tag) : "Total");
+        fprintf(p_mem, "\n");
+    }
+
+    // current bytes per subsystem in KB
+    fprintf(p_mem, " %4d |", p_Vid->frame_no);
+    for (tag = 0; tag <= MEM_TAG_NUM; tag++) {
+        mem_get_stats((MemTag) tag, &stats);
+        fprintf(p_mem, " %14.1f |", (double) stats.cur_bytes / 1024.0);
+    }
+    fprintf(p_mem, "\n");
+
+    fclose(p_mem);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Appends the average search range of the current frame to
+ *    stat_search_range.dat (AdaptiveSearchRange = 1)
+ ************************************************************************
+ */
+void report_frame_search_range(VideoParameters *p_Vid) {
+    FILE *p_asr = NULL;
+
+    if ((p_asr = fopen("stat_search_range.dat", (p_Vid->curr_frm_idx == 0) ? "w" : "a")) == NULL) {
+        snprintf(errortext, ET_SIZE, "Error open file %s  \n", "stat_search_range.dat");
+        error(errortext, 500);
+    }
+
+    if (p_Vid->curr_frm_idx == 0)
+        fprintf(p_asr, "  Frm |   Searches | Avg. range | Avg. static range\n");
+
+    if (p_Vid->asr_frame_searches)
+        fprintf(p_asr, " %4d | %10d | %10.2f | %17.2f\n", p_Vid->frame_no, (int) p_Vid->asr_frame_searches,
+                (double) p_Vid->asr_frame_range_sum / (double) p_Vid->asr_frame_searches,
+                (double) p_Vid->asr_frame_max_range_sum / (double) p_Vid->asr_frame_searches);
+    else
+        fprintf(p_asr, " %4d | %10d | %10s | %17s\n", p_Vid->frame_no, 0, "-", "-");
+
+    fclose(p_asr);
+
+    p_Vid->asr_frame_searches = 0;
+    p_Vid->asr_frame_range_sum = 0;
+    p_Vid->asr_frame_max_range_sum = 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints current and peak memory allocated through the get_mem*
+ *    functions, per subsystem
+ ************************************************************************
+ */
+static void report_memory_usage(void) {
+    MemTagStats stats;
+    int tag;
+
+    fprintf(stdout, " Memory usage (MB)                 :   current      peak    allocs     frees\n");
+    for (tag = 0; tag <= MEM_TAG_NUM; tag++) {
+        mem_get_stats((MemTag) tag, &stats);
+        fprintf(stdout, "   %-32s: %9.3f %9.3f %9.0f %9.0f\n", (tag < MEM_TAG_NUM) ? mem_tag_name((MemTag) tag) : "Total",
+                (double) stats.cur_bytes / (1024.0 * 1024.0), (double) stats.peak_bytes / (1024.0 * 1024.0),
+                (double) stats.alloc_count, (double) stats.free_count);
+    }
+    fprintf(stdout, "\n");
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints how the sample buffers were allocated under the selected
+ *    MemoryPolicy
+ ************************************************************************
+ */
+static void report_memory_policy(void) {
+    static const char *policy_name[MEM_POLICY_NUM] = {"heap", "aligned", "THP", "hugetlb"};
+    MemPolicyStats stats;
+    int i;
+
+    mem_get_policy_stats(&stats);
+    fprintf(stdout, " Sample buffer allocation (MB)     :");
+    for (i = 0; i < MEM_POLICY_NUM; i++)
+        fprintf(stdout, " %s %.3f,", policy_name[i], (double) stats.bytes[i] / (1024.0 * 1024.0));
+    fprintf(stdout, " fallbacks %d\n\n", (int) stats.fallbacks);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the share of the intra 4x4/8x8 modes selected by RDO per
+ *    rank of the fast intra preselection
+ ************************************************************************
+ */
+static void report_fast_intra_ranks(VideoParameters *p_Vid) {
+    static const char *block_name[2] = {"4x4", "8x8"};
+    int64 total;
+    int i, rank;
+
+    for (i = 0; i < 2; i++) {
+        for (total = 0, rank = 0; rank < NO_INTRA_PMODE; rank++)
+            total += p_Vid->fast_intra_rank[i][rank];
+        if (total == 0)
+            continue;
+        fprintf(stdout, " Fast intra %s best mode rank (%%) :", block_name[i]);
+        for (rank = 0; rank < NO_INTRA_PMODE; rank++)
+            fprintf(stdout, " %5.1f", 100.0 * (double) p_Vid->fast_intra_rank[i][rank] / (double) total);
+        fprintf(stdout, "\n");
+    }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the share of macroblocks for which the adaptive mode pruning
+ *    disabled each partition
+ ************************************************************************
+ */
+static void report_mode_pruning(ModePruning *mp) {
+    static const int mode[6] = {P16x8, P8x16, P8x8, SMB8x4, SMB4x8, SMB4x4};
+    static const char *mode_name[6] = {"16x8", "8x16", "8x8", "8x4", "4x8", "4x4"};
+    int i;
+
+    fprintf(stdout, " Adaptive mode pruning (%% MBs)     :");
+    for (i = 0; i < 6; i++)
+        fprintf(stdout, " %s %.1f%s", mode_name[i],
+                mp->checked ? 100.0 * (double) mp->pruned[mode[i]] / (double) mp->checked : 0.0, i < 5 ? "," : "\n");
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the motion search time per reference index (GET_REF_METIME)
+ *    and the share of block searches skipped by the fast reference search
+ ************************************************************************
+ */
+static void report_reference_search(VideoParameters *p_Vid) {
+    int64 skipped = 0;
+    int num_refs = 0;
+    int ref;
+
+    for (ref = 0; ref < MAX_REFERENCE_PICTURES; ref++) {
+        if (p_Vid->me_ref_searched[ref] + p_Vid->me_ref_skipped[ref])
+            num_refs = ref + 1;
+        skipped += p_Vid->me_ref_skipped[ref];
+    }
+    if (num_refs < 2)
+        return;
+
+#if GET_REF_METIME
+    fprintf(stdout, " ME time per reference (ms)        :");
+    for (ref = 0; ref < num_refs; ref++)
+        fprintf(stdout, " ref%d %d%s", ref, (int) timenorm(p_Vid->me_ref_time[ref]), ref < num_refs - 1 ? "," : "\n");
+#endif
+    if (skipped) {
+        fprintf(stdout, " Skipped reference searches (%%)    :");
+        for (ref = 2; ref < num_refs; ref++)
+            fprintf(stdout, " ref%d %.1f%s", ref,
+                    100.0 * (double) p_Vid->me_ref_skipped[ref] / (double) (p_Vid->me_ref_searched[ref] + p_Vid->me_ref_skipped[ref]),
+                    ref < num_refs - 1 ? "," : "\n");
+    }
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -303,7 +489,7 @@ void report_stats(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters
         fprintf(p_stat, " MB Field Coding : On \n");
 
     if (p_Inp->SearchMode == EPZS) {
-        EPZSOutputStats(p_Inp, p_stat, 1);
+        EPZSOutputStats(p_Vid, p_Inp, p_stat, 1);
     }
 
     if (p_Inp->full_search == 2)
@@ -648,6 +834,7 @@ void report(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_St
     // normalize time p_Stats
     p_Vid->tot_time = timenorm(p_Vid->tot_time);
     p_Vid->me_tot_time = timenorm(p_Vid->me_tot_time);
+    p_Vid->interp_tot_time = timenorm(p_Vid->interp_tot_time);
     //  Accumulate bit usage for inter and intra frames
     for (j = 0; j < NUM_SLICE_TYPES; j++) {
         bit_use[j][1] = 0;
@@ -723,7 +910,53 @@ void report(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_St
 #endif
 
         fprintf(stdout, " Total encoding time for the seq.  : %7.3f sec (%3.2f fps)\n", (float) p_Vid->tot_time * 0.001, 1000.0 * (float) (p_Stats->frame_counter) / (float) p_Vid->tot_time);
-        fprintf(stdout, " Total ME time for sequence        : %7.3f sec \n\n", (float) p_Vid->me_tot_time * 0.001);
+        fprintf(stdout, " Total ME time for sequence        : %7.3f sec \n", (float) p_Vid->me_tot_time * 0.001);
+        fprintf(stdout, " Total interpolation time          : %7.3f sec \n", (float) p_Vid->interp_tot_time * 0.001);
+        fprintf(stdout, " Peak sub-pel reference memory     : %7.3f MB \n", (float) p_Vid->subpel_mem_peak / (1024.0 * 1024.0));
+        if (p_Vid->p_sub_cache != NULL && p_Vid->p_sub_cache->mode == INTERP_BLOCK_CACHE) {
+            SubPelCache *cache = p_Vid->p_sub_cache;
+            int64 lookups = cache->hits + cache->misses;
+            fprintf(stdout, " Sub-pel cache hit rate            : %7.2f %%\n",
+                    lookups ? 100.0 * (double) cache->hits / (double) lookups : 0.0);
+        } else if (p_Vid->p_sub_cache != NULL) {
+            SubPelCache *cache = p_Vid->p_sub_cache;
+            fprintf(stdout, " Sub-pel tiles interpolated        : %7.2f %%\n",
+                    cache->tiles_total ? 100.0 * (double) cache->tiles_done / (double) cache->tiles_total : 0.0);
+        }
+        if (p_Vid->rate_est_mbs) {
+            fprintf(stdout, " CABAC rate estimation error       : %7.3f bits/MB (%5.2f %% abs, %+5.2f %% bias)\n",
+                    p_Vid->rate_est_abs_err / (double) p_Vid->rate_est_mbs,
+                    p_Vid->rate_real_bits > 0 ? 100.0 * p_Vid->rate_est_abs_err / p_Vid->rate_real_bits : 0.0,
+                    p_Vid->rate_real_bits > 0 ? 100.0 * (p_Vid->rate_est_bits - p_Vid->rate_real_bits) / p_Vid->rate_real_bits : 0.0);
+        }
+        if (p_Inp->FastIntraRDO)
+            report_fast_intra_ranks(p_Vid);
+        if (p_Vid->p_mode_prune)
+            report_mode_pruning(p_Vid->p_mode_prune);
+        if (p_Vid->early_skip_checked)
+            fprintf(stdout, " Early SKIP/DIRECT decisions       : %7.2f %% of %d checked MBs\n",
+                    100.0 * (double) p_Vid->early_skip_mbs / (double) p_Vid->early_skip_checked, (int) p_Vid->early_skip_checked);
+        if (p_Vid->sea_candidates)
+            fprintf(stdout, " Full search candidates eliminated : %7.2f %% (SEA)\n",
+                    100.0 * (double) p_Vid->sea_eliminated / (double) p_Vid->sea_candidates);
+        report_reference_search(p_Vid);
+        if (p_Inp->SearchMode == EPZS)
+            EPZSOutputSearchStats(p_Vid, stdout, 0);
+        if (p_Vid->pyramid_checked)
+            fprintf(stdout, " Pyramid ME centre moved           : %7.2f %% of %d checked searches\n",
+                    100.0 * (double) p_Vid->pyramid_moved / (double) p_Vid->pyramid_checked, (int) p_Vid->pyramid_checked);
+        if (p_Vid->hash_me_checked)
+            fprintf(stdout, " Hash ME exact matches found/used  : %6.2f %% / %6.2f %% of %d searches\n",
+                    100.0 * (double) p_Vid->hash_me_found / (double) p_Vid->hash_me_checked,
+                    100.0 * (double) p_Vid->hash_me_used / (double) p_Vid->hash_me_checked, (int) p_Vid->hash_me_checked);
+        if (p_Vid->asr_searches)
+            fprintf(stdout, " Adaptive search range (average)   : %7.2f of %.2f pels\n",
+                    (double) p_Vid->asr_range_sum / (double) p_Vid->asr_searches,
+                    (double) p_Vid->asr_max_range_sum / (double) p_Vid->asr_searches);
+        if (p_Inp->BiPredMEConvergence && p_Vid->bipred_me_searches)
+            fprintf(stdout, " Bi-pred ME converged early        : %7.2f %% of %d searches\n",
+                    100.0 * (double) p_Vid->bipred_me_converged / (double) p_Vid->bipred_me_searches, (int) p_Vid->bipred_me_searches);
+        fprintf(stdout, "\n");
 
         fprintf(stdout, " Y { PSNR (dB), cSNR (dB), MSE }   : { %7.3f, %7.3f, %9.5f }\n",
                 snr->average[0], csnr_y, sse->average[0] / (float) impix);
@@ -882,6 +1115,11 @@ void report(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_St
     fprintf(stdout, " Bits for parameter sets           : %d \n", p_Stats->bit_ctr_parametersets);
     fprintf(stdout, " Bits for filler data              : %" FORMAT_OFF_T " \n\n", p_Stats->bit_ctr_filler_data);
 
+    if (p_Inp->MemoryReport)
+        report_memory_usage();
+    if (p_Inp->MemoryPolicy || p_Inp->MemoryFirstTouch)
+        report_memory_policy();
+
     switch (p_Inp->Verbose) {
         case 0:
         case 1:
@@ -1039,7 +1277,7 @@ void information_init(VideoParameters *p_Vid, InputParameters *p_Inp, StatParame
             fprintf(stdout, " Motion Estimation Scheme          : SHEX\n");
         else if (p_Inp->SearchMode == EPZS) {
             fprintf(stdout, " Motion Estimation Scheme          : EPZS\n");
-            EPZSOutputStats(p_Inp, stdout, 0);
+            EPZSOutputStats(p_Vid, p_Inp, stdout, 0);
         } else if (p_Inp->SearchMode == FAST_FULL_SEARCH)
             fprintf(stdout, " Motion Estimation Scheme          : Fast Full Search\n");
         else
@@ -1052,11 +1290,32 @@ void information_init(VideoParameters *p_Vid, InputParameters *p_Inp, StatParame
         else
             fprintf(stdout, " Search range restrictions         : smaller blocks and older reference frames\n");
 
+        if (p_Inp->InterpolationMode == INTERP_BLOCK_CACHE)
+            fprintf(stdout, " Sub-pel interpolation             : on-demand blocks\n");
+        else if (p_Inp->InterpolationMode == INTERP_LAZY_TILES)
+            fprintf(stdout, " Sub-pel interpolation             : lazy %dx%d tiles\n", SUBPEL_TILE_SIZE, SUBPEL_TILE_SIZE);
+        else
+            fprintf(stdout, " Sub-pel interpolation             : full planes\n");
+
+        if (p_Inp->MemoryPolicy || p_Inp->MemoryFirstTouch) {
+            static const char *policy_name[4] = {"heap", "64 byte aligned", "transparent huge pages", "explicit huge pages"};
+            fprintf(stdout, " Memory allocation policy          : %s%s\n", policy_name[p_Inp->MemoryPolicy],
+                    p_Inp->MemoryFirstTouch ? ", first touch" : "");
+        }
+
         if (p_Inp->rdopt)
             fprintf(stdout, " RD-optimized mode decision        : used\n");
         else
             fprintf(stdout, " RD-optimized mode decision        : not used\n");
 
+        if (p_Inp->RateEstimation && p_Inp->symbol_mode == CABAC)
+            fprintf(stdout, " CABAC rate in mode decision       : table based estimation%s\n",
+                    p_Inp->RateEstimation == 2 ? " (checked)" : "");
+
+        if (p_Inp->FastIntraRDO && p_Inp->rdopt)
+            fprintf(stdout, " Fast intra RDO (modes checked)    : %d, %d below QP %d\n",
+                    p_Inp->FastIntraTopK, p_Inp->FastIntraTopKLowQP, p_Inp->FastIntraQPThreshold);
+
         switch (p_Inp->partition_mode) {
             case PAR_DP_1:
                 fprintf(stdout, " Data Partitioning Mode            : 1 partition \n");
@@ -39,6 +39,9 @@
 #include "ratectl.h"
 #include "me_epzs.h"
 #include "me_epzs_int.h"
+#include "me_pyramid.h"
+#include "me_umhex.h"
+#include "me_umhexsmp.h"
 #include "wp.h"
 #include "slice.h"
 #include "rdoq.h"
@@ -1516,9 +1519,30 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     {
       if (((*currSlice)->p_EPZS =  (EPZSParameters*) calloc(1, sizeof(EPZSParameters)))==NULL) 
         no_mem_exit("init_slice: p_EPZS");
+      mem_set_tag(MEM_TAG_ME);
       EPZSStructInit (*currSlice);
       EPZSSliceInit  (*currSlice);
+      mem_set_tag(MEM_TAG_OTHER);
     }
+    else if (p_Inp->SearchMode == UM_HEX)
+    {
+      if (((*currSlice)->p_UMHexCtx = (UMHexContext*) calloc(1, sizeof(UMHexContext)))==NULL) 
+        no_mem_exit("init_slice: p_UMHexCtx");
+      mem_set_tag(MEM_TAG_ME);
+      UMHEX_get_context_mem (*currSlice);
+      mem_set_tag(MEM_TAG_OTHER);
+    }
+    else if (p_Inp->SearchMode == UM_HEX_SIMPLE)
+    {
+      if (((*currSlice)->p_UMHexSMPCtx = (UMHexSMPContext*) calloc(1, sizeof(UMHexSMPContext)))==NULL) 
+        no_mem_exit("init_slice: p_UMHexSMPCtx");
+      mem_set_tag(MEM_TAG_ME);
+      smpUMHEX_get_context_mem (*currSlice);
+      mem_set_tag(MEM_TAG_OTHER);
+    }
+
+    if (p_Vid->p_pyramid)
+      pyramid_slice_init(p_Vid);
   }
 
 
@@ -1627,7 +1651,9 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   allocate_block_mem(*currSlice);
   init_coding_state_methods(*currSlice);
+  mem_set_tag(MEM_TAG_RDO);
   init_rdopt(*currSlice);
+  mem_set_tag(MEM_TAG_OTHER);
 }
 
 /*!
@@ -1874,6 +1900,8 @@ void init_slice_lite (VideoParameters *p_Vid, Slice **currSlice, int start_mb_ad
     init_mbaff_lists(*currSlice);
 
   (*currSlice)->p_EPZS = NULL;
+  (*currSlice)->p_UMHexCtx = NULL;
+  (*currSlice)->p_UMHexSMPCtx = NULL;
 
   // assign luma common reference picture pointers to be used for ME/sub-pel interpolation
 
@@ -2334,6 +2362,16 @@ void free_slice(Slice *currSlice)
         if(currSlice->p_EPZS)
         EPZSStructDelete (currSlice);    
       }
+      else if (p_Inp->SearchMode == UM_HEX)
+      {
+        if (currSlice->p_UMHexCtx)
+          UMHEX_free_context_mem (currSlice);
+      }
+      else if (p_Inp->SearchMode == UM_HEX_SIMPLE)
+      {
+        if (currSlice->p_UMHexSMPCtx)
+          smpUMHEX_free_context_mem (currSlice);
+      }
     }
 
     free(currSlice);
@@ -39,6 +39,7 @@
 #include "md_common.h"
 #include "intra8x8.h"
 #include "rdopt_coding_state.h"
+#include "rd_intra_threads.h"
 
 //! single scan pattern
 static const byte SNGL_SCAN8x8[64][2] = {
@@ -245,6 +246,7 @@ int mode_decision_for_I8x8_MB (Macroblock *currMB, int lambda, distblk *min_cost
   //int cr_cbp[3] = { 0, 0, 0}; 
   distblk cost8x8;
   *min_cost = weighted_cost(lambda, 6); //6 bits overhead;
+  intra_threads_begin(currMB, TRUE);
 
   if (currSlice->P444_joined == 0)
   {
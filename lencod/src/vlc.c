@@ -45,6 +45,52 @@ static const byte NCBP[2][48][2]=
   }
 };
 
+/*!
+ ************************************************************************
+ * \brief
+ *    returns the position of the most significant set bit of value
+ *    (floor(log2(value))), value must be larger than 0
+ ************************************************************************
+ */
+static inline int msb_pos(unsigned int value)
+{
+#if defined(__GNUC__)
+  return 31 - __builtin_clz(value);
+#else
+  int pos = 0;
+  if (value >= 0x10000) { value >>= 16; pos += 16; }
+  if (value >= 0x100)   { value >>=  8; pos +=  8; }
+  if (value >= 0x10)    { value >>=  4; pos +=  4; }
+  if (value >= 0x4)     { value >>=  2; pos +=  2; }
+  return pos + (value >> 1);
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    appends len (<= 32) bits to the bitstream. The pending bits of
+ *    byte_buf and the new bits are merged in a 64 bit accumulator and
+ *    all completed bytes are flushed at once.
+ ************************************************************************
+ */
+static inline void put_bits(Bitstream *currStream, unsigned int bits, int len)
+{
+  int    n   = 8 - currStream->bits_to_go + len;  // pending bits, at most 7 + 32
+  uint64 acc = ((uint64) currStream->byte_buf << len) | (bits & (unsigned int) (((uint64) 1 << len) - 1));
+  byte  *buf = &currStream->streamBuffer[currStream->byte_pos];
+
+  while (n >= 8)
+  {
+    n -= 8;
+    *buf++ = (byte) (acc >> n);
+  }
+
+  currStream->byte_pos  += (int) (buf - &currStream->streamBuffer[currStream->byte_pos]);
+  currStream->byte_buf   = (byte) (acc & ((1 << n) - 1));
+  currStream->bits_to_go = 8 - n;
+}
+
 
 /*!
  *************************************************************************************
@@ -244,12 +290,8 @@ int u_v (int n, char *tracestring, int value, Bitstream *bitstream)
  */
 void ue_linfo(int ue, int dummy, int *len,int *info)
 {
-  int i, nn =(ue + 1) >> 1;
+  int i = msb_pos(((unsigned int) ue + 1) | 1);
 
-  for (i=0; i < 33 && nn != 0; i++)
-  {
-    nn >>= 1;
-  }
   *len  = (i << 1) + 1;
   *info = ue + 1 - (1 << i);
 }
@@ -273,12 +315,8 @@ void se_linfo(int se, int dummy, int *len,int *info)
 {  
   int sign = (se <= 0) ? 1 : 0;
   int n = iabs(se) << 1;   //  n+1 is the number in the code table.  Based on this we find length and info
-  int nn = (n >> 1);
-  int i;
-  for (i = 0; i < 33 && nn != 0; i++)
-  {
-    nn >>= 1;
-  }
+  int i = msb_pos((unsigned int) n | 1);
+
   *len  = (i << 1) + 1;
   *info = n - (1 << i) + sign;
 }
@@ -600,64 +638,16 @@ int writeSyntaxElement2Buf_UVLC(SyntaxElement *se, Bitstream* this_streamBuffer
  */
 void  writeUVLC2buffer(SyntaxElement *se, Bitstream *currStream)
 {
-  unsigned int mask = 1 << (se->len - 1);
-  byte *byte_buf  = &currStream->byte_buf;
-  int *bits_to_go = &currStream->bits_to_go;
-  int i;
-
-  // Add the new bits to the bitstream.
-  // Write out a byte if it is full
   if ( se->len < 33 )
   {
-    for (i = 0; i < se->len; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
-
-      mask >>= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    put_bits(currStream, se->bitpattern, se->len);
   }
   else
   {
     // zeros
-    for (i = 0; i < (se->len - 32); i++)
-    {
-      *byte_buf <<= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    put_bits(currStream, 0, se->len - 32);
     // actual info
-    mask = (unsigned int) 1 << 31;
-    for (i = 0; i < 32; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
-
-      mask >>= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    put_bits(currStream, se->bitpattern, 32);
   }
 }
 
@@ -769,17 +759,9 @@ void writeSE_Fix(SyntaxElement *se, Bitstream *bitstream )
 
 int symbol2vlc(SyntaxElement *sym)
 {
-  int info_len = sym->len;
+  // Convert info into a bitpattern int: the len LSBs of info
+  sym->bitpattern = (unsigned int) sym->inf & (unsigned int) (((uint64) 1 << sym->len) - 1);
 
-  // Convert info into a bitpattern int
-  sym->bitpattern = 0;
-
-  // vlc coding
-  while(--info_len >= 0)
-  {
-    sym->bitpattern <<= 1;
-    sym->bitpattern |= (0x01 & (sym->inf >> info_len));
-  }
   return 0;
 }
 
@@ -893,7 +875,8 @@ int writeSyntaxElement_NumCoeffTrailingOnes(SyntaxElement *se, DataPartition *dp
     exit(-1);
   }
 
-  symbol2vlc(se);
+  // the table codes fit their length, so they are emitted as they are
+  se->bitpattern = se->inf;
 
   writeUVLC2buffer(se, dp->bitstream);
 
@@ -969,7 +952,8 @@ int writeSyntaxElement_NumCoeffTrailingOnesChromaDC(VideoParameters *p_Vid, Synt
     exit(-1);
   }
 
-  symbol2vlc(se);
+  // the table codes fit their length, so they are emitted as they are
+  se->bitpattern = se->inf;
 
   writeUVLC2buffer(se, dp->bitstream);
 
@@ -1042,7 +1026,8 @@ int writeSyntaxElement_TotalZeros(SyntaxElement *se, DataPartition *dp)
     exit(-1);
   }
 
-  symbol2vlc(se);
+  // the table codes fit their length, so they are emitted as they are
+  se->bitpattern = se->inf;
 
   writeUVLC2buffer(se, dp->bitstream);
 
@@ -1142,7 +1127,8 @@ int writeSyntaxElement_TotalZerosChromaDC(VideoParameters *p_Vid, SyntaxElement
     exit(-1);
   }
 
-  symbol2vlc(se);
+  // the table codes fit their length, so they are emitted as they are
+  se->bitpattern = se->inf;
 
   writeUVLC2buffer(se, dp->bitstream);
 
@@ -1199,7 +1185,8 @@ int writeSyntaxElement_Run(SyntaxElement *se, DataPartition *dp)
     exit(-1);
   }
 
-  symbol2vlc(se);
+  // the table codes fit their length, so they are emitted as they are
+  se->bitpattern = se->inf;
 
   writeUVLC2buffer(se, dp->bitstream);
 
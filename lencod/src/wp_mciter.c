@@ -16,6 +16,8 @@
 
 #include "global.h"
 #include "image.h"
+#include "refbuf.h"
+#include "img_luma.h"
 #include "wp.h"
 
 /*!
@@ -760,6 +762,9 @@ void compute_offset(Slice *currSlice)
   double dtemp;
   int numlists  = (p_Vid->type == B_SLICE) ? 2 : 1;
 
+  // runs outside the macroblock loop, which otherwise resets the block cache
+  if (p_Vid->p_sub_cache)
+    reset_subpel_cache(p_Vid->p_sub_cache);
 
   for(list = 0; list < 2; list++)
   {
@@ -805,7 +810,7 @@ void compute_offset(Slice *currSlice)
                 //x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
                 x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj)+mvx));
 
-                temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
+                temp = *FastLine4X(currSlice->listX[LIST_0][ref_frame], y_pos, x_pos);
                 p_Vid->frameOffsetTotal[LIST_0][ref_frame]+=(valOrg-temp);
                 p_Vid->frameOffsetCount[LIST_0][ref_frame]++;          
               }
@@ -830,7 +835,7 @@ void compute_offset(Slice *currSlice)
                 //x_pos = imax(0, imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
                 x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj) + mvx));
 
-                temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
+                temp = *FastLine4X(currSlice->listX[LIST_0][ref_frame], y_pos, x_pos);
                 p_Vid->frameOffsetTotal[LIST_1][ref_frame]+=(valOrg-temp);
                 p_Vid->frameOffsetCount[LIST_1][ref_frame]++;          
               }